@@ -0,0 +1,434 @@
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <numeric>
+#include <cstdlib>
+
+#include "socket_factory.h"
+#ifdef __linux__
+    #include "http_server.h"
+    #include "shm_channel.h"
+#endif
+
+/**
+ * @brief ep_benchmark - loopback benchmark suite for the multi_socket products.
+ * @version 0.5
+ * Every benchmark runs a server product on one thread and a client product on another over 127.0.0.1
+ * and emits one JSON object per line on stdout, so results can be diffed between releases.
+ *
+ * On Linux the http_server module is also measured with keep-alive clients, one request in flight and pipelined,
+ * and same host messaging over a seqpacket socket is compared with a shm_channel.
+ *
+ *  usage: ep_benchmark [seconds per case] [base port]
+ */
+namespace bench {
+
+    using steady_t = std::chrono::steady_clock;
+
+    //TCP ping-pong and streaming message sizes - UDP sizes are capped by the DEFAULT_BUFFER_SIZE receive buffer
+    static const std::vector<size_t> TCP_MESSAGE_SIZES = {64, 512, 4096, 65536};
+    static const std::vector<size_t> UDP_MESSAGE_SIZES = {64, net::DEFAULT_BUFFER_SIZE};
+    static const int ACCEPT_CLOSE_CONNECTIONS = 2000;
+    static const int UDP_END_MARKERS = 16;
+    static const std::string UDP_END_MARKER = "\x04";
+    static const size_t GSO_SEGMENT_SIZE = 1400;
+    static const size_t HTTP_CONNECTIONS = 4;
+    static const size_t HTTP_SERVER_THREADS = 2;
+    static const std::vector<size_t> HTTP_PIPELINE_DEPTHS = {1, 16};
+    static const size_t LOCAL_MESSAGE_SIZE = 64;
+
+    struct config_t {
+        double seconds = 1.0;
+        unsigned short port = net::DEFAULT_PORT;
+    };
+
+    /**
+     * @brief write_all - keep writing until the whole buffer has been sent
+     */
+    template<typename S>
+    void write_all(const S& socket, const std::string& buffer) {
+        size_t sent = 0;
+        while(sent < buffer.size()) {
+            sent += static_cast<size_t>(socket.write(buffer.substr(sent)));
+        }
+    }
+
+    /**
+     * @brief read_exact - keep reading until size bytes have been received
+     */
+    template<typename S>
+    void read_exact(const S& socket, size_t size) {
+        size_t received = 0;
+        while(received < size) {
+            received += socket.read().size();
+        }
+    }
+
+    /**
+     * @brief emit - print one benchmark result as a single line JSON object
+     */
+    void emit(const std::vector<std::pair<std::string, std::string>>& fields) {
+        std::ostringstream ss;
+        ss << "{";
+        for(size_t i = 0; i < fields.size(); ++i) {
+            ss << (i ? ", " : "") << "\"" << fields[i].first << "\": " << fields[i].second;
+        }
+        ss << "}";
+        std::cout << ss.str() << std::endl;
+    }
+
+    std::string quote(const std::string& s) {
+        return "\"" + s + "\"";
+    }
+
+    std::string number(double d) {
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(3) << d;
+        return ss.str();
+    }
+
+    double seconds_since(steady_t::time_point start) {
+        return std::chrono::duration<double>(steady_t::now() - start).count();
+    }
+
+    /**
+     * @brief percentile - nearest rank percentile of an already sorted sample
+     */
+    double percentile(const std::vector<double>& sorted, double p) {
+        if(sorted.empty()) {
+            return 0;
+        }
+        auto rank = static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[std::min(rank, sorted.size() - 1)];
+    }
+
+    /**
+     * @brief tcp_pingpong - round trip latency of an echoed message of each size
+     */
+    void tcp_pingpong(const config_t& config, unsigned short port, size_t size) {
+        net::tcp_server_socket server(net::LOOPBACK_ADDR, port);
+        std::thread echo([&server, size]() {
+            auto active = server.accept_and_create_socket();
+            std::string message(size, 'p');
+            try {
+                for(;;) {
+                    read_exact(active, size);
+                    write_all(active, message);
+                }
+            } catch (std::exception&) {} //client closed the connection
+        });
+        std::vector<double> samples;
+        {
+            net::tcp_client_socket client(net::LOOPBACK_ADDR, port);
+            std::string message(size, 'p');
+            auto start = steady_t::now();
+            while(seconds_since(start) < config.seconds) {
+                auto t0 = steady_t::now();
+                write_all(client, message);
+                read_exact(client, size);
+                samples.push_back(std::chrono::duration<double, std::micro>(steady_t::now() - t0).count());
+            }
+        }
+        echo.join();
+        std::sort(samples.begin(), samples.end());
+        auto mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+        emit({{"benchmark", quote("tcp_pingpong")},
+              {"message_size", std::to_string(size)},
+              {"round_trips", std::to_string(samples.size())},
+              {"mean_us", number(mean)},
+              {"p50_us", number(percentile(samples, 50))},
+              {"p99_us", number(percentile(samples, 99))},
+              {"p999_us", number(percentile(samples, 99.9))},
+              {"max_us", number(samples.empty() ? 0 : samples.back())}});
+    }
+
+    /**
+     * @brief tcp_stream - one way throughput measured at the receiver until the sender closes
+     */
+    void tcp_stream(const config_t& config, unsigned short port, size_t size) {
+        net::tcp_server_socket server(net::LOOPBACK_ADDR, port);
+        size_t received = 0;
+        double elapsed = 0;
+        std::thread sink([&server, &received, &elapsed]() {
+            auto active = server.accept_and_create_socket();
+            auto start = steady_t::now();
+            try {
+                for(;;) {
+                    received += active.read().size();
+                }
+            } catch (std::exception&) {} //sender closed the connection
+            elapsed = seconds_since(start);
+        });
+        size_t messages = 0;
+        {
+            net::tcp_client_socket client(net::LOOPBACK_ADDR, port);
+            std::string message(size, 's');
+            auto start = steady_t::now();
+            while(seconds_since(start) < config.seconds) {
+                write_all(client, message);
+                ++messages;
+            }
+        }
+        sink.join();
+        emit({{"benchmark", quote("tcp_stream")},
+              {"message_size", std::to_string(size)},
+              {"messages", std::to_string(messages)},
+              {"bytes", std::to_string(received)},
+              {"seconds", number(elapsed)},
+              {"mib_per_sec", number(static_cast<double>(received) / (1024.0 * 1024.0) / elapsed)},
+              {"messages_per_sec", number(static_cast<double>(messages) / elapsed)}});
+    }
+
+    /**
+     * @brief udp_pps - datagrams per second received, the receiver stops on the first end marker
+     */
+    void udp_pps(const config_t& config, unsigned short port, size_t size) {
+        net::udp_server_socket server(net::LOOPBACK_ADDR, port);
+        size_t received = 0;
+        double elapsed = 0;
+        std::thread sink([&server, &received, &elapsed]() {
+            auto message = server.read_from();
+            auto start = steady_t::now();
+            while(message != UDP_END_MARKER) {
+                ++received;
+                message = server.read_from();
+            }
+            elapsed = seconds_since(start);
+        });
+        size_t sent = 0;
+        {
+            net::udp_client_socket client(net::LOOPBACK_ADDR, port);
+            std::string message(size, 'u');
+            auto start = steady_t::now();
+            while(seconds_since(start) < config.seconds) {
+                try {
+                    client.write(message);
+                    ++sent;
+                } catch (std::exception&) {} //ENOBUFS under overload counts as a loss
+            }
+            for(int i = 0; i < UDP_END_MARKERS; ++i) { //markers are spaced out so at least one survives a full receive queue
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                client.write(UDP_END_MARKER);
+            }
+        }
+        sink.join();
+        emit({{"benchmark", quote("udp_pps")},
+              {"message_size", std::to_string(size)},
+              {"sent", std::to_string(sent)},
+              {"received", std::to_string(received)},
+              {"loss_ratio", number(sent ? 1.0 - static_cast<double>(received) / static_cast<double>(sent) : 0)},
+              {"seconds", number(elapsed)},
+              {"packets_per_sec", number(static_cast<double>(received) / elapsed)}});
+    }
+
+    /**
+     * @brief udp_gso - datagrams per second sent as GSO trains of MAX_GSO_SEGMENTS and received GRO coalesced, compare with udp_pps
+     */
+    void udp_gso(const config_t& config, unsigned short port) {
+        net::udp_server_socket server(net::LOOPBACK_ADDR, port);
+        server.gro(true);
+        size_t received = 0;
+        double elapsed = 0;
+        std::thread sink([&server, &received, &elapsed]() {
+            std::string buffer;
+            std::vector<std::string_view> segments;
+            server.read_segments(buffer, segments);
+            auto start = steady_t::now();
+            for(;;) {
+                auto end = std::find(segments.begin(), segments.end(), UDP_END_MARKER);
+                received += static_cast<size_t>(end - segments.begin());
+                if(end != segments.end()) {
+                    break;
+                }
+                server.read_segments(buffer, segments);
+            }
+            elapsed = seconds_since(start);
+        });
+        size_t sent = 0;
+        {
+            net::udp_client_socket client(net::LOOPBACK_ADDR, port);
+            std::string train(GSO_SEGMENT_SIZE * net::MAX_GSO_SEGMENTS, 'g');
+            auto start = steady_t::now();
+            while(seconds_since(start) < config.seconds) {
+                try {
+                    client.write_segmented(train, GSO_SEGMENT_SIZE);
+                    sent += net::MAX_GSO_SEGMENTS;
+                } catch (std::exception&) {} //ENOBUFS under overload counts as a loss
+            }
+            for(int i = 0; i < UDP_END_MARKERS; ++i) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                client.write(UDP_END_MARKER);
+            }
+        }
+        sink.join();
+        emit({{"benchmark", quote("udp_gso")},
+              {"message_size", std::to_string(GSO_SEGMENT_SIZE)},
+              {"sent", std::to_string(sent)},
+              {"received", std::to_string(received)},
+              {"loss_ratio", number(sent ? 1.0 - static_cast<double>(received) / static_cast<double>(sent) : 0)},
+              {"seconds", number(elapsed)},
+              {"packets_per_sec", number(static_cast<double>(received) / elapsed)}});
+    }
+
+    /**
+     * @brief tcp_accept_close - full connect, accept and close cycles per second
+     */
+    void tcp_accept_close(unsigned short port) {
+        net::tcp_server_socket server(net::LOOPBACK_ADDR, port);
+        std::thread acceptor([&server]() {
+            for(int i = 0; i < ACCEPT_CLOSE_CONNECTIONS; ++i) {
+                auto active = server.accept_and_create_socket();
+            }
+        });
+        auto start = steady_t::now();
+        for(int i = 0; i < ACCEPT_CLOSE_CONNECTIONS; ++i) {
+            net::tcp_client_socket client(net::LOOPBACK_ADDR, port);
+        }
+        acceptor.join();
+        auto elapsed = seconds_since(start);
+        emit({{"benchmark", quote("tcp_accept_close")},
+              {"connections", std::to_string(ACCEPT_CLOSE_CONNECTIONS)},
+              {"seconds", number(elapsed)},
+              {"connections_per_sec", number(ACCEPT_CLOSE_CONNECTIONS / elapsed)}});
+    }
+
+#ifdef __linux__
+    /**
+     * @brief http_keepalive - requests per second to a static http_server route from keep-alive loopback clients,
+     * each sending depth requests back to back before reading the responses
+     */
+    void http_keepalive(const config_t& config, unsigned short port, size_t depth) {
+        net::http_server_options_t options;
+        options.threads = HTTP_SERVER_THREADS;
+        net::http_server server(net::LOOPBACK_ADDR, port, options);
+        const std::string body = "Hello, World!";
+        server.serve_static("/plaintext", "text/plain", body);
+        server.start();
+        std::string batch;
+        for(size_t i = 0; i < depth; ++i) {
+            batch += "GET /plaintext HTTP/1.1\r\nHost: localhost\r\nUser-Agent: ep_benchmark\r\nAccept: */*\r\n\r\n";
+        }
+        std::vector<size_t> completed(HTTP_CONNECTIONS, 0);
+        std::vector<std::thread> clients;
+        auto start = steady_t::now();
+        for(size_t c = 0; c < HTTP_CONNECTIONS; ++c) {
+            clients.emplace_back([&, c]() {
+                net::tcp_client_socket client(net::LOOPBACK_ADDR, port);
+                net::buffered_reader<net::tcp_client_socket> reader(client);
+                while(seconds_since(start) < config.seconds) {
+                    write_all(client, batch);
+                    for(size_t i = 0; i < depth; ++i) {
+                        reader.read_until("\r\n\r\n");
+                        reader.read_exact(body.size());
+                    }
+                    completed[c] += depth;
+                }
+            });
+        }
+        for(auto& t: clients) {
+            t.join();
+        }
+        auto elapsed = seconds_since(start);
+        auto requests = std::accumulate(completed.begin(), completed.end(), size_t{0});
+        emit({{"benchmark", quote("http_keepalive")},
+              {"connections", std::to_string(HTTP_CONNECTIONS)},
+              {"pipeline_depth", std::to_string(depth)},
+              {"requests", std::to_string(requests)},
+              {"seconds", number(elapsed)},
+              {"requests_per_sec", number(static_cast<double>(requests) / elapsed)}});
+    }
+
+    /**
+     * @brief local_messages - one way small messages per second between two threads, over a seqpacket socket or a shm_channel
+     */
+    template<typename W, typename R>
+    void local_messages(const config_t& config, const std::string& transport, W& writer, R& reader) {
+        size_t received = 0;
+        double elapsed = 0;
+        std::thread sink([&reader, &received, &elapsed]() {
+            std::array<char, LOCAL_MESSAGE_SIZE> buffer;
+            auto start = steady_t::now();
+            while(reader.read_some(buffer.data(), buffer.size()) > 1) {
+                ++received;
+            }
+            elapsed = seconds_since(start);
+        });
+        std::string message(LOCAL_MESSAGE_SIZE, 'l');
+        auto start = steady_t::now();
+        while(seconds_since(start) < config.seconds) {
+            for(int i = 0; i < 1000; ++i) {
+                writer.write(message);
+            }
+        }
+        writer.write(UDP_END_MARKER);
+        sink.join();
+        emit({{"benchmark", quote("local_messages")},
+              {"transport", quote(transport)},
+              {"message_size", std::to_string(LOCAL_MESSAGE_SIZE)},
+              {"messages", std::to_string(received)},
+              {"seconds", number(elapsed)},
+              {"messages_per_sec", number(static_cast<double>(received) / elapsed)}});
+    }
+
+    void local_messages(const config_t& config) {
+        {
+            net::seqpacket_server_socket server("@ep_benchmark");
+            net::seqpacket_client_socket client("@ep_benchmark");
+            auto active = server.accept_and_create_socket();
+            local_messages(config, "seqpacket", client, active);
+        }
+        {
+            auto writer = net::shm_channel::create();
+            auto reader = net::shm_channel::attach(dup(static_cast<int>(writer.sockfd())));
+            local_messages(config, "shm_channel", writer, reader);
+        }
+    }
+#endif
+
+}
+
+int main(int argc, char* argv[]) {
+
+#ifdef WIN32
+    net::startup();
+#endif
+
+    bench::config_t config;
+    if(argc > 1) {
+        config.seconds = std::atof(argv[1]);
+    }
+    if(argc > 2) {
+        config.port = static_cast<unsigned short>(std::atoi(argv[2]));
+    }
+    //every case listens on a fresh port so lingering TIME_WAIT connections never block the next bind
+    auto port = config.port;
+    for(auto size: bench::TCP_MESSAGE_SIZES) {
+        bench::tcp_pingpong(config, port++, size);
+    }
+    for(auto size: bench::TCP_MESSAGE_SIZES) {
+        bench::tcp_stream(config, port++, size);
+    }
+    for(auto size: bench::UDP_MESSAGE_SIZES) {
+        bench::udp_pps(config, port++, size);
+    }
+    bench::udp_gso(config, port++);
+    bench::tcp_accept_close(port++);
+#ifdef __linux__
+    for(auto depth: bench::HTTP_PIPELINE_DEPTHS) {
+        bench::http_keepalive(config, port++, depth);
+    }
+    bench::local_messages(config);
+#endif
+
+#ifdef WIN32
+    net::cleanup();
+#endif
+
+    return 0;
+
+}
@@ -0,0 +1,11 @@
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= app_bundle
+CONFIG -= qt
+
+TARGET = ep_benchmark
+
+include(../ep_sockets.pri)
+
+SOURCES += \
+        benchmark.cpp
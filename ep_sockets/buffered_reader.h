@@ -0,0 +1,308 @@
+#ifndef BUFFERED_READER_H
+#define BUFFERED_READER_H
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+    #define EP_SOCKETS_SSE2
+#endif
+
+#include "socket_errors.h"
+
+namespace net {
+
+    /**
+     * @brief find_delimiter - position of the first occurrence of delim in data, 16 bytes a step
+     * Each step compares the block against the delimiter's first and last bytes and only verifies positions where
+     * both match, so common first bytes (e.g. '\r') cost no memcmp unless the whole delimiter is likely there.
+     * @return size_t - offset of the delimiter or std::string_view::npos
+     */
+    inline size_t find_delimiter(std::string_view data, std::string_view delim) {
+        auto n = delim.size();
+        if(n == 0) {
+            return 0;
+        }
+        if(n > data.size()) {
+            return std::string_view::npos;
+        }
+        auto last = data.size() - n; //final position the delimiter could start at
+        size_t i = 0;
+#ifdef EP_SOCKETS_SSE2
+        auto first_byte = _mm_set1_epi8(delim.front());
+        auto last_byte = _mm_set1_epi8(delim.back());
+        for(; i + 16 <= last + 1; i += 16) {
+            auto head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + i));
+            auto tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + i + n - 1));
+            auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(head, first_byte),
+                                                                               _mm_cmpeq_epi8(tail, last_byte))));
+            while(mask) {
+                auto bit = static_cast<size_t>(__builtin_ctz(mask));
+                if(n <= 2 || std::memcmp(data.data() + i + bit + 1, delim.data() + 1, n - 2) == 0) {
+                    return i + bit;
+                }
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for(; i <= last; ++i) {
+            auto p = static_cast<const char*>(std::memchr(data.data() + i, delim.front(), last - i + 1));
+            if(!p) {
+                break;
+            }
+            i = static_cast<size_t>(p - data.data());
+            if(std::memcmp(p, delim.data(), n) == 0) {
+                return i;
+            }
+        }
+        return std::string_view::npos;
+    }
+
+    /**
+     * @brief The buffered_reader class turns a stream socket's "whatever recv returned" into exact sized and delimited
+     * reads for framing protocols, reading large blocks into one buffer and handing out views of it rather than copies.
+     * @version 0.5
+     * Views returned by peek, read_exact, read_until and read_available stay valid until the next call on the reader,
+     * copy them first if they are needed for longer. A delimiter is only ever scanned for once per byte, however many
+     * partial reads it arrives in.
+     * Blocking use - read_exact and read_until receive until they can answer and throw at end of stream.
+     * Event loop use - call fill(MSG_DONTWAIT) when the socket is readable then try_read_exact / try_read_until until they
+     * return nothing, they never touch the socket.
+     * @note not thread safe, one thread reads.
+     * @tparam S - a stream multi_socket product with read_some, e.g. tcp_active_socket or tcp_client_socket
+     */
+    template<typename S>
+    class buffered_reader {
+
+    public:
+
+        /**
+         * @brief buffered_reader
+         * @param socket - the connection read from, must outlive this reader
+         * @param capacity - initial buffer size, the most a single fill receives
+         * @param max_size - the buffer grows to fit a message up to this size, beyond it reads throw
+         */
+        explicit buffered_reader(S& socket, const size_t capacity = DEFAULT_CAPACITY, const size_t max_size = DEFAULT_MAX_SIZE):
+            _socket(socket), _capacity(std::max<size_t>(capacity, 1)), _max_size(std::max(max_size, _capacity)),
+            _buffer(new char[_capacity]) {}
+
+        buffered_reader(const buffered_reader&) = delete;
+
+        buffered_reader& operator= (const buffered_reader&) = delete;
+
+        /**
+         * @brief fill - receive once into the buffer's free space, growing or compacting it first if needed
+         * @param flags - MSG_DONTWAIT for event loop use
+         * @return long - bytes received, 0 at end of stream, -1 when a non blocking receive found nothing
+         */
+        long fill(const int flags = 0) {
+            _make_room();
+            auto i = _socket.read_some(_buffer.get() + _end, _capacity - _end, flags);
+            if(i > 0) {
+                _end += static_cast<size_t>(i);
+            } else if(i == 0) {
+                _eof = true;
+            }
+            return i;
+        }
+
+        /**
+         * @brief peek - the next n bytes without consuming them, receiving until they are buffered
+         */
+        std::string_view peek(const size_t n) {
+            _require(n);
+            return std::string_view(_buffer.get() + _begin, n);
+        }
+
+        /**
+         * @brief read_exact - consume exactly n bytes, receiving until they are buffered
+         */
+        std::string_view read_exact(const size_t n) {
+            _require(n);
+            return _take(n);
+        }
+
+        /**
+         * @brief read_until - consume up to and including the next delimiter, receiving until it is buffered
+         * @return string_view - the bytes read, ending with delim
+         */
+        std::string_view read_until(std::string_view delim) {
+            size_t at;
+            while((at = _scan(delim)) == std::string_view::npos) {
+                if(_end - _begin >= _max_size) {
+                    throw std::runtime_error(EMSG_READER_OVERFLOW);
+                }
+                if(_eof || fill() == 0) {
+                    throw std::runtime_error(EMSG_READER_EOF);
+                }
+            }
+            return _take(at + delim.size());
+        }
+
+        /**
+         * @brief read_available - consume everything buffered, receiving once if nothing is
+         * @return string_view - empty only at end of stream
+         */
+        std::string_view read_available() {
+            if(_begin == _end && !_eof) {
+                fill();
+            }
+            return _take(_end - _begin);
+        }
+
+        /**
+         * @brief try_read_exact - consume exactly n bytes if they are already buffered, never receives
+         */
+        std::optional<std::string_view> try_read_exact(const size_t n) {
+            if(n > _max_size) {
+                throw std::runtime_error(EMSG_READER_OVERFLOW);
+            }
+            if(_end - _begin < n) {
+                return std::nullopt;
+            }
+            return _take(n);
+        }
+
+        /**
+         * @brief try_read_until - consume up to and including the next delimiter if it is already buffered, never receives
+         */
+        std::optional<std::string_view> try_read_until(std::string_view delim) {
+            auto at = _scan(delim);
+            if(at == std::string_view::npos) {
+                if(_end - _begin >= _max_size) {
+                    throw std::runtime_error(EMSG_READER_OVERFLOW);
+                }
+                return std::nullopt;
+            }
+            return _take(at + delim.size());
+        }
+
+        /**
+         * @brief data - every byte received and not yet consumed, for parsers working over the buffer in place
+         */
+        std::string_view data() const {
+            return std::string_view(_buffer.get() + _begin, _end - _begin);
+        }
+
+        /**
+         * @brief consume - drop n bytes (at most what is buffered) from the front, e.g. once a parser has used them
+         */
+        void consume(const size_t n) {
+            _take(std::min(n, _end - _begin));
+        }
+
+        /**
+         * @brief buffered - bytes received and not yet consumed
+         */
+        size_t buffered() const {
+            return _end - _begin;
+        }
+
+        /**
+         * @brief max_size - the largest message the reader will buffer
+         */
+        size_t max_size() const {
+            return _max_size;
+        }
+
+        /**
+         * @brief is_eof - the peer has closed its side, what is buffered is all there will be
+         */
+        bool is_eof() const {
+            return _eof;
+        }
+
+    private:
+
+        static const size_t DEFAULT_CAPACITY = 64 * 1024;
+        static const size_t DEFAULT_MAX_SIZE = 16 * 1024 * 1024;
+
+        void _require(const size_t n) {
+            if(n > _max_size) {
+                throw std::runtime_error(EMSG_READER_OVERFLOW);
+            }
+            while(_end - _begin < n) {
+                if(_eof || fill() == 0) {
+                    throw std::runtime_error(EMSG_READER_EOF);
+                }
+            }
+        }
+
+        /**
+         * @brief _scan - find delim in the unconsumed bytes, resuming where the previous unsuccessful scan stopped
+         * @return offset from _begin or npos
+         */
+        size_t _scan(std::string_view delim) {
+            if(delim != _scan_delim) {
+                _scan_delim = delim;
+                _scanned = 0;
+            }
+            auto from = std::min(_scanned, _end - _begin);
+            if(from + 1 >= delim.size()) {
+                from -= delim.size() - 1; //a delimiter may straddle the previous scan's end
+            } else {
+                from = 0;
+            }
+            auto at = find_delimiter(std::string_view(_buffer.get() + _begin + from, _end - _begin - from), delim);
+            if(at == std::string_view::npos) {
+                _scanned = _end - _begin;
+                return at;
+            }
+            return from + at;
+        }
+
+        std::string_view _take(const size_t n) {
+            std::string_view view(_buffer.get() + _begin, n);
+            _begin += n;
+            _scanned = 0;
+            return view;
+        }
+
+        /**
+         * @brief _make_room - ensure there is free space after _end, by rewinding, compacting or growing the buffer
+         */
+        void _make_room() {
+            if(_begin == _end) {
+                _begin = _end = 0;
+            }
+            if(_end < _capacity) {
+                return;
+            }
+            auto used = _end - _begin;
+            if(_begin > 0 && used <= _capacity / 2) {
+                std::memmove(_buffer.get(), _buffer.get() + _begin, used);
+            } else {
+                if(used >= _max_size) {
+                    throw std::runtime_error(EMSG_READER_OVERFLOW);
+                }
+                auto capacity = std::min(_capacity * 2, _max_size);
+                std::unique_ptr<char[]> buffer(new char[capacity]);
+                std::memcpy(buffer.get(), _buffer.get() + _begin, used);
+                _buffer = std::move(buffer);
+                _capacity = capacity;
+            }
+            _begin = 0;
+            _end = used;
+        }
+
+        S& _socket;
+        size_t _capacity;
+        size_t _max_size;
+        std::unique_ptr<char[]> _buffer; //unconsumed bytes are [_begin, _end)
+        size_t _begin = 0;
+        size_t _end = 0;
+        size_t _scanned = 0; //bytes from _begin already searched without finding _scan_delim
+        std::string _scan_delim;
+        bool _eof = false;
+
+    };
+
+}
+
+#endif // BUFFERED_READER_H
@@ -0,0 +1,221 @@
+#ifndef BUFFERED_WRITER_H
+#define BUFFERED_WRITER_H
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "timer_wheel.h"
+
+namespace net {
+
+    /**
+     * @brief writer_options_t - when a buffered_writer flushes and when it pushes back on producers
+     */
+    struct writer_options_t {
+        size_t flush_threshold = 64 * 1024; //flush as soon as this much is buffered
+        std::chrono::milliseconds max_delay{1}; //and no later than this after the first unflushed write (needs a timer_wheel)
+        size_t high_watermark = 4 * 1024 * 1024; //producers are asked to pause above this...
+        size_t low_watermark = 1024 * 1024; //...and to resume once drained below this
+        size_t copy_threshold = 4 * 1024; //smaller writes are copied into a shared chunk, larger ones keep their own buffer
+        int flush_flags = 0; //flags for automatic flushes, e.g. MSG_DONTWAIT when driven by an event_loop
+    };
+
+    /**
+     * @brief The buffered_writer class is a per-connection output queue that coalesces many small writes into few large
+     * gather_write (sendmsg) calls, so they leave as full TCP segments rather than one system call and segment each.
+     * @version 0.5
+     * Small writes are copied into a shared chunk, large ones are queued as their own buffer (moved in when possible) and
+     * sent in place. The queue flushes when flush_threshold bytes are waiting, max_delay after the first unflushed write
+     * when given a timer_wheel, or on an explicit flush.
+     * Backpressure - once more than high_watermark bytes are queued is_writable turns false (and on_backpressure is told)
+     * until the queue drains below low_watermark, producers should hold back in between rather than grow memory unboundedly.
+     * @note not thread safe, one owner (normally the connection's event_loop thread) writes and flushes.
+     * @tparam S - a stream multi_socket product with gather_write, e.g. tcp_active_socket or tcp_client_socket
+     */
+    template<typename S>
+    class buffered_writer {
+
+    public:
+
+        using backpressure_handler_t = std::function<void(bool paused)>;
+
+        /**
+         * @brief buffered_writer
+         * @param socket - the connection written to, must outlive this writer
+         * @param options - thresholds and watermarks
+         * @param timers - wheel used for the max_delay flush, nullptr leaves time based flushing to the caller
+         */
+        explicit buffered_writer(S& socket, const writer_options_t& options = writer_options_t{}, timer_wheel* timers = nullptr):
+            _socket(socket), _options(options), _timers(timers), _flush_timer([this]() { flush(_options.flush_flags); }) {}
+
+        buffered_writer(const buffered_writer&) = delete;
+
+        buffered_writer& operator= (const buffered_writer&) = delete;
+
+        /**
+         * @brief write - queue a message, flushing if the size threshold is reached
+         * @return bool - false once producers should pause (above the high watermark), the message is queued regardless
+         */
+        bool write(std::string_view message) {
+            if(message.empty()) {
+                return !_paused; //an empty chunk would look like a full send buffer to flush
+            }
+            if(message.size() >= _options.copy_threshold) {
+                _chunks.emplace_back(message);
+                _sealed = true;
+            } else {
+                if(_chunks.empty() || _sealed || _chunks.back().size() + message.size() > _options.flush_threshold) {
+                    _chunks.emplace_back();
+                    _chunks.back().reserve(std::max(_options.copy_threshold, std::min(_options.flush_threshold, DEFAULT_CHUNK)));
+                    _sealed = false;
+                }
+                _chunks.back().append(message);
+            }
+            return _queued(message.size());
+        }
+
+        bool write(const char* message) {
+            return write(std::string_view(message));
+        }
+
+        /**
+         * @brief write - queue a message taking ownership of its buffer, large messages are then never copied
+         */
+        bool write(std::string&& message) {
+            if(message.empty() || message.size() < _options.copy_threshold) {
+                return write(std::string_view(message));
+            }
+            auto size = message.size();
+            _chunks.push_back(std::move(message));
+            _sealed = true;
+            return _queued(size);
+        }
+
+        /**
+         * @brief flush - send as much of the queue as the socket takes, several chunks per gather_write
+         * @param flags - 0 blocks until everything is sent on a blocking socket, MSG_DONTWAIT stops when the send buffer is full
+         * @return size_t - bytes sent
+         */
+        size_t flush(const int flags = 0) {
+            size_t sent = 0;
+            while(!_chunks.empty()) {
+                _iov.clear();
+                for(size_t i = 0; i < _chunks.size() && i < MAX_GATHER; ++i) {
+                    _iov.emplace_back(_chunks[i]);
+                }
+                _iov.front().remove_prefix(_offset);
+                auto n = static_cast<size_t>(_socket.gather_write(_iov, flags));
+                if(n == 0) {
+                    break; //send buffer full, try again when the socket is writable
+                }
+                sent += n;
+                _consume(n);
+            }
+            if(_chunks.empty() && _timers) {
+                _timers->cancel(_flush_timer);
+            }
+            return sent;
+        }
+
+        /**
+         * @brief flush_if_due - for callers without a timer_wheel, flush once max_delay has passed since the first unflushed write
+         */
+        size_t flush_if_due(const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now()) {
+            if(!_chunks.empty() && now - _first_queued >= _options.max_delay) {
+                return flush(_options.flush_flags);
+            }
+            return 0;
+        }
+
+        /**
+         * @brief buffered - bytes queued and not yet sent
+         */
+        size_t buffered() const {
+            return _buffered;
+        }
+
+        /**
+         * @brief is_writable - false between crossing the high watermark and draining below the low watermark
+         */
+        bool is_writable() const {
+            return !_paused;
+        }
+
+        /**
+         * @brief on_backpressure - called with true when producers should pause and false when they may resume
+         */
+        void on_backpressure(backpressure_handler_t handler) {
+            _on_backpressure = std::move(handler);
+        }
+
+    private:
+
+        static const size_t MAX_GATHER = 64; //chunks per gather_write, plenty to fill a send buffer
+        static const size_t DEFAULT_CHUNK = 16 * 1024;
+
+        bool _queued(size_t size) {
+            if(_buffered == 0) {
+                _first_queued = std::chrono::steady_clock::now();
+                if(_timers) {
+                    _timers->arm(_flush_timer, _options.max_delay);
+                }
+            }
+            _buffered += size;
+            if(!_paused && _buffered > _options.high_watermark) {
+                _set_paused(true);
+            }
+            if(_buffered >= _options.flush_threshold) {
+                flush(_options.flush_flags);
+            }
+            return !_paused;
+        }
+
+        void _consume(size_t n) {
+            _buffered -= n;
+            while(n > 0) {
+                auto left = _chunks.front().size() - _offset;
+                if(n < left) {
+                    _offset += n;
+                    break;
+                }
+                n -= left;
+                _chunks.pop_front();
+                _offset = 0;
+            }
+            if(_chunks.empty()) {
+                _sealed = false;
+            }
+            if(_paused && _buffered < _options.low_watermark) {
+                _set_paused(false);
+            }
+        }
+
+        void _set_paused(bool paused) {
+            _paused = paused;
+            if(_on_backpressure) {
+                _on_backpressure(paused);
+            }
+        }
+
+        S& _socket;
+        writer_options_t _options;
+        timer_wheel* _timers;
+        timer_wheel::timer _flush_timer;
+        std::deque<std::string> _chunks;
+        bool _sealed = false; //the back chunk holds a large message and must not be appended to
+        size_t _offset = 0; //bytes of the front chunk already sent
+        size_t _buffered = 0;
+        bool _paused = false;
+        std::chrono::steady_clock::time_point _first_queued;
+        std::vector<std::string_view> _iov;
+        backpressure_handler_t _on_backpressure;
+
+    };
+
+}
+
+#endif // BUFFERED_WRITER_H
@@ -0,0 +1,323 @@
+#include "compressed_stream.h"
+
+#if defined(EP_SOCKETS_LZ4) || defined(EP_SOCKETS_ZSTD)
+
+#ifdef __linux__
+    #include <time.h>
+#endif
+
+#ifdef EP_SOCKETS_LZ4
+    #include "lz4.h"
+#endif
+#ifdef EP_SOCKETS_ZSTD
+    #include "zstd.h"
+#endif
+
+namespace net {
+
+    namespace {
+
+        //block header algorithm byte
+        enum block_t: char {STORED = 0, LZ4_BLOCK = 1, ZSTD_BLOCK = 2};
+
+        static const size_t HISTORY_SIZE = 64 * 1024; //LZ4's window
+        static const size_t RING_SIZE = HISTORY_SIZE + COMPRESSION_BLOCK_SIZE; //encoder and decoder rings wrap alike
+        static const size_t ZSTD_FLUSH_SLACK = 64; //frame and block headers a flush may add to ZSTD_compressBound
+
+        std::chrono::nanoseconds cpu_time() {
+#ifdef __linux__
+            timespec ts;
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+            return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+#else
+            return std::chrono::steady_clock::now().time_since_epoch(); //wall time, a fair stand in while the thread is not preempted
+#endif
+        }
+
+        void put_u32(char* out, const size_t value) {
+            for(size_t i = 0; i < sizeof(uint32_t); ++i) {
+                out[i] = static_cast<char>((value >> (8 * (sizeof(uint32_t) - 1 - i))) & 0xFF);
+            }
+        }
+
+        size_t get_u32(const char* in) {
+            size_t value = 0;
+            for(size_t i = 0; i < sizeof(uint32_t); ++i) {
+                value = (value << 8) | static_cast<unsigned char>(in[i]);
+            }
+            return value;
+        }
+
+        /**
+         * @brief next_pieces - call f on each piece of the next n bytes of buffers, from buffer piece at offset onwards
+         */
+        template<typename F>
+        void next_pieces(const std::vector<std::string_view>& buffers, size_t& piece, size_t& offset, size_t n, F f) {
+            while(n > 0) {
+                auto m = std::min(n, buffers[piece].size() - offset);
+                if(m > 0) {
+                    f(buffers[piece].data() + offset, m);
+                }
+                offset += m;
+                n -= m;
+                if(offset == buffers[piece].size()) {
+                    ++piece;
+                    offset = 0;
+                }
+            }
+        }
+
+    }
+
+    struct stream_compressor::state_t {
+        size_t max_stored = 0; //largest stored size of a block the compressor writes
+        size_t max_received = COMPRESSION_BLOCK_SIZE; //and the decoder accepts
+        std::unique_ptr<char[]> out; //headers and compressed bytes of the message being sent
+        size_t out_capacity = 0;
+#ifdef EP_SOCKETS_LZ4
+        LZ4_stream_t* lz4 = nullptr;
+        LZ4_streamDecode_t* lz4_decode = nullptr;
+        std::unique_ptr<char[]> ring; //plain bytes compressed lately, LZ4 matches refer back into it
+        std::unique_ptr<char[]> decode_ring;
+        size_t ring_at = 0;
+        size_t decode_ring_at = 0;
+#endif
+#ifdef EP_SOCKETS_ZSTD
+        ZSTD_CCtx* zstd = nullptr;
+        ZSTD_DCtx* zstd_decode = nullptr;
+        std::unique_ptr<char[]> plain; //decoded zstd block
+#endif
+
+        char* output(const size_t size) {
+            if(size > out_capacity) {
+                out_capacity = std::max(size, out_capacity * 2);
+                out.reset(new char[out_capacity]);
+            }
+            return out.get();
+        }
+    };
+
+    //------------stream_compressor implementation------------
+    stream_compressor::stream_compressor(const compression_options_t& options):
+        _options(options), _state(new state_t) {
+#ifdef EP_SOCKETS_LZ4
+        _state->max_received = std::max<size_t>(_state->max_received, LZ4_COMPRESSBOUND(COMPRESSION_BLOCK_SIZE));
+#endif
+#ifdef EP_SOCKETS_ZSTD
+        _state->max_received = std::max(_state->max_received, ZSTD_compressBound(COMPRESSION_BLOCK_SIZE) + ZSTD_FLUSH_SLACK);
+#endif
+        switch(_options.algorithm) {
+        case compression_t::NONE:
+            break;
+        case compression_t::LZ4:
+#ifdef EP_SOCKETS_LZ4
+            _state->lz4 = LZ4_createStream();
+            _state->ring.reset(new char[RING_SIZE]);
+            if(!_options.dictionary.empty()) {
+                LZ4_loadDict(_state->lz4, _options.dictionary.data(), static_cast<int>(_options.dictionary.size()));
+            }
+            _state->max_stored = LZ4_COMPRESSBOUND(COMPRESSION_BLOCK_SIZE);
+            break;
+#else
+            throw std::runtime_error(EMSG_COMPRESSION_UNSUPPORTED);
+#endif
+        case compression_t::ZSTD:
+#ifdef EP_SOCKETS_ZSTD
+            _state->zstd = ZSTD_createCCtx();
+            ZSTD_CCtx_setParameter(_state->zstd, ZSTD_c_compressionLevel, _options.level);
+            if(!_options.dictionary.empty()) {
+                ZSTD_CCtx_loadDictionary(_state->zstd, _options.dictionary.data(), _options.dictionary.size());
+            }
+            _state->max_stored = ZSTD_compressBound(COMPRESSION_BLOCK_SIZE) + ZSTD_FLUSH_SLACK;
+            break;
+#else
+            throw std::runtime_error(EMSG_COMPRESSION_UNSUPPORTED);
+#endif
+        }
+    }
+
+    size_t stream_compressor::encode(const std::vector<std::string_view>& buffers, std::vector<std::string_view>& blocks) {
+        blocks.clear();
+        size_t total = 0;
+        for(auto& buffer: buffers) {
+            total += buffer.size();
+        }
+        if(total == 0) {
+            return 0;
+        }
+        auto compress = _options.algorithm != compression_t::NONE && total >= _options.threshold;
+        auto chunks = (total + COMPRESSION_BLOCK_SIZE - 1) / COMPRESSION_BLOCK_SIZE;
+        auto out = _state->output(chunks * (BLOCK_HEADER_SIZE + (compress ? _state->max_stored : 0)));
+        auto started = compress ? cpu_time() : std::chrono::nanoseconds(0);
+        size_t piece = 0, offset = 0;
+        for(size_t done = 0; done < total; ) {
+            auto n = std::min(COMPRESSION_BLOCK_SIZE, total - done);
+            auto header = out;
+            out += BLOCK_HEADER_SIZE;
+            size_t stored = n;
+            block_t kind = STORED;
+            if(!compress) {
+                blocks.emplace_back(header, BLOCK_HEADER_SIZE);
+                next_pieces(buffers, piece, offset, n, [&blocks](const char* data, size_t size) {
+                    blocks.emplace_back(data, size); //sent from where it is
+                });
+            }
+#ifdef EP_SOCKETS_LZ4
+            else if(_options.algorithm == compression_t::LZ4) {
+                kind = LZ4_BLOCK;
+                if(_state->ring_at + n > RING_SIZE) {
+                    _state->ring_at = 0;
+                }
+                auto plain = _state->ring.get() + _state->ring_at;
+                auto to = plain;
+                next_pieces(buffers, piece, offset, n, [&to](const char* data, size_t size) {
+                    std::memcpy(to, data, size); //LZ4 needs the block contiguous and the history kept in place
+                    to += size;
+                });
+                auto i = LZ4_compress_fast_continue(_state->lz4, plain, out, static_cast<int>(n),
+                                                    static_cast<int>(_state->max_stored), std::max(_options.level, 1));
+                if(i <= 0) {
+                    throw std::runtime_error(EMSG_COMPRESSION_FORMAT);
+                }
+                _state->ring_at += n;
+                stored = static_cast<size_t>(i);
+            }
+#endif
+#ifdef EP_SOCKETS_ZSTD
+            else if(_options.algorithm == compression_t::ZSTD) {
+                kind = ZSTD_BLOCK;
+                ZSTD_outBuffer to{out, _state->max_stored, 0};
+                auto zstd = _state->zstd;
+                next_pieces(buffers, piece, offset, n, [zstd, &to](const char* data, size_t size) {
+                    ZSTD_inBuffer from{data, size, 0};
+                    while(from.pos < from.size) {
+                        if(ZSTD_isError(ZSTD_compressStream2(zstd, &to, &from, ZSTD_e_continue)) || to.pos == to.size) {
+                            throw std::runtime_error(EMSG_COMPRESSION_FORMAT);
+                        }
+                    }
+                });
+                size_t remaining;
+                do { //end the block so the peer can decode all of it now, the window carries on
+                    ZSTD_inBuffer none{nullptr, 0, 0};
+                    remaining = ZSTD_compressStream2(zstd, &to, &none, ZSTD_e_flush);
+                    if(ZSTD_isError(remaining) || (remaining > 0 && to.pos == to.size)) {
+                        throw std::runtime_error(EMSG_COMPRESSION_FORMAT);
+                    }
+                } while(remaining > 0);
+                stored = to.pos;
+            }
+#endif
+            header[0] = kind;
+            put_u32(header + 1, n);
+            put_u32(header + 1 + sizeof(uint32_t), stored);
+            if(compress) {
+                blocks.emplace_back(header, BLOCK_HEADER_SIZE + stored);
+                out += stored;
+            }
+            _metrics.wire_bytes_sent += BLOCK_HEADER_SIZE + stored;
+            done += n;
+        }
+        if(compress) {
+            _metrics.compress_time += cpu_time() - started;
+            ++_metrics.messages_compressed;
+        }
+        ++_metrics.messages_sent;
+        _metrics.plain_bytes_sent += total;
+        return total;
+    }
+
+    size_t stream_compressor::block_size(std::string_view data) const {
+        if(data.size() < BLOCK_HEADER_SIZE) {
+            return 0;
+        }
+        auto kind = data[0];
+        auto plain = get_u32(data.data() + 1);
+        auto stored = get_u32(data.data() + 1 + sizeof(uint32_t));
+        if(kind < STORED || kind > ZSTD_BLOCK || plain > COMPRESSION_BLOCK_SIZE || stored > _state->max_received ||
+           (kind == STORED && stored != plain)) {
+            throw std::runtime_error(EMSG_COMPRESSION_FORMAT);
+        }
+        return BLOCK_HEADER_SIZE + stored;
+    }
+
+    std::string_view stream_compressor::decode(std::string_view block) {
+        auto kind = block[0];
+        auto plain = get_u32(block.data() + 1);
+        auto stored = block.size() - BLOCK_HEADER_SIZE;
+        auto from = block.data() + BLOCK_HEADER_SIZE;
+        _metrics.wire_bytes_received += block.size();
+        _metrics.plain_bytes_received += plain;
+        if(kind == STORED) {
+            return std::string_view(from, plain);
+        }
+        auto started = cpu_time();
+        std::string_view result;
+#ifdef EP_SOCKETS_LZ4
+        if(kind == LZ4_BLOCK) {
+            if(!_state->lz4_decode) {
+                _state->lz4_decode = LZ4_createStreamDecode();
+                _state->decode_ring.reset(new char[RING_SIZE]);
+                if(!_options.dictionary.empty()) {
+                    LZ4_setStreamDecode(_state->lz4_decode, _options.dictionary.data(), static_cast<int>(_options.dictionary.size()));
+                }
+            }
+            if(_state->decode_ring_at + plain > RING_SIZE) { //wraps where the sender's ring did, LZ4's synchronized mode
+                _state->decode_ring_at = 0;
+            }
+            auto to = _state->decode_ring.get() + _state->decode_ring_at;
+            auto i = LZ4_decompress_safe_continue(_state->lz4_decode, from, to, static_cast<int>(stored), static_cast<int>(plain));
+            if(i < 0 || static_cast<size_t>(i) != plain) {
+                throw std::runtime_error(EMSG_COMPRESSION_FORMAT);
+            }
+            _state->decode_ring_at += plain;
+            result = std::string_view(to, plain);
+        }
+#endif
+#ifdef EP_SOCKETS_ZSTD
+        if(kind == ZSTD_BLOCK) {
+            if(!_state->zstd_decode) {
+                _state->zstd_decode = ZSTD_createDCtx();
+                _state->plain.reset(new char[COMPRESSION_BLOCK_SIZE]);
+                if(!_options.dictionary.empty()) {
+                    ZSTD_DCtx_loadDictionary(_state->zstd_decode, _options.dictionary.data(), _options.dictionary.size());
+                }
+            }
+            ZSTD_inBuffer in{from, stored, 0};
+            ZSTD_outBuffer to{_state->plain.get(), plain, 0};
+            while(in.pos < in.size) {
+                auto before = in.pos;
+                if(ZSTD_isError(ZSTD_decompressStream(_state->zstd_decode, &to, &in)) || (in.pos == before && to.pos == to.size)) {
+                    throw std::runtime_error(EMSG_COMPRESSION_FORMAT);
+                }
+            }
+            if(to.pos != plain) {
+                throw std::runtime_error(EMSG_COMPRESSION_FORMAT);
+            }
+            result = std::string_view(_state->plain.get(), plain);
+        }
+#endif
+        if(result.data() == nullptr) { //an algorithm this build was not given
+            throw std::runtime_error(EMSG_COMPRESSION_UNSUPPORTED);
+        }
+        _metrics.decompress_time += cpu_time() - started;
+        return result;
+    }
+
+    const compression_metrics_t& stream_compressor::metrics() const {
+        return _metrics;
+    }
+
+    stream_compressor::~stream_compressor() {
+#ifdef EP_SOCKETS_LZ4
+        LZ4_freeStream(_state->lz4);
+        LZ4_freeStreamDecode(_state->lz4_decode);
+#endif
+#ifdef EP_SOCKETS_ZSTD
+        ZSTD_freeCCtx(_state->zstd);
+        ZSTD_freeDCtx(_state->zstd_decode);
+#endif
+    }
+
+}
+
+#endif // EP_SOCKETS_LZ4 || EP_SOCKETS_ZSTD
@@ -0,0 +1,257 @@
+#ifndef COMPRESSED_STREAM_H
+#define COMPRESSED_STREAM_H
+
+#if defined(EP_SOCKETS_LZ4) || defined(EP_SOCKETS_ZSTD)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "buffered_reader.h"
+#include "socket_constants.h"
+#include "socket_errors.h"
+
+namespace net {
+
+    /**
+     * @brief compression_t - how a compressed_stream compresses what it sends, it decodes whatever the peer chose
+     */
+    enum class compression_t {NONE, LZ4, ZSTD};
+
+    /**
+     * @brief compression_options_t - algorithm, threshold and dictionary of one side of a compressed_stream
+     */
+    struct compression_options_t {
+        compression_t algorithm = compression_t::LZ4;
+        size_t threshold = 512; //messages shorter than this are sent as they are, too small to repay the CPU
+        int level = 1; //zstd compression level, or LZ4 acceleration (higher is faster and compresses less)
+        std::string dictionary; //a trained dictionary both ends share, primes the history of a new stream
+    };
+
+    /**
+     * @brief compression_metrics_t - bytes and CPU time of a compressed_stream so far, wire sizes include block headers
+     */
+    struct compression_metrics_t {
+        uint64_t messages_sent = 0;
+        uint64_t messages_compressed = 0; //of messages_sent, those at or above the threshold
+        uint64_t plain_bytes_sent = 0;
+        uint64_t wire_bytes_sent = 0;
+        uint64_t wire_bytes_received = 0;
+        uint64_t plain_bytes_received = 0;
+        std::chrono::nanoseconds compress_time{0}; //thread CPU time spent compressing
+        std::chrono::nanoseconds decompress_time{0}; //thread CPU time spent decompressing
+
+        /**
+         * @brief send_ratio - plain bytes per wire byte sent, above 1 when compression pays
+         */
+        double send_ratio() const {
+            return wire_bytes_sent ? static_cast<double>(plain_bytes_sent) / static_cast<double>(wire_bytes_sent) : 1.0;
+        }
+
+        /**
+         * @brief receive_ratio - plain bytes per wire byte received
+         */
+        double receive_ratio() const {
+            return wire_bytes_received ? static_cast<double>(plain_bytes_received) / static_cast<double>(wire_bytes_received) : 1.0;
+        }
+    };
+
+    /**
+     * @brief The stream_compressor class is the codec of one compressed_stream connection: each message written becomes
+     * blocks of at most COMPRESSION_BLOCK_SIZE plain bytes, each a 9 byte header (algorithm, plain and stored length in
+     * network byte order) and the compressed or, below the threshold, the untouched bytes.
+     * Both algorithms stream: a block may refer back to anything in the last 64KB (LZ4) or zstd window of compressed
+     * data on the connection, so the many similar small messages of a replication stream compress well together.
+     * Messages below the threshold bypass the compressor on both ends and are sent from the caller's buffers.
+     * @version 0.5
+     * @note not thread safe, one writer and one reader at most, each using its own half.
+     */
+    class stream_compressor {
+
+    public:
+
+        static const size_t BLOCK_HEADER_SIZE = 1 + 2 * sizeof(uint32_t);
+
+        explicit stream_compressor(const compression_options_t& options = compression_options_t{});
+
+        stream_compressor(const stream_compressor&) = delete;
+
+        stream_compressor& operator= (const stream_compressor&) = delete;
+
+        /**
+         * @brief encode - the blocks of one message made of buffers, compressed from where the buffers are
+         * @param blocks - replaced by views of the blocks to send, valid until the next encode, they may refer to buffers
+         * @return size_t - the message's plain size
+         */
+        size_t encode(const std::vector<std::string_view>& buffers, std::vector<std::string_view>& blocks);
+
+        /**
+         * @brief block_size - header and stored bytes of the block data starts with, 0 while its header is incomplete
+         */
+        size_t block_size(std::string_view data) const;
+
+        /**
+         * @brief decode - the plain bytes of one whole block, valid until the next decode and, for stored blocks, the block
+         */
+        std::string_view decode(std::string_view block);
+
+        const compression_metrics_t& metrics() const;
+
+        ~stream_compressor();
+
+    private:
+
+        struct state_t;
+
+        compression_options_t _options;
+        std::unique_ptr<state_t> _state; //library contexts, ring and output buffers
+        compression_metrics_t _metrics;
+
+    };
+
+    /**
+     * @brief The compressed_stream class is an opt-in compression stage over a connected stream multi_socket product:
+     * it owns the connection and has the product's write/gather_write/read/read_some calls, so buffered_reader,
+     * buffered_writer and the typed message helpers run on top of it unchanged and each write is compressed in one pass
+     * straight from the caller's buffers into the blocks sendmsg sends.
+     * @version 0.5
+     * @note blocking sockets, writes send every block before returning. Both ends of the connection must use one.
+     * @tparam S - e.g. tcp_client_socket or tcp_active_socket
+     */
+    template<typename S>
+    class compressed_stream {
+
+    public:
+
+        compressed_stream(S&& socket, const compression_options_t& options = compression_options_t{}):
+            _socket(std::move(socket)), _compressor(options), _reader(_socket) {}
+
+        compressed_stream(const compressed_stream&) = delete;
+
+        compressed_stream& operator= (const compressed_stream&) = delete;
+
+        /**
+         * @brief write - compress and send the buffer as one message
+         * @return long - the plain bytes written
+         */
+        long write(const std::string& buffer, const int flags = 0) {
+            _single.assign(1, std::string_view(buffer));
+            return gather_write(_single, flags);
+        }
+
+        /**
+         * @brief gather_write - compress and send the buffers as one message, with one sendmsg when it fits IOV_MAX
+         * @return long - the plain bytes written
+         */
+        long gather_write(const std::vector<std::string_view>& buffers, const int flags = 0) {
+            auto size = _compressor.encode(buffers, _blocks);
+            while(!_blocks.empty()) { //a short write (signal, more blocks than IOV_MAX) resumes where it stopped
+                auto i = static_cast<size_t>(std::max(_socket.gather_write(_blocks, flags), 0L));
+                size_t sent = 0;
+                while(i > 0 && sent < _blocks.size()) {
+                    auto n = std::min(i, _blocks[sent].size());
+                    _blocks[sent].remove_prefix(n);
+                    i -= n;
+                    if(_blocks[sent].empty()) {
+                        ++sent;
+                    }
+                }
+                _blocks.erase(_blocks.begin(), _blocks.begin() + static_cast<long>(sent));
+            }
+            return static_cast<long>(size);
+        }
+
+        /**
+         * @brief read_some - up to size decompressed bytes, from the current block or the next
+         * @param flags - MSG_DONTWAIT returns -1 rather than wait for a whole block
+         * @return long - bytes read, 0 at end of stream
+         */
+        long read_some(char* buffer, const size_t size, const int flags = 0) {
+            if(_plain.empty() && !_next_block(flags)) {
+                return _reader.is_eof() ? 0 : -1;
+            }
+            auto n = std::min(size, _plain.size());
+            std::memcpy(buffer, _plain.data(), n);
+            _plain.remove_prefix(n);
+            return static_cast<long>(n);
+        }
+
+        /**
+         * @brief read - the rest of the current decompressed block, or the next, throws at end of stream like the product's read
+         */
+        std::string read(const int flags = 0) {
+            if(_plain.empty() && !_next_block(flags)) {
+                throw std::runtime_error(EMSG_COMPRESSION_CLOSED);
+            }
+            std::string buffer(_plain);
+            _plain = std::string_view();
+            return buffer;
+        }
+
+        void stop(action_t action) {
+            _socket.stop(action);
+        }
+
+        const compression_metrics_t& metrics() const {
+            return _compressor.metrics();
+        }
+
+        S& socket() {
+            return _socket;
+        }
+
+        unsigned int sockfd() const {
+            return _socket.sockfd();
+        }
+
+    private:
+
+        /**
+         * @brief _next_block - decode the next whole block into _plain, receiving until it has arrived
+         * @return bool - false at end of stream or when a non blocking receive found the block incomplete
+         */
+        bool _next_block(const int flags) {
+            while(true) {
+                auto data = _reader.data();
+                auto n = _compressor.block_size(data);
+                if(n > 0 && data.size() >= n) {
+                    _plain = _compressor.decode(data.substr(0, n));
+                    _reader.consume(n); //stored blocks are viewed in place, untouched until the next fill
+                    if(!_plain.empty()) {
+                        return true;
+                    }
+                    continue;
+                }
+                if(_reader.is_eof()) {
+                    if(_reader.buffered() > 0) {
+                        throw std::runtime_error(EMSG_COMPRESSION_FORMAT);
+                    }
+                    return false;
+                }
+                if(_reader.fill(flags) < 0) {
+                    return false;
+                }
+            }
+        }
+
+        S _socket;
+        stream_compressor _compressor;
+        buffered_reader<S> _reader; //reads _socket, after it
+        std::vector<std::string_view> _single;
+        std::vector<std::string_view> _blocks; //unsent blocks of the message being written
+        std::string_view _plain; //decoded and not yet read bytes of the current block
+
+    };
+
+}
+
+#endif // EP_SOCKETS_LZ4 || EP_SOCKETS_ZSTD
+
+#endif // COMPRESSED_STREAM_H
@@ -0,0 +1,236 @@
+#include "connection_pool.h"
+
+namespace net {
+
+    //------------lease implementation------------
+    connection_pool::lease::lease(endpoint_pool* pool, size_t slot): _pool(pool), _slot(slot) {}
+
+    connection_pool::lease::lease(lease&& other) noexcept:
+        _pool(other._pool), _slot(other._slot), _discard(other._discard) {
+        other._pool = nullptr; //the moved from lease no longer returns the connection
+    }
+
+    connection_pool::lease& connection_pool::lease::operator=(lease&& other) noexcept {
+        if(this != &other) {
+            _release();
+            _pool = other._pool;
+            _slot = other._slot;
+            _discard = other._discard;
+            other._pool = nullptr;
+        }
+        return *this;
+    }
+
+    tcp_client_socket& connection_pool::lease::operator*() const {
+        return *_pool->_slots[_slot].socket;
+    }
+
+    tcp_client_socket* connection_pool::lease::operator->() const {
+        return _pool->_slots[_slot].socket.get();
+    }
+
+    void connection_pool::lease::discard() {
+        _discard = true;
+    }
+
+    void connection_pool::lease::_release() {
+        if(_pool) {
+            _pool->_release(_slot, _discard);
+            _pool = nullptr;
+        }
+    }
+
+    connection_pool::lease::~lease() {
+        _release();
+    }
+
+    //------------endpoint_pool implementation------------
+    connection_pool::endpoint_pool::endpoint_pool(const endpoint_t& endpoint, const pool_options_t& options):
+        _endpoint(endpoint), _options(options), _slots(options.max_size) {}
+
+    connection_pool::lease connection_pool::endpoint_pool::checkout() {
+        auto deadline = std::chrono::steady_clock::now() + _options.checkout_timeout;
+        auto slot = _try_checkout();
+        while(slot == _slots.size()) { //slow path - every slot is in use so wait for a release
+            std::unique_lock<std::mutex> lock(_wait_mutex);
+            ++_waiters;
+            slot = _try_checkout(); //retry once registered as a waiter so a release in between is not missed
+            if(slot == _slots.size() && _available.wait_until(lock, deadline) == std::cv_status::timeout) {
+                slot = _try_checkout();
+                --_waiters;
+                if(slot == _slots.size()) {
+                    throw std::runtime_error(EMSG_POOL_EXHAUSTED);
+                }
+                break;
+            }
+            --_waiters;
+        }
+        if(!_slots[slot].socket) { //claimed an empty slot, or a dead connection was dropped
+            _connect(slot);
+        }
+        return lease(this, slot);
+    }
+
+    size_t connection_pool::endpoint_pool::_try_checkout() {
+        for(size_t i = 0; i < _slots.size(); ++i) {
+            auto& s = _slots[i];
+            int expected = IDLE;
+            if(s.state.load(std::memory_order_relaxed) == IDLE &&
+                    s.state.compare_exchange_strong(expected, BUSY, std::memory_order_acq_rel)) {
+                if(!s.socket->is_alive()) { //half closed, reset or stale data - reconnect in place
+                    s.socket.reset();
+                }
+                return i;
+            }
+        }
+        for(size_t i = 0; i < _slots.size(); ++i) {
+            auto& s = _slots[i];
+            int expected = EMPTY;
+            if(s.state.load(std::memory_order_relaxed) == EMPTY &&
+                    s.state.compare_exchange_strong(expected, BUSY, std::memory_order_acq_rel)) {
+                return i;
+            }
+        }
+        return _slots.size();
+    }
+
+    void connection_pool::endpoint_pool::_connect(size_t slot) {
+        auto& s = _slots[slot];
+        try {
+            s.socket = std::make_unique<tcp_client_socket>(_endpoint.address, _endpoint.port, _options.connect_timeout);
+            if(_options.keep_alive) {
+                s.socket->keep_alive(true);
+            }
+        } catch (...) {
+            _release(slot, true); //give the slot back before reporting the connect failure
+            throw;
+        }
+    }
+
+    void connection_pool::endpoint_pool::_release(size_t slot, bool discard) {
+        auto& s = _slots[slot];
+        if(discard || !s.socket) {
+            s.socket.reset();
+            s.state.store(EMPTY, std::memory_order_seq_cst);
+        } else {
+            s.idle_since.store(_now(), std::memory_order_relaxed);
+            s.state.store(IDLE, std::memory_order_seq_cst);
+        }
+        if(_waiters.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(_wait_mutex);
+            _available.notify_one();
+        }
+    }
+
+    void connection_pool::endpoint_pool::evict_idle() {
+        auto now = _now();
+        auto timeout = std::chrono::duration_cast<std::chrono::steady_clock::duration>(_options.idle_timeout).count();
+        auto open = size();
+        for(size_t i = _slots.size(); i-- > 0; ) { //highest slots are the least recently used
+            auto& s = _slots[i];
+            int expected = IDLE;
+            if(s.state.load(std::memory_order_relaxed) == IDLE &&
+                    s.state.compare_exchange_strong(expected, BUSY, std::memory_order_acq_rel)) {
+                auto expired = open > _options.min_size && now - s.idle_since.load(std::memory_order_relaxed) > timeout;
+                if(expired || !s.socket->is_alive()) {
+                    --open;
+                    _release(i, true);
+                } else {
+                    s.state.store(IDLE, std::memory_order_release);
+                }
+            }
+        }
+        for(size_t i = 0; i < _slots.size() && size() < _options.min_size; ++i) {
+            auto& s = _slots[i];
+            int expected = EMPTY;
+            if(s.state.load(std::memory_order_relaxed) == EMPTY &&
+                    s.state.compare_exchange_strong(expected, BUSY, std::memory_order_acq_rel)) {
+                try {
+                    _connect(i);
+                } catch (std::exception&) { //peer unavailable, try again next time round
+                    return;
+                }
+                _release(i, false);
+            }
+        }
+    }
+
+    size_t connection_pool::endpoint_pool::size() const {
+        size_t open = 0;
+        for(auto& s: _slots) {
+            if(s.state.load(std::memory_order_relaxed) != EMPTY) {
+                ++open;
+            }
+        }
+        return open;
+    }
+
+    const endpoint_t& connection_pool::endpoint_pool::endpoint() const {
+        return _endpoint;
+    }
+
+    int64_t connection_pool::endpoint_pool::_now() {
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    //------------connection_pool implementation------------
+    connection_pool::connection_pool(const pool_options_t& options): _options(options) {
+        if(_options.max_size == 0 || _options.min_size > _options.max_size) {
+            throw std::invalid_argument(EMSG_POOL_SIZES);
+        }
+        _reaper = std::thread(&connection_pool::_reap, this);
+    }
+
+    connection_pool::endpoint_pool& connection_pool::at(const endpoint_t& endpoint) {
+        {
+            std::shared_lock<std::shared_mutex> lock(_endpoints_mutex);
+            auto it = _endpoints.find(endpoint);
+            if(it != _endpoints.end()) {
+                return *it->second;
+            }
+        }
+        endpoint_pool* pool;
+        {
+            std::unique_lock<std::shared_mutex> lock(_endpoints_mutex);
+            auto& entry = _endpoints[endpoint];
+            if(entry) { //another thread got here first
+                return *entry;
+            }
+            entry = std::make_unique<endpoint_pool>(endpoint, _options);
+            pool = entry.get();
+        }
+        pool->evict_idle(); //fill to min_size outside the lock
+        return *pool;
+    }
+
+    connection_pool::lease connection_pool::checkout(const endpoint_t& endpoint) {
+        return at(endpoint).checkout();
+    }
+
+    void connection_pool::_reap() {
+        auto period = std::max(_options.idle_timeout / 2, std::chrono::milliseconds(1));
+        std::unique_lock<std::mutex> lock(_reaper_mutex);
+        while(!_reaper_wake.wait_for(lock, period, [this]{ return _stopping; })) {
+            std::vector<endpoint_pool*> pools;
+            {
+                std::shared_lock<std::shared_mutex> endpoints_lock(_endpoints_mutex);
+                for(auto& e: _endpoints) {
+                    pools.push_back(e.second.get());
+                }
+            }
+            for(auto pool: pools) {
+                pool->evict_idle();
+            }
+        }
+    }
+
+    connection_pool::~connection_pool() {
+        {
+            std::lock_guard<std::mutex> lock(_reaper_mutex);
+            _stopping = true;
+        }
+        _reaper_wake.notify_one();
+        _reaper.join();
+    }
+
+}
@@ -0,0 +1,185 @@
+#ifndef CONNECTION_POOL_H
+#define CONNECTION_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "socket_factory.h"
+
+namespace net {
+
+    /**
+     * @brief pool_options_t - sizing and reuse policy for the connections to one endpoint
+     */
+    struct pool_options_t {
+        size_t min_size = 0; //connections kept open even when idle
+        size_t max_size = 16; //hard cap on open connections, checkout waits once they are all in use
+        std::chrono::milliseconds idle_timeout{std::chrono::seconds(30)}; //idle connections above min_size are closed after this long
+        std::chrono::milliseconds checkout_timeout{std::chrono::seconds(5)}; //how long to wait for a connection when all are in use
+        std::chrono::milliseconds connect_timeout{std::chrono::seconds(3)}; //how long opening a connection may take, an unreachable endpoint fails after this rather than the kernel's SYN retries
+        bool keep_alive = true; //enable SO_KEEPALIVE on pooled connections
+    };
+
+    /**
+     * @brief The connection_pool class keeps connected tcp_client_sockets per endpoint for reuse by many threads.
+     * @version 0.5
+     * Each endpoint has a fixed array of max_size slots whose state is claimed with a compare and swap, so a checkout
+     * of an idle connection takes no lock. Locks are only taken to wait when every slot is in use and, briefly and shared,
+     * to find the endpoint - keep the endpoint_pool reference returned by at() to avoid even that on hot paths.
+     * Before an idle connection is handed out it is checked with is_alive() so connections the peer has half closed,
+     * reset or left stale data on are replaced rather than reused.
+     */
+    class connection_pool {
+
+        enum slot_state_t: int {EMPTY, BUSY, IDLE};
+
+    public:
+
+        class endpoint_pool;
+
+        /**
+         * @brief The lease class is a checked out connection that is returned to its pool when destroyed.
+         */
+        class lease {
+
+        public:
+
+            lease(endpoint_pool* pool, size_t slot);
+
+            lease(const lease&) = delete;
+
+            lease& operator= (const lease&) = delete;
+
+            lease(lease&& other) noexcept;
+
+            lease& operator= (lease&& other) noexcept;
+
+            tcp_client_socket& operator*() const;
+
+            tcp_client_socket* operator->() const;
+
+            /**
+             * @brief discard - close the connection on return rather than reuse it, e.g. after a failed read or write
+             */
+            void discard();
+
+            ~lease();
+
+        private:
+
+            void _release();
+
+            endpoint_pool* _pool;
+            size_t _slot;
+            bool _discard = false;
+
+        };
+
+        /**
+         * @brief The endpoint_pool class is the lock-free slot array of connections to a single endpoint.
+         */
+        class endpoint_pool {
+
+            friend class lease;
+
+            friend class connection_pool;
+
+        public:
+
+            endpoint_pool(const endpoint_t& endpoint, const pool_options_t& options);
+
+            /**
+             * @brief checkout - lease an idle, healthy connection or open a new one if there is room.
+             * @note waits up to checkout_timeout when max_size connections are already in use then throws.
+             * @return lease - the connection, returned to this pool when the lease is destroyed
+             */
+            lease checkout();
+
+            /**
+             * @brief evict_idle - close idle connections past the idle timeout down to min_size, then top back up to min_size
+             */
+            void evict_idle();
+
+            /**
+             * @brief size - connections currently open, idle or in use
+             */
+            size_t size() const;
+
+            const endpoint_t& endpoint() const;
+
+        private:
+
+            struct slot_t {
+                std::atomic<int> state{EMPTY};
+                std::atomic<int64_t> idle_since{0}; //steady clock ticks when last returned
+                std::unique_ptr<tcp_client_socket> socket;
+            };
+
+            /**
+             * @brief _try_checkout - one lock-free pass over the slots, prefers the lowest idle slot so surplus connections age out
+             * @return slot index claimed, or max_size if nothing is available
+             */
+            size_t _try_checkout();
+
+            void _connect(size_t slot);
+
+            void _release(size_t slot, bool discard);
+
+            static int64_t _now();
+
+            endpoint_t _endpoint;
+            pool_options_t _options;
+            std::vector<slot_t> _slots;
+            std::atomic<size_t> _waiters{0};
+            std::mutex _wait_mutex;
+            std::condition_variable _available;
+
+        };
+
+        /**
+         * @brief connection_pool - starts a reaper thread that runs evict_idle on every endpoint every half idle_timeout
+         * @param options - applied to every endpoint
+         */
+        explicit connection_pool(const pool_options_t& options = pool_options_t{});
+
+        connection_pool(const connection_pool&) = delete;
+
+        connection_pool& operator= (const connection_pool&) = delete;
+
+        /**
+         * @brief at - the pool for an endpoint, created (and filled to min_size) on first use.
+         * @note the reference stays valid for the lifetime of this connection_pool
+         */
+        endpoint_pool& at(const endpoint_t& endpoint);
+
+        /**
+         * @brief checkout - convenience for at(endpoint).checkout()
+         */
+        lease checkout(const endpoint_t& endpoint);
+
+        ~connection_pool();
+
+    private:
+
+        void _reap();
+
+        pool_options_t _options;
+        std::map<endpoint_t, std::unique_ptr<endpoint_pool>> _endpoints;
+        mutable std::shared_mutex _endpoints_mutex;
+        bool _stopping = false;
+        std::mutex _reaper_mutex;
+        std::condition_variable _reaper_wake;
+        std::thread _reaper;
+
+    };
+
+}
+
+#endif // CONNECTION_POOL_H
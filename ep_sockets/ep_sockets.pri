@@ -0,0 +1,69 @@
+#easy peasy sockets library sources shared by the demo app, benchmark and tools
+INCLUDEPATH += $$PWD
+
+#There are no porting issues with the socket library - implementation is in a file called ws2_32.dll and there are 32-bit and 64-bit versions of the DLL in 64-bit Windows
+win32 {
+    LIBS += -lws2_32
+}
+
+unix {
+    LIBS += -pthread
+}
+
+#optional TLS layer (tls_socket.h) over OpenSSL, qmake CONFIG+=ep_tls
+ep_tls {
+    DEFINES += EP_SOCKETS_TLS
+    LIBS += -lssl -lcrypto
+}
+
+#optional compression stage (compressed_stream.h), qmake CONFIG+=ep_lz4 and/or CONFIG+=ep_zstd
+ep_lz4 {
+    DEFINES += EP_SOCKETS_LZ4
+    LIBS += -llz4
+}
+
+ep_zstd {
+    DEFINES += EP_SOCKETS_ZSTD
+    LIBS += -lzstd
+}
+
+SOURCES += \
+        $$PWD/compressed_stream.cpp \
+        $$PWD/connection_pool.cpp \
+        $$PWD/event_loop.cpp \
+        $$PWD/http_server.cpp \
+        $$PWD/linux_socket.cpp \
+        $$PWD/pipelined_client.cpp \
+        $$PWD/protocol_parser.cpp \
+        $$PWD/reliable_udp.cpp \
+        $$PWD/shm_channel.cpp \
+        $$PWD/socket_factory.cpp \
+        $$PWD/timer_wheel.cpp \
+        $$PWD/tls_socket.cpp \
+        $$PWD/winsock_socket.cpp \
+        $$PWD/xdp_socket.cpp
+
+HEADERS += \
+    $$PWD/buffered_reader.h \
+    $$PWD/buffered_writer.h \
+    $$PWD/compressed_stream.h \
+    $$PWD/connection_pool.h \
+    $$PWD/event_loop.h \
+    $$PWD/http_server.h \
+    $$PWD/linux_socket.h \
+    $$PWD/message_codec.h \
+    $$PWD/pipelined_client.h \
+    $$PWD/protocol_parser.h \
+    $$PWD/reliable_udp.h \
+    $$PWD/shared_writer.h \
+    $$PWD/shm_channel.h \
+    $$PWD/socket_constants.h \
+    $$PWD/socket_errors.h \
+    $$PWD/socket_factory.h \
+    $$PWD/socketable.h \
+    $$PWD/timer_wheel.h \
+    $$PWD/tls_socket.h \
+    $$PWD/winsock_socket.h \
+    $$PWD/winsock_specific.h \
+    $$PWD/wsa_inetpton.h \
+    $$PWD/xdp_socket.h
@@ -0,0 +1,135 @@
+#include "event_loop.h"
+
+#ifdef __linux__
+
+#include "sys/eventfd.h"
+#include "unistd.h"
+
+#include "linux_socket.h"
+
+namespace net {
+
+    event_loop::event_loop(const std::chrono::milliseconds resolution): _timers(resolution) {
+        _epoll = epoll_create1(EPOLL_CLOEXEC);
+        if(_epoll < 0) {
+            throw std::runtime_error(base_socket::last_error());
+        }
+        _wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if(_wakeup < 0) {
+            close(_epoll);
+            throw std::runtime_error(base_socket::last_error());
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = _wakeup;
+        if(epoll_ctl(_epoll, EPOLL_CTL_ADD, _wakeup, &event) < 0) {
+            close(_wakeup);
+            close(_epoll);
+            throw std::runtime_error(base_socket::last_error());
+        }
+    }
+
+    void event_loop::add(const unsigned int sockfd, const uint32_t events, handler_t handler) {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = static_cast<int>(sockfd);
+        if(epoll_ctl(_epoll, EPOLL_CTL_ADD, static_cast<int>(sockfd), &event) < 0) {
+            throw std::runtime_error(base_socket::last_error());
+        }
+        _handlers[static_cast<int>(sockfd)] = std::make_shared<handler_t>(std::move(handler));
+    }
+
+    void event_loop::modify(const unsigned int sockfd, const uint32_t events) {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = static_cast<int>(sockfd);
+        if(epoll_ctl(_epoll, EPOLL_CTL_MOD, static_cast<int>(sockfd), &event) < 0) {
+            throw std::runtime_error(base_socket::last_error());
+        }
+    }
+
+    void event_loop::remove(const unsigned int sockfd) {
+        _handlers.erase(static_cast<int>(sockfd));
+        epoll_ctl(_epoll, EPOLL_CTL_DEL, static_cast<int>(sockfd), nullptr); //ENOENT or EBADF mean it is already gone
+    }
+
+    timer_wheel& event_loop::timers() {
+        return _timers;
+    }
+
+    void event_loop::post(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(_tasks_mutex);
+            _tasks.push_back(std::move(task));
+        }
+        _wake();
+    }
+
+    size_t event_loop::run_once(const std::chrono::milliseconds max_wait) {
+        auto wait = _timers.until_next();
+        if(max_wait.count() >= 0 && (wait.count() < 0 || max_wait < wait)) {
+            wait = max_wait;
+        }
+        std::array<epoll_event, MAX_EVENTS> events;
+        auto ready = epoll_wait(_epoll, events.data(), MAX_EVENTS, static_cast<int>(wait.count()));
+        if(ready < 0 && errno != EINTR) {
+            throw std::runtime_error(base_socket::last_error());
+        }
+        size_t ran = 0;
+        for(int i = 0; i < ready; ++i) {
+            auto fd = events[static_cast<size_t>(i)].data.fd;
+            if(fd == _wakeup) {
+                uint64_t count;
+                while(read(_wakeup, &count, sizeof(count)) > 0) {} //reset the eventfd
+                ran += _run_tasks();
+                continue;
+            }
+            auto it = _handlers.find(fd);
+            if(it == _handlers.end()) {
+                continue; //removed by an earlier handler in this batch
+            }
+            auto handler = it->second;
+            (*handler)(events[static_cast<size_t>(i)].events);
+            ++ran;
+        }
+        ran += _timers.advance();
+        return ran;
+    }
+
+    void event_loop::run() {
+        while(!_stopping.load(std::memory_order_acquire)) {
+            run_once();
+        }
+        _stopping.store(false, std::memory_order_release); //so the loop can be run again
+    }
+
+    void event_loop::stop() {
+        _stopping.store(true, std::memory_order_release);
+        _wake();
+    }
+
+    void event_loop::_wake() {
+        uint64_t one = 1;
+        if(write(_wakeup, &one, sizeof(one)) < 0) {} //EAGAIN means a wake up is already pending
+    }
+
+    size_t event_loop::_run_tasks() {
+        std::vector<std::function<void()>> tasks;
+        {
+            std::lock_guard<std::mutex> lock(_tasks_mutex);
+            tasks.swap(_tasks);
+        }
+        for(auto& task: tasks) {
+            task();
+        }
+        return tasks.size();
+    }
+
+    event_loop::~event_loop() {
+        close(_wakeup);
+        close(_epoll);
+    }
+
+}
+
+#endif // __linux__
@@ -0,0 +1,117 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#ifdef __linux__
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "sys/epoll.h"
+
+#include "timer_wheel.h"
+
+namespace net {
+
+    /**
+     * @brief The event_loop class multiplexes readiness of many sockets on one thread with epoll, and drives a timer_wheel
+     * so per-connection deadlines cost no threads and no SO_RCVTIMEO juggling.
+     * @version 0.5
+     * Handlers and timer callbacks run on the thread calling run or run_once, post and stop may be called from any thread.
+     * @note handlers may add, modify or remove any socket, including their own. A socket removed and a new one given the
+     * same descriptor within one batch of events can see one spurious wake up, so handlers should tolerate EAGAIN.
+     */
+    class event_loop {
+
+        static const int MAX_EVENTS = 256;
+
+    public:
+
+        /**
+         * @brief handler_t - called with the ready epoll events, e.g. EPOLLIN | EPOLLHUP
+         */
+        using handler_t = std::function<void(uint32_t events)>;
+
+        /**
+         * @brief event_loop
+         * @param resolution - tick length of the loop's timer wheel
+         */
+        explicit event_loop(const std::chrono::milliseconds resolution = std::chrono::milliseconds(1));
+
+        event_loop(const event_loop&) = delete;
+
+        event_loop& operator= (const event_loop&) = delete;
+
+        /**
+         * @brief add - watch a socket
+         * @param sockfd - socket file descriptor from a product's sockfd()
+         * @param events - formed by ORing one or more of: EPOLLIN, EPOLLOUT, EPOLLRDHUP, EPOLLPRI, EPOLLET, EPOLLONESHOT
+         * @param handler - called on this loop's thread when the socket is ready
+         */
+        void add(const unsigned int sockfd, const uint32_t events, handler_t handler);
+
+        /**
+         * @brief modify - change the events a watched socket is interested in
+         */
+        void modify(const unsigned int sockfd, const uint32_t events);
+
+        /**
+         * @brief remove - stop watching a socket, do this before the socket is closed
+         */
+        void remove(const unsigned int sockfd);
+
+        /**
+         * @brief timers - the wheel driven by this loop, only touch it from the loop's thread
+         */
+        timer_wheel& timers();
+
+        /**
+         * @brief post - run a task on the loop's thread, thread safe
+         */
+        void post(std::function<void()> task);
+
+        /**
+         * @brief run_once - wait for readiness or the next timer then dispatch everything that is due
+         * @param max_wait - upper bound on the wait, negative waits as long as the timers allow
+         * @return size_t - the number of handlers, tasks and timers run
+         */
+        size_t run_once(const std::chrono::milliseconds max_wait = std::chrono::milliseconds(-1));
+
+        /**
+         * @brief run - dispatch until stop is called
+         */
+        void run();
+
+        /**
+         * @brief stop - make run return, thread safe
+         */
+        void stop();
+
+        ~event_loop();
+
+    private:
+
+        void _wake();
+
+        size_t _run_tasks();
+
+        int _epoll;
+        int _wakeup; //eventfd used by post and stop to interrupt epoll_wait
+        std::unordered_map<int, std::shared_ptr<handler_t>> _handlers; //shared so a handler removing itself survives its own call
+        timer_wheel _timers;
+        std::mutex _tasks_mutex;
+        std::vector<std::function<void()>> _tasks;
+        std::atomic<bool> _stopping{false};
+
+    };
+
+}
+
+#endif // __linux__
+
+#endif // EVENT_LOOP_H
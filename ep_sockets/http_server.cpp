@@ -0,0 +1,472 @@
+#include "http_server.h"
+
+#ifdef __linux__
+
+#include <unordered_map>
+
+#include "fcntl.h"
+#include "netinet/tcp.h"
+
+#include "buffered_reader.h"
+#include "buffered_writer.h"
+#include "event_loop.h"
+#include "timer_wheel.h"
+
+namespace net {
+
+    namespace {
+
+        static const size_t READ_CAPACITY = 16 * 1024;
+        static const size_t MAX_ACCEPTS = 64; //per wake up, so one busy listener cannot starve the connections of its worker
+        static const std::chrono::milliseconds DRAIN_GRACE{100}; //idle connections wait this long for a request already on its way
+        static const std::chrono::milliseconds LINGER_TIMEOUT{2000}; //a drained client has this long to close after our end of stream
+
+        std::string_view reason_phrase(const int status) {
+            switch(status) {
+            case 200: return "OK";
+            case 201: return "Created";
+            case 204: return "No Content";
+            case 301: return "Moved Permanently";
+            case 302: return "Found";
+            case 304: return "Not Modified";
+            case 400: return "Bad Request";
+            case 401: return "Unauthorized";
+            case 403: return "Forbidden";
+            case 404: return "Not Found";
+            case 405: return "Method Not Allowed";
+            case 413: return "Content Too Large";
+            case 431: return "Request Header Fields Too Large";
+            case 500: return "Internal Server Error";
+            case 501: return "Not Implemented";
+            case 503: return "Service Unavailable";
+            default: return "Unknown";
+            }
+        }
+
+        std::string_view connection_field(const int connection) {
+            static const std::array<std::string_view, 3> fields = {"", "keep-alive", "close"};
+            return fields[static_cast<size_t>(connection)];
+        }
+
+    }
+
+    //------------worker implementation------------
+    /**
+     * @brief The worker struct is one event loop thread and the connections it accepted.
+     */
+    struct http_server::worker {
+
+        struct connection {
+
+            connection(tcp_active_socket&& active, timer_wheel& wheel, const http_server_options_t& options, const writer_options_t& writer_options):
+                socket(std::move(active)),
+                reader(socket, READ_CAPACITY, options.max_head_size + options.max_body_size),
+                writer(socket, writer_options),
+                deadlines(wheel, socket) {}
+
+            tcp_active_socket socket;
+            buffered_reader<tcp_active_socket> reader;
+            buffered_writer<tcp_active_socket> writer;
+            connection_deadlines deadlines; //IDLE shuts the socket down, the loop then sees end of stream and closes it
+            uint32_t events = EPOLLIN; //currently registered with the loop
+            bool closing = false; //answered a "Connection: close" or an error, close once the writer drains
+            bool lingering = false; //shut down for writing while draining, close once the client's end of stream arrives
+
+        };
+
+        explicit worker(http_server& owner): server(owner) {
+            writer_options.flush_flags = MSG_DONTWAIT | MSG_NOSIGNAL;
+            writer_options.high_watermark = 1024 * 1024;
+            writer_options.low_watermark = 256 * 1024;
+            loop.add(server._listener.sockfd(), EPOLLIN | EPOLLEXCLUSIVE, [this](uint32_t) {
+                on_accept();
+            });
+        }
+
+        void on_accept() {
+            try {
+                server._listener.accept_batch(accepted, MAX_ACCEPTS);
+            } catch (std::exception&) {
+                return; //e.g. out of descriptors, retried on the next wake up
+            }
+            for(auto sockfd: accepted) {
+                auto fd = static_cast<int>(sockfd);
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); //the writer already coalesces, Nagle would only delay
+                auto c = std::make_unique<connection>(tcp_active_socket(static_cast<unsigned int>(fd)), loop.timers(), server._options, writer_options);
+                c->deadlines.arm(deadline_t::IDLE, server._options.idle_timeout);
+                connections[fd] = std::move(c);
+                loop.add(static_cast<unsigned int>(fd), EPOLLIN, [this, fd](uint32_t events) {
+                    on_event(fd, events);
+                });
+            }
+        }
+
+        void on_event(const int fd, const uint32_t events) {
+            auto it = connections.find(fd);
+            if(it == connections.end()) {
+                return;
+            }
+            auto& c = *it->second;
+            if(events & (EPOLLHUP | EPOLLERR)) { //reset, or both directions shut down e.g. by the idle deadline
+                close(fd);
+                return;
+            }
+            if(c.lingering) {
+                discard(fd, c);
+                return;
+            }
+            try {
+                if(events & EPOLLOUT) {
+                    c.writer.flush(writer_options.flush_flags);
+                }
+                if(!c.closing && c.writer.is_writable()) {
+                    long n = -1;
+                    if(events & EPOLLIN) {
+                        n = c.reader.fill(MSG_DONTWAIT);
+                        if(n > 0) {
+                            c.deadlines.arm(deadline_t::IDLE, server._options.idle_timeout);
+                        }
+                    }
+                    process(c); //also picks up pipelined requests left over when the writer pushed back
+                    c.closing = c.closing || n == 0; //the peer half closed, answer what it sent then close
+                    c.writer.flush(writer_options.flush_flags);
+                }
+            } catch (std::exception&) { //reset by the peer or the send failed
+                close(fd);
+                return;
+            }
+            if(c.closing && c.writer.buffered() == 0) {
+                close(fd);
+                return;
+            }
+            if(draining && is_idle(c)) { //its last response before the drain has just left
+                linger(fd, c);
+                return;
+            }
+            uint32_t wanted = (!c.closing && c.writer.is_writable() ? EPOLLIN : 0u) | (c.writer.buffered() ? EPOLLOUT : 0u);
+            if(wanted != c.events) {
+                c.events = wanted;
+                loop.modify(static_cast<unsigned int>(fd), wanted);
+            }
+        }
+
+        /**
+         * @brief process - answer every complete request in the read buffer, in order
+         */
+        void process(connection& c) {
+            while(!c.closing && c.writer.is_writable()) {
+                auto data = c.reader.data();
+                size_t head;
+                size_t length;
+                try {
+                    head = parse_http_request(data, request);
+                    if(head == 0) {
+                        if(data.size() > server._options.max_head_size) {
+                            respond_error(c, 431);
+                        }
+                        return;
+                    }
+                    length = request.content_length();
+                } catch (std::runtime_error&) {
+                    respond_error(c, 400);
+                    return;
+                }
+                if(request.header("Transfer-Encoding")) {
+                    respond_error(c, 501);
+                    return;
+                }
+                if(length > server._options.max_body_size) {
+                    respond_error(c, 413);
+                    return;
+                }
+                if(data.size() < head + length) {
+                    return; //the body is still arriving
+                }
+                auto connection = draining || !request.keep_alive() ? CLOSE : request.minor_version == 0 ? KEEP_ALIVE_EXPLICIT : KEEP_ALIVE_DEFAULT;
+                respond(c, data.substr(head, length), connection);
+                c.reader.consume(head + length);
+                c.closing = connection == CLOSE;
+            }
+        }
+
+        void respond(connection& c, std::string_view body, const int connection) {
+            auto is_head = request.method == "HEAD";
+            if(is_head || request.method == "GET") {
+                auto route = server._routes.find(request.target.substr(0, request.target.find('?')));
+                if(route != server._routes.end()) {
+                    std::string_view preformatted = route->second.response[static_cast<size_t>(connection)];
+                    c.writer.write(is_head ? preformatted.substr(0, route->second.head_size[static_cast<size_t>(connection)]) : preformatted);
+                    return;
+                }
+            }
+            response.status = 404;
+            response.content_type = "text/plain";
+            response.body.clear();
+            response.headers.clear();
+            if(server._handler) {
+                response.status = 200;
+                try {
+                    server._handler(request, body, response);
+                } catch (std::exception&) {
+                    response = http_response_t{};
+                    response.status = 500;
+                }
+            }
+            auto formatted = format_response(response, connection_field(connection));
+            if(is_head) {
+                formatted.resize(formatted.size() - response.body.size());
+            }
+            c.writer.write(std::move(formatted));
+        }
+
+        void respond_error(connection& c, const int status) {
+            http_response_t error;
+            error.status = status;
+            c.writer.write(format_response(error, connection_field(CLOSE)));
+            c.closing = true;
+        }
+
+        void close(const int fd) {
+            loop.remove(static_cast<unsigned int>(fd));
+            connections.erase(fd);
+            if(draining && connections.empty()) {
+                finish();
+            }
+        }
+
+        void stop_accepting() {
+            if(accepting) {
+                loop.remove(server._listener.sockfd());
+                accepting = false;
+            }
+        }
+
+        /**
+         * @brief drain - stop accepting and close every connection as soon as it has no request in progress, requests that
+         * arrive meanwhile are answered with "Connection: close"
+         */
+        void drain() {
+            stop_accepting();
+            draining = true;
+            if(connections.empty()) {
+                finish();
+                return;
+            }
+            grace.on_expiry([this]() {
+                close_idle();
+            });
+            loop.timers().arm(grace, DRAIN_GRACE);
+        }
+
+        void close_idle() {
+            std::vector<int> idle;
+            for(auto& entry: connections) {
+                if(is_idle(*entry.second)) {
+                    idle.push_back(entry.first);
+                }
+            }
+            for(auto fd: idle) {
+                linger(fd, *connections[fd]);
+            }
+        }
+
+        /**
+         * @brief cut - the drain deadline passed, close whatever is left
+         */
+        void cut() {
+            if(finished) {
+                return;
+            }
+            for(auto& entry: connections) {
+                cut_connections += entry.second->lingering ? 0 : 1; //a lingering one has had its end of stream already
+                loop.remove(static_cast<unsigned int>(entry.first));
+            }
+            connections.clear();
+            finish();
+        }
+
+        bool is_idle(connection& c) {
+            return !c.closing && c.writer.buffered() == 0 && c.reader.data().empty();
+        }
+
+        //send end of stream but keep reading, closing at once with unread data would reset a request already on its way
+        void linger(const int fd, connection& c) {
+            try {
+                c.socket.stop(action_t::WRITE);
+            } catch (std::exception&) {
+                close(fd);
+                return;
+            }
+            c.closing = true;
+            c.lingering = true;
+            c.deadlines.arm(deadline_t::IDLE, LINGER_TIMEOUT); //clients holding a pooled connection open may not look at it for a while
+            if(c.events != EPOLLIN) {
+                c.events = EPOLLIN;
+                loop.modify(static_cast<unsigned int>(fd), EPOLLIN);
+            }
+        }
+
+        void discard(const int fd, connection& c) {
+            std::array<char, 4096> buffer;
+            long n;
+            try {
+                while((n = c.socket.read_some(buffer.data(), buffer.size(), MSG_DONTWAIT)) > 0) {}
+            } catch (std::exception&) {
+                n = 0;
+            }
+            if(n == 0) { //the client closed too, or reset
+                close(fd);
+            }
+        }
+
+        void finish() {
+            if(!finished) {
+                finished = true;
+                drained.set_value();
+                loop.stop();
+            }
+        }
+
+        http_server& server;
+        writer_options_t writer_options;
+        std::vector<unsigned int> accepted; //reused by every on_accept
+        event_loop loop;
+        std::unordered_map<int, std::unique_ptr<connection>> connections; //declared after loop so they go before its timer wheel
+        bool accepting = true;
+        bool draining = false;
+        bool finished = false;
+        size_t cut_connections = 0;
+        std::promise<void> drained; //set once draining left no connections, or the deadline cut them
+        timer_wheel::timer grace; //after loop, a timer cancels itself from its wheel
+        http_request_t request; //reused by every request so steady state parsing does not allocate
+        http_response_t response;
+
+    };
+
+    //------------http_server implementation------------
+    http_server::http_server(const std::string addr, const unsigned short port, const http_server_options_t& options):
+        http_server(tcp_server_socket(addr, port, options.backlog), options) {}
+
+    http_server::http_server(tcp_server_socket&& listener, const http_server_options_t& options):
+        _options(options), _listener(std::move(listener)) {
+        _options.threads = std::max<size_t>(_options.threads, 1);
+        auto flags = fcntl(static_cast<int>(_listener.sockfd()), F_GETFL, 0);
+        if(flags < 0 || fcntl(static_cast<int>(_listener.sockfd()), F_SETFL, flags | O_NONBLOCK) < 0) {
+            throw std::runtime_error(base_socket::last_error());
+        }
+    }
+
+    void http_server::serve_static(const std::string& target, const std::string& content_type, const std::string& body) {
+        http_response_t response;
+        response.content_type = content_type;
+        response.body = body;
+        static_route_t route;
+        for(int connection = KEEP_ALIVE_DEFAULT; connection <= CLOSE; ++connection) {
+            auto i = static_cast<size_t>(connection);
+            route.response[i] = format_response(response, connection_field(connection));
+            route.head_size[i] = route.response[i].size() - body.size();
+        }
+        _routes[target] = std::move(route);
+    }
+
+    void http_server::on_request(handler_t handler) {
+        _handler = std::move(handler);
+    }
+
+    void http_server::start() {
+        if(!_threads.empty()) {
+            return;
+        }
+        for(size_t i = 0; i < _options.threads; ++i) {
+            _workers.push_back(std::make_unique<worker>(*this));
+        }
+        for(auto& w: _workers) {
+            _threads.emplace_back([loop = &w->loop]() {
+                loop->run();
+            });
+        }
+    }
+
+    void http_server::stop() {
+        for(auto& w: _workers) {
+            w->loop.stop();
+        }
+        for(auto& t: _threads) {
+            t.join();
+        }
+        _threads.clear();
+        _workers.clear();
+    }
+
+    void http_server::hand_over(const std::string& path) {
+        _stop_accepting();
+        _listener.hand_over(path);
+    }
+
+    size_t http_server::drain(const std::chrono::milliseconds deadline) {
+        auto until = std::chrono::steady_clock::now() + deadline;
+        std::vector<std::future<void>> drained;
+        for(auto& w: _workers) {
+            drained.push_back(w->drained.get_future());
+            w->loop.post([w = w.get()]() {
+                w->drain();
+            });
+        }
+        for(size_t i = 0; i < drained.size(); ++i) {
+            if(drained[i].wait_until(until) == std::future_status::timeout) {
+                _workers[i]->loop.post([w = _workers[i].get()]() {
+                    w->cut();
+                });
+            }
+        }
+        for(auto& t: _threads) {
+            t.join();
+        }
+        size_t cut = 0;
+        for(auto& w: _workers) {
+            cut += w->cut_connections;
+        }
+        _threads.clear();
+        _workers.clear();
+        return cut;
+    }
+
+    void http_server::_stop_accepting() {
+        std::vector<std::future<void>> stopped;
+        for(auto& w: _workers) {
+            auto done = std::make_shared<std::promise<void>>();
+            stopped.push_back(done->get_future());
+            w->loop.post([w = w.get(), done]() {
+                w->stop_accepting();
+                done->set_value();
+            });
+        }
+        for(auto& s: stopped) {
+            s.wait();
+        }
+    }
+
+    std::string http_server::format_response(const http_response_t& response, std::string_view connection) {
+        std::string s;
+        s.reserve(128 + response.body.size());
+        s.append("HTTP/1.1 ").append(std::to_string(response.status)).append(" ").append(reason_phrase(response.status)).append("\r\n");
+        s.append("Content-Type: ").append(response.content_type).append("\r\n");
+        s.append("Content-Length: ").append(std::to_string(response.body.size())).append("\r\n");
+        for(auto& field: response.headers) {
+            s.append(field.first).append(": ").append(field.second).append("\r\n");
+        }
+        if(!connection.empty()) {
+            s.append("Connection: ").append(connection).append("\r\n");
+        }
+        s.append("\r\n").append(response.body);
+        return s;
+    }
+
+    http_server::~http_server() {
+        stop();
+    }
+
+}
+
+#endif // __linux__
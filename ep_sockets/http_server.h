@@ -0,0 +1,152 @@
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#ifdef __linux__
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "socket_factory.h"
+#include "protocol_parser.h"
+
+namespace net {
+
+    /**
+     * @brief http_response_t - what a dynamic request handler answers with
+     */
+    struct http_response_t {
+        int status = 200;
+        std::string content_type = "text/plain";
+        std::string body;
+        std::vector<std::pair<std::string, std::string>> headers; //extra header fields
+    };
+
+    /**
+     * @brief http_server_options_t - worker threads, limits and timeouts of an http_server
+     */
+    struct http_server_options_t {
+        size_t threads = 1; //each runs its own event_loop, connections are spread by whichever accepts first
+        std::chrono::milliseconds idle_timeout{60000}; //keep-alive connections with no request for this long are closed
+        size_t max_head_size = 64 * 1024; //larger request heads are answered 431
+        size_t max_body_size = 1024 * 1024; //larger request bodies are answered 413
+        int backlog = SOMAXCONN; //connections the kernel queues for accepting, capped at net.core.somaxconn
+    };
+
+    /**
+     * @brief The http_server class is a small HTTP/1.1 server for internal endpoints built from this library's parts:
+     * non blocking accept on an epoll event_loop per worker thread, a buffered_reader parsed in place by protocol_parser,
+     * a buffered_writer that coalesces every response of a read into one sendmsg, and idle deadlines on the loop's timer_wheel.
+     * @version 0.5
+     * Keep-alive and pipelining follow HTTP/1.1 - requests already buffered are all answered before the next read and the
+     * responses leave together. Static routes are preformatted once (status line, headers and body) so serving them is a lookup
+     * and a copy. Anything else goes to the request handler, or is answered 404.
+     * Requests with Transfer-Encoding (chunked bodies) are answered 501 and closed, bodies need a Content-Length.
+     * For a restart without refused or reset connections the new process takes the listener over (hand_over) and the old one drains.
+     * @note register routes and the handler before start, the handler runs on the worker threads concurrently.
+     */
+    class http_server {
+
+    public:
+
+        /**
+         * @brief handler_t - fill in the response to a request, body is the request body (views valid during the call only)
+         */
+        using handler_t = std::function<void(const http_request_t& request, std::string_view body, http_response_t& response)>;
+
+        /**
+         * @brief http_server - binds and listens at once so the port is ready before start
+         */
+        http_server(const std::string addr, const unsigned short port, const http_server_options_t& options = http_server_options_t{});
+
+        /**
+         * @brief http_server - serve on a listening socket that already exists, e.g. tcp_server_socket::take_over of the previous process's
+         */
+        explicit http_server(tcp_server_socket&& listener, const http_server_options_t& options = http_server_options_t{});
+
+        http_server(const http_server&) = delete;
+
+        http_server& operator= (const http_server&) = delete;
+
+        /**
+         * @brief serve_static - answer GET and HEAD of target with a preformatted 200 response
+         */
+        void serve_static(const std::string& target, const std::string& content_type, const std::string& body);
+
+        /**
+         * @brief on_request - handler for every request without a static route
+         */
+        void on_request(handler_t handler);
+
+        /**
+         * @brief start - run the worker threads, returns at once
+         */
+        void start();
+
+        /**
+         * @brief stop - stop the workers and close their connections, also done by the destructor
+         */
+        void stop();
+
+        /**
+         * @brief hand_over - stop accepting and send the listener to the process waiting in tcp_server_socket::take_over at path, it goes on
+         * accepting from the same queue so no connection attempt is refused or reset - then drain this server's connections
+         * @param path - the new process's local (AF_UNIX) path, "@name" for the abstract namespace
+         */
+        void hand_over(const std::string& path);
+
+        /**
+         * @brief drain - stop accepting, close idle keep-alive connections, answer requests already arriving with "Connection: close"
+         * and wait for those connections to finish, then stop the workers. Connections are closed gracefully - the server's side is
+         * shut down first and the client's end of stream awaited - so a request racing the close is not answered with a reset.
+         * @param deadline - connections still open after this long are closed regardless
+         * @return size_t - the number of connections closed at the deadline
+         */
+        size_t drain(const std::chrono::milliseconds deadline);
+
+        /**
+         * @brief format_response - a complete response, as written for dynamic handlers
+         * @param connection - the Connection header field value or empty for none
+         */
+        static std::string format_response(const http_response_t& response, std::string_view connection = std::string_view());
+
+        ~http_server();
+
+    private:
+
+        //preformatted responses of a static route - indexed by connection_t below, HEAD sends the first head_size bytes
+        struct static_route_t {
+            std::array<std::string, 3> response;
+            std::array<size_t, 3> head_size;
+        };
+
+        enum connection_t {KEEP_ALIVE_DEFAULT, KEEP_ALIVE_EXPLICIT, CLOSE}; //no Connection field, "keep-alive" (HTTP/1.0), "close"
+
+        struct worker;
+
+        //have every worker stop accepting, and wait until they have
+        void _stop_accepting();
+
+        http_server_options_t _options;
+        tcp_server_socket _listener;
+        std::map<std::string, static_route_t, std::less<>> _routes; //transparent so lookups by string_view need no allocation
+        handler_t _handler;
+        std::vector<std::unique_ptr<worker>> _workers;
+        std::vector<std::thread> _threads;
+
+    };
+
+}
+
+#endif // __linux__
+
+#endif // HTTP_SERVER_H
@@ -15,23 +15,99 @@ namespace net {
         assert(_socket >= 0);
     }
 
+    base_socket::base_socket(base_socket&& other) noexcept:
+        _address_family(other._address_family), _socket_type(other._socket_type), _protocol(other._protocol),
+        _socket(other._socket), _addr(other._addr), _raddr(other._raddr), _raddr_len(other._raddr_len),
+        _spin_budget(other._spin_budget) {
+        other._socket = static_cast<sockfd_t>(INVALID_SOCKET); //the moved from destructor now leaves the descriptor alone
+    }
+
+    base_socket& base_socket::operator=(base_socket&& other) noexcept {
+        if(this != &other) {
+            _close();
+            _address_family = other._address_family;
+            _socket_type = other._socket_type;
+            _protocol = other._protocol;
+            _socket = other._socket;
+            _addr = other._addr;
+            _raddr = other._raddr;
+            _raddr_len = other._raddr_len;
+            _spin_budget = other._spin_budget;
+            other._socket = static_cast<sockfd_t>(INVALID_SOCKET);
+        }
+        return *this;
+    }
+
     int base_socket::_assign_address(const std::string &address, const unsigned short port) {
         _addr.sin_family = _address_family;
         _addr.sin_port = htons(port); //ensure numbers are stored in memory in network byte order (bigendian) as opposed to machine order (eg little endian if intel)
         return inet_pton(_address_family, address.c_str(), &(_addr.sin_addr)); //convert the Internet address in its standard text format into its numeric binary form
     }
 
+    ip_mreq base_socket::_group_request(const std::string& group, const std::string& interface_addr) {
+        ip_mreq request{};
+        if(inet_pton(AF_INET, group.c_str(), &request.imr_multiaddr) != 1 || inet_pton(AF_INET, interface_addr.c_str(), &request.imr_interface) != 1) {
+            throw std::runtime_error(EMSG_INET_PTON);
+        }
+        return request;
+    }
+
+    socklen_t base_socket::_local_address(const std::string& path, sockaddr_un& addr) {
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if(path.size() >= sizeof(addr.sun_path)) { //room for the terminating NUL of a file path
+            throw std::runtime_error(EMSG_LOCAL_PATH);
+        }
+        memcpy(addr.sun_path, path.data(), path.size());
+        if(!path.empty() && path.front() == ABSTRACT_PREFIX) {
+            addr.sun_path[0] = '\0'; //abstract names are not NUL terminated, their length is all the kernel goes by
+            return static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size());
+        }
+        return static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size() + (path.empty() ? 0 : 1)); //family alone autobinds
+    }
+
+    void base_socket::_spin_readable(const int flags) const {
+        if(_spin_budget.count() == 0 || (flags & MSG_DONTWAIT)) {
+            return;
+        }
+        auto until = std::chrono::steady_clock::now() + _spin_budget;
+        char c;
+        do { //anything but EAGAIN, data, end of stream or an error, is for the real read to take or report
+            if(recv(static_cast<int>(_socket), &c, 1, MSG_PEEK | MSG_DONTWAIT) >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                return;
+            }
+        } while(std::chrono::steady_clock::now() < until);
+    }
+
     void base_socket::_reset_socket(sockfd_t socket) {
-        char optval = 1; //option data depends on command here 1 enables reuse
-        socklen_t optlen = sizeof(char); //length of the option data here a single byte field
-        if (setsockopt(static_cast<int>(socket),
-                  SOL_SOCKET, //manipulates options at the sockets API level
-                  (SO_REUSEPORT | SO_REUSEADDR), //Enables fast restart by telling kernel to reuse even if busy
-                  &optval, optlen) == -1) {
-                  throw std::runtime_error(last_error());
+        int optval = 1; //option data depends on command here 1 enables reuse
+        socklen_t optlen = sizeof(optval); //Linux rejects boolean socket options shorter than an int
+        for(auto option: {SO_REUSEADDR, SO_REUSEPORT}) { //separate options, they cannot be ORed together
+            if (setsockopt(static_cast<int>(socket),
+                      SOL_SOCKET, //manipulates options at the sockets API level
+                      option, //Enables fast restart by telling kernel to reuse even if busy
+                      &optval, optlen) == -1) {
+                      throw std::runtime_error(last_error());
+            }
         }
     }
 
+    void base_socket::_set_blocking(sockfd_t socket, const bool blocking) {
+        auto flags = fcntl(static_cast<int>(socket), F_GETFL, 0);
+        if(flags < 0 || fcntl(static_cast<int>(socket), F_SETFL, blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK)) < 0) {
+            throw std::runtime_error(last_error());
+        }
+    }
+
+    int base_socket::_pending_error(sockfd_t socket) {
+        int error = 0;
+        socklen_t len = sizeof(error);
+        if(getsockopt(static_cast<int>(socket), SOL_SOCKET, SO_ERROR, &error, &len) < 0) {
+            return errno;
+        }
+        return error;
+    }
+
     std::string base_socket::_read(sockfd_t socket, const int flags) {
         std::array<char, DEFAULT_BUFFER_SIZE> buffer;
         auto i = recv(static_cast<int>(socket),
@@ -56,29 +132,69 @@ namespace net {
         return i;
     }
 
-    std::string base_socket::_read_from(sockfd_t socket, sockaddr_in &addr, const int flags) {
+    std::string base_socket::_read_from(sockfd_t socket, sockaddr_storage &addr, socklen_t& len, const int flags) {
         std::array<char, DEFAULT_BUFFER_SIZE> buffer;
-        socklen_t len_raddr = sizeof(_raddr);
+        len = sizeof(addr);
         auto i = recvfrom(static_cast<int>(socket),
                           &buffer.front(),
                           buffer.size(),
                           flags,
                           reinterpret_cast<struct sockaddr*>(&addr),
-                          &len_raddr);
+                          &len);
+        if(i <= 0) { //return the number of bytes received, or -1 if an error occurred.
+            throw std::runtime_error(last_error());
+        }
+        return std::string(buffer.begin(), static_cast<size_t>(i));
+    }
+
+    std::string base_socket::_read_stamped(sockfd_t socket, sockaddr_storage* addr, socklen_t* len, rx_timestamp_t& stamp, const int flags) {
+        std::array<char, DEFAULT_BUFFER_SIZE> buffer;
+        alignas(cmsghdr) std::array<char, CMSG_SPACE(3 * sizeof(timespec)) + CMSG_SPACE(sizeof(timespec))> control;
+        iovec iov{buffer.data(), buffer.size()};
+        msghdr msg{};
+        msg.msg_name = addr;
+        msg.msg_namelen = addr ? sizeof(*addr) : 0;
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+        auto i = recvmsg(static_cast<int>(socket), &msg, flags);
         if(i <= 0) { //return the number of bytes received, or -1 if an error occurred.
             throw std::runtime_error(last_error());
         }
+        if(len) {
+            *len = msg.msg_namelen;
+        }
+        auto nanoseconds = [](const timespec& ts) {
+            return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+        };
+        stamp = rx_timestamp_t{};
+        for(auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if(cmsg->cmsg_level != SOL_SOCKET) {
+                continue;
+            }
+            if(cmsg->cmsg_type == SCM_TIMESTAMPING) { //software, a legacy slot always zero, raw hardware
+                std::array<timespec, 3> ts;
+                memcpy(ts.data(), CMSG_DATA(cmsg), sizeof(ts));
+                stamp.software = nanoseconds(ts[0]);
+                stamp.hardware = nanoseconds(ts[2]);
+            } else if(cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                timespec ts;
+                memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                stamp.software = nanoseconds(ts);
+            }
+        }
         return std::string(buffer.begin(), static_cast<size_t>(i));
     }
 
-    long base_socket::_write_back(sockfd_t socket, const std::string& buffer, sockaddr_in& addr, const int flags) {
+    long base_socket::_write_back(sockfd_t socket, const std::string& buffer, const sockaddr_storage& addr, const socklen_t len, const int flags) {
         //transmit message in buffer
         auto i = sendto(static_cast<int>(socket),
                         buffer.c_str(),
                         buffer.size(),
                         flags,
-                        reinterpret_cast<struct sockaddr*>(&addr),
-                        sizeof(_raddr));
+                        reinterpret_cast<const struct sockaddr*>(&addr),
+                        len);
         if(i <= 0) { //return the number of bytes sent, or -1 if an error occurred.
             throw std::runtime_error(last_error());
         }
@@ -100,6 +216,115 @@ namespace net {
         }
     }
 
+    void base_socket::connect_to(const std::string& address, const unsigned short port, const std::chrono::milliseconds timeout) {
+        auto e = _assign_address(address, port); //use helper to convert text address and port to its numeric form
+        if(e < 0) {
+            throw std::runtime_error(last_error());
+        }
+        if(e == 0) {
+            throw std::runtime_error(EMSG_INET_PTON);
+        }
+        connect_to_first({{address, port}}, timeout, timeout); //a race with a single runner
+    }
+
+    void base_socket::connect_to_first(const std::vector<endpoint_t>& candidates, const std::chrono::milliseconds timeout, const std::chrono::milliseconds stagger) {
+        using steady = std::chrono::steady_clock;
+        struct attempt_t {
+            struct sockaddr_in addr;
+        };
+        std::vector<attempt_t> attempts;
+        std::vector<pollfd> fds; //a failed attempt's fd is set negative so poll ignores it
+        auto deadline = steady::now() + timeout;
+        auto next_start = steady::now();
+        size_t next = 0;
+        int last_errno = ETIMEDOUT;
+        int winner = -1;
+        auto close_all = [&fds](int keep) {
+            for(auto& p: fds) {
+                if(p.fd >= 0 && p.fd != keep) {
+                    close(p.fd);
+                }
+            }
+        };
+        while(winner < 0) {
+            auto now = steady::now();
+            auto pending = std::any_of(fds.begin(), fds.end(), [](const pollfd& p){ return p.fd >= 0; });
+            if(next < candidates.size() && (now >= next_start || !pending)) { //start the next attempt
+                const auto& candidate = candidates[next++];
+                struct sockaddr_in addr{};
+                addr.sin_family = _address_family;
+                addr.sin_port = htons(candidate.port);
+                if(inet_pton(_address_family, candidate.address.c_str(), &addr.sin_addr) != 1) {
+                    last_errno = EINVAL;
+                    continue;
+                }
+                auto s = socket(_address_family, _socket_type, _protocol);
+                if(s < 0) {
+                    last_errno = errno;
+                    continue;
+                }
+                try {
+                    _set_blocking(static_cast<sockfd_t>(s), false);
+                } catch (...) { //give back every descriptor the race has opened
+                    close(s);
+                    close_all(-1);
+                    throw;
+                }
+                if(connect(s, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 && errno != EINPROGRESS) {
+                    last_errno = errno; //e.g. loopback refusals are reported immediately
+                    close(s);
+                    continue;
+                }
+                attempts.push_back({addr});
+                fds.push_back(pollfd{s, POLLOUT, 0});
+                next_start = now + stagger;
+                continue;
+            }
+            if(!pending && next >= candidates.size()) {
+                break; //every candidate has failed
+            }
+            if(now >= deadline) {
+                last_errno = ETIMEDOUT;
+                break;
+            }
+            auto wake = next < candidates.size() ? std::min(deadline, next_start) : deadline;
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(wake - now + std::chrono::microseconds(999)).count();
+            if(poll(fds.data(), fds.size(), static_cast<int>(wait)) < 0 && errno != EINTR) {
+                last_errno = errno;
+                break;
+            }
+            for(size_t i = 0; i < fds.size() && winner < 0; ++i) {
+                if(fds[i].fd < 0 || !fds[i].revents) {
+                    continue;
+                }
+                auto error = _pending_error(static_cast<sockfd_t>(fds[i].fd));
+                if(error == 0 && (fds[i].revents & POLLOUT)) {
+                    winner = static_cast<int>(i);
+                } else {
+                    last_errno = error ? error : ECONNREFUSED;
+                    close(fds[i].fd);
+                    fds[i].fd = -1;
+                }
+            }
+        }
+        if(winner < 0) {
+            close_all(-1);
+            errno = last_errno;
+            throw std::runtime_error(last_error());
+        }
+        auto s = fds[static_cast<size_t>(winner)].fd;
+        close_all(s);
+        try {
+            _set_blocking(static_cast<sockfd_t>(s), true);
+        } catch (...) { //_socket stays the unconnected socket it was
+            close(s);
+            throw;
+        }
+        close(static_cast<int>(_socket)); //replace the unconnected socket with the winner
+        _socket = static_cast<sockfd_t>(s);
+        _addr = attempts[static_cast<size_t>(winner)].addr;
+    }
+
     void base_socket::bind_to(const std::string& address, const unsigned short port) {
         auto e = _assign_address(address, port); //use helper to convert text address and port to its numeric form
         if(e < 0) {
@@ -114,23 +339,50 @@ namespace net {
         }
     }
 
-    unsigned int base_socket::accept_and_create_sockfd() {
-        assert(is_listening());
-        socklen_t len_raddr = sizeof(_raddr);
-        auto s = accept(static_cast<int>(_socket), //this bound and listening socket's file descriptor
+    unsigned int base_socket::accept_and_create_sockfd(const int flags) {
+        _raddr_len = sizeof(_raddr); //no is_listening check, accept fails with EINVAL on a socket that is not listening anyway
+        auto s = accept4(static_cast<int>(_socket), //this bound and listening socket's file descriptor
                             reinterpret_cast<struct sockaddr*>(&_raddr), //filled in with the remote address of this peer socket
-                            &len_raddr);
+                            &_raddr_len,
+                            flags);
         if(s < 0) {
             throw std::runtime_error(last_error());
         }
         return static_cast<sockfd_t>(s); //the newly created socket using the connected file descriptor
     }
 
+    size_t base_socket::accept_batch(std::vector<unsigned int>& sockfds, const size_t max_sockets, const int flags) {
+        sockfds.clear();
+        auto listener = static_cast<int>(_socket);
+        auto batch = max_sockets > 1 && (fcntl(listener, F_GETFL, 0) & O_NONBLOCK); //a blocking accept would wait for the next connection
+        while(sockfds.size() < max_sockets) {
+            auto s = accept4(listener, nullptr, nullptr, flags);
+            if(s < 0) {
+                if(errno == ECONNABORTED || errno == EINTR) { //reset while queued, the next one may be fine
+                    continue;
+                }
+                if(errno == EAGAIN || errno == EWOULDBLOCK || !sockfds.empty()) { //the queue is empty, or keep what was accepted and fail next time
+                    break;
+                }
+                throw std::runtime_error(last_error());
+            }
+            sockfds.push_back(static_cast<unsigned int>(s));
+            if(!batch) {
+                break;
+            }
+        }
+        return sockfds.size();
+    }
+
     void base_socket::be_listening() {
+        be_listening(MAX_BACKLOG);
+    }
+
+    void base_socket::be_listening(const int backlog) {
         //marks the socket referred to by _socket as a passive socket, that is,
         //as a socket that will be used to accept incoming connection requests using accept
-        if(listen(static_cast<int>(_socket), MAX_BACKLOG) < 0) {
-        //MAX_BACKLOG defines the maximum length to which the queue of pending connections for _socket may grow
+        if(listen(static_cast<int>(_socket), backlog) < 0) {
+        //backlog defines the maximum length to which the queue of pending connections for _socket may grow
             throw std::runtime_error(last_error());
         }
     }
@@ -151,6 +403,7 @@ namespace net {
     }
 
     std::string base_socket::read(const int flags) const {
+        _spin_readable(flags);
         return _read(_socket, flags);
     }
 
@@ -158,12 +411,45 @@ namespace net {
         return _write(_socket, buffer, flags);
     }
 
+    long base_socket::gather_write(const std::vector<std::string_view>& buffers, const int flags) const {
+        std::array<iovec, IOV_MAX> iov;
+        auto count = std::min(buffers.size(), iov.size());
+        for(size_t i = 0; i < count; ++i) {
+            iov[i].iov_base = const_cast<char*>(buffers[i].data()); //sendmsg does not write through iov_base
+            iov[i].iov_len = buffers[i].size();
+        }
+        msghdr msg{};
+        msg.msg_iov = iov.data();
+        msg.msg_iovlen = count;
+        auto i = sendmsg(static_cast<int>(_socket), &msg, flags);
+        if(i < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) { //non blocking and the send buffer is full
+            return 0;
+        }
+        if(i < 0) { //return the number of bytes sent, or -1 if an error occurred.
+            throw std::runtime_error(last_error());
+        }
+        return i;
+    }
+
+    long base_socket::read_some(char* buffer, const size_t size, const int flags) const {
+        _spin_readable(flags);
+        auto i = recv(static_cast<int>(_socket), buffer, size, flags);
+        if(i < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) { //non blocking and nothing has arrived
+            return -1;
+        }
+        if(i < 0) {
+            throw std::runtime_error(last_error());
+        }
+        return i;
+    }
+
     std::string base_socket::read_from(const int flags) {
-        return _read_from(_socket, _raddr, flags);
+        _spin_readable(flags);
+        return _read_from(_socket, _raddr, _raddr_len, flags);
     }
 
     long base_socket::write_back(const std::string& buffer, const int flags) {
-        return _write_back(_socket, buffer, _raddr, flags);
+        return _write_back(_socket, buffer, _raddr, _raddr_len, flags);
     }
 
     void base_socket::reset() {
@@ -190,6 +476,384 @@ namespace net {
         }
     }
 
+    bool base_socket::is_alive() const {
+        char c;
+        auto i = recv(static_cast<int>(_socket), &c, 1, MSG_PEEK | MSG_DONTWAIT); //look without consuming or blocking
+        if(i < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK; //nothing to read and no pending error - open and idle
+        }
+        return false; //0 the peer has sent FIN, >0 stale data is waiting
+    }
+
+    void base_socket::keep_alive(const bool enable) {
+        int optval = enable ? 1 : 0;
+        if (setsockopt(static_cast<int>(_socket),
+                       SOL_SOCKET, //manipulates options at the sockets API level
+                       SO_KEEPALIVE, //periodically probe an idle connection
+                       &optval, sizeof(optval)) == -1) {
+            throw std::runtime_error(last_error());
+        }
+    }
+
+    size_t base_socket::read_batch(std::vector<std::string>& messages, const size_t max_messages, const size_t max_size, const int flags) {
+        std::array<mmsghdr, MAX_BATCH> headers;
+        std::array<iovec, MAX_BATCH> iov;
+        auto count = std::min(max_messages, MAX_BATCH);
+        messages.resize(count);
+        for(size_t i = 0; i < count; ++i) {
+            messages[i].resize(max_size);
+            iov[i].iov_base = &messages[i][0];
+            iov[i].iov_len = max_size;
+            headers[i] = mmsghdr{};
+            headers[i].msg_hdr.msg_iov = &iov[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+        }
+        //MSG_WAITFORONE - block (unless non blocking) for the first datagram only then take whatever else is queued
+        _spin_readable(flags);
+        auto n = recvmmsg(static_cast<int>(_socket), headers.data(), static_cast<unsigned int>(count), flags | MSG_WAITFORONE, nullptr);
+        if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) { //non blocking and nothing has arrived
+            n = 0;
+        } else if(n < 0) {
+            throw std::runtime_error(last_error());
+        }
+        messages.resize(static_cast<size_t>(n));
+        for(size_t i = 0; i < messages.size(); ++i) {
+            messages[i].resize(std::min(static_cast<size_t>(headers[i].msg_len), max_size)); //msg_len is the full length when MSG_TRUNC
+        }
+        return messages.size();
+    }
+
+    void base_socket::join_group(const std::string& group, const std::string& interface_addr) {
+        auto request = _group_request(group, interface_addr);
+        int all = 0; //only deliver the groups this socket joined, not every group joined on the host for the bound port
+        if (setsockopt(static_cast<int>(_socket), IPPROTO_IP, IP_MULTICAST_ALL, &all, sizeof(all)) == -1) {
+            throw std::runtime_error(last_error());
+        }
+        if (setsockopt(static_cast<int>(_socket), IPPROTO_IP, IP_ADD_MEMBERSHIP, &request, sizeof(request)) == -1) {
+            throw std::runtime_error(last_error());
+        }
+    }
+
+    void base_socket::leave_group(const std::string& group, const std::string& interface_addr) {
+        auto request = _group_request(group, interface_addr);
+        if (setsockopt(static_cast<int>(_socket), IPPROTO_IP, IP_DROP_MEMBERSHIP, &request, sizeof(request)) == -1) {
+            throw std::runtime_error(last_error());
+        }
+    }
+
+    void base_socket::multicast_ttl(const int ttl) {
+        if (setsockopt(static_cast<int>(_socket), IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) == -1) {
+            throw std::runtime_error(last_error());
+        }
+    }
+
+    void base_socket::multicast_loopback(const bool enable) {
+        int optval = enable ? 1 : 0;
+        if (setsockopt(static_cast<int>(_socket), IPPROTO_IP, IP_MULTICAST_LOOP, &optval, sizeof(optval)) == -1) {
+            throw std::runtime_error(last_error());
+        }
+    }
+
+    void base_socket::multicast_interface(const std::string& interface_addr) {
+        in_addr addr{};
+        if(inet_pton(AF_INET, interface_addr.c_str(), &addr) != 1) {
+            throw std::runtime_error(EMSG_INET_PTON);
+        }
+        if (setsockopt(static_cast<int>(_socket), IPPROTO_IP, IP_MULTICAST_IF, &addr, sizeof(addr)) == -1) {
+            throw std::runtime_error(last_error());
+        }
+    }
+
+    long base_socket::write_segmented(std::string_view buffer, const size_t segment_size, const int flags) const {
+        assert(segment_size > 0);
+        //each send is one train of at most MAX_GSO_SEGMENTS datagrams fitting in a single maximum size UDP payload
+        auto train = segment_size * std::max<size_t>(1, std::min(MAX_GSO_SEGMENTS, MAX_DATAGRAM_SIZE / segment_size));
+        std::array<char, CMSG_SPACE(sizeof(uint16_t))> control;
+        size_t sent = 0;
+        while(sent < buffer.size()) {
+            auto size = std::min(train, buffer.size() - sent);
+            iovec iov{const_cast<char*>(buffer.data() + sent), size}; //sendmsg does not write through iov_base
+            msghdr msg{};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            if(size > segment_size) { //a single datagram needs no segmentation
+                control.fill(0);
+                msg.msg_control = control.data();
+                msg.msg_controllen = control.size();
+                auto cmsg = CMSG_FIRSTHDR(&msg);
+                cmsg->cmsg_level = SOL_UDP;
+                cmsg->cmsg_type = UDP_SEGMENT;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                auto gso_size = static_cast<uint16_t>(segment_size);
+                memcpy(CMSG_DATA(cmsg), &gso_size, sizeof(gso_size));
+            }
+            auto i = sendmsg(static_cast<int>(_socket), &msg, flags);
+            if(i < 0) {
+                throw std::runtime_error(last_error());
+            }
+            sent += static_cast<size_t>(i);
+        }
+        return static_cast<long>(sent);
+    }
+
+    void base_socket::gro(const bool enable) {
+        int optval = enable ? 1 : 0;
+        if (setsockopt(static_cast<int>(_socket), SOL_UDP, UDP_GRO, &optval, sizeof(optval)) == -1) {
+            throw std::runtime_error(last_error());
+        }
+    }
+
+    size_t base_socket::read_segments(std::string& buffer, std::vector<std::string_view>& segments, const int flags) {
+        segments.clear();
+        if(buffer.size() < MAX_DATAGRAM_SIZE) {
+            buffer.resize(MAX_DATAGRAM_SIZE);
+        }
+        iovec iov{&buffer[0], buffer.size()};
+        std::array<char, CMSG_SPACE(sizeof(int))> control{};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+        _spin_readable(flags);
+        auto i = recvmsg(static_cast<int>(_socket), &msg, flags);
+        if(i < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) { //non blocking and nothing has arrived
+            return 0;
+        }
+        if(i < 0) {
+            throw std::runtime_error(last_error());
+        }
+        auto size = static_cast<size_t>(i);
+        auto segment_size = size;
+        for(auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if(cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) { //present only when datagrams were coalesced
+                int gso_size;
+                memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+                segment_size = static_cast<size_t>(gso_size);
+            }
+        }
+        std::string_view received(buffer.data(), size);
+        do { //a zero length datagram is still one datagram
+            segments.push_back(received.substr(0, segment_size));
+            received.remove_prefix(std::min(segment_size, received.size()));
+        } while(!received.empty());
+        return segments.size();
+    }
+
+    void base_socket::bind_local(const std::string& path) {
+        sockaddr_un addr;
+        auto len = _local_address(path, addr);
+        struct stat st;
+        if(!path.empty() && path.front() != ABSTRACT_PREFIX && lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+            //a socket left behind by an earlier run would fail the bind with EADDRINUSE, one nobody listens on any more is
+            //removed - a live server's socket, or anything that is not a socket, is left for bind to report
+            auto probe = socket(AF_UNIX, _socket_type | SOCK_CLOEXEC, 0);
+            if(probe >= 0) {
+                if(connect(probe, reinterpret_cast<struct sockaddr*>(&addr), len) < 0 && errno == ECONNREFUSED) {
+                    unlink(path.c_str());
+                }
+                close(probe);
+            }
+        }
+        if(bind(static_cast<int>(_socket), reinterpret_cast<struct sockaddr*>(&addr), len) < 0) {
+            throw std::runtime_error(last_error());
+        }
+    }
+
+    void base_socket::connect_local(const std::string& path) {
+        sockaddr_un addr;
+        auto len = _local_address(path, addr);
+        if(connect(static_cast<int>(_socket), reinterpret_cast<struct sockaddr*>(&addr), len) < 0) {
+            throw std::runtime_error(last_error());
+        }
+    }
+
+    long base_socket::write_fds(const std::string& buffer, const std::vector<int>& fds, const int flags) const {
+        if(buffer.empty()) {
+            throw std::runtime_error(EMSG_FDS_EMPTY);
+        }
+        if(fds.size() > MAX_PASSED_FDS) {
+            throw std::runtime_error(EMSG_FDS_TOO_MANY);
+        }
+        std::array<char, CMSG_SPACE(sizeof(int) * MAX_PASSED_FDS)> control;
+        iovec iov{const_cast<char*>(buffer.data()), buffer.size()};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        if(!fds.empty()) {
+            control.fill(0);
+            msg.msg_control = control.data();
+            msg.msg_controllen = CMSG_SPACE(sizeof(int) * fds.size());
+            auto cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+            memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+        }
+        auto i = sendmsg(static_cast<int>(_socket), &msg, flags);
+        if(i < 0) {
+            throw std::runtime_error(last_error());
+        }
+        return i;
+    }
+
+    std::string base_socket::read_fds(std::vector<int>& fds, const int flags) const {
+        std::array<char, DEFAULT_BUFFER_SIZE> buffer;
+        std::array<char, CMSG_SPACE(sizeof(int) * MAX_PASSED_FDS)> control;
+        iovec iov{buffer.data(), buffer.size()};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+        auto i = recvmsg(static_cast<int>(_socket), &msg, flags | MSG_CMSG_CLOEXEC);
+        if(i < 0) {
+            throw std::runtime_error(last_error());
+        }
+        fds.clear();
+        for(auto cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+                auto n = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                auto first = fds.size();
+                fds.resize(first + n);
+                memcpy(&fds[first], CMSG_DATA(cmsg), n * sizeof(int));
+            }
+        }
+        if(msg.msg_flags & MSG_CTRUNC) { //the kernel closed what did not fit, what did fit is of no use without the rest
+            for(auto fd: fds) {
+                ::close(fd);
+            }
+            fds.clear();
+            throw std::runtime_error(EMSG_FDS_TRUNCATED);
+        }
+        return std::string(buffer.data(), static_cast<size_t>(i));
+    }
+
+    bool base_socket::busy_poll(const std::chrono::microseconds spin_budget) {
+        _spin_budget = std::max(spin_budget, std::chrono::microseconds(0));
+        int usecs = static_cast<int>(std::min<long long>(_spin_budget.count(), INT_MAX));
+        int prefer = usecs > 0 ? 1 : 0;
+        auto kernel = setsockopt(static_cast<int>(_socket), SOL_SOCKET, SO_BUSY_POLL, &usecs, sizeof(usecs)) == 0;
+        setsockopt(static_cast<int>(_socket), SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer, sizeof(prefer)); //Linux 5.11, harmless if refused
+        return kernel && usecs > 0;
+    }
+
+    bool base_socket::timestamps(const timestamp_t mode) {
+        int flags = 0;
+        switch(mode) {
+        case timestamp_t::HARDWARE:
+            flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+            [[fallthrough]];
+        case timestamp_t::SOFTWARE:
+            flags |= SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+            break;
+        case timestamp_t::NONE:
+            break;
+        }
+        int nanoseconds = 0;
+        if(setsockopt(static_cast<int>(_socket), SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0) {
+            setsockopt(static_cast<int>(_socket), SOL_SOCKET, SO_TIMESTAMPNS, &nanoseconds, sizeof(nanoseconds)); //or both stamp the data
+            return true;
+        }
+        if(mode == timestamp_t::HARDWARE) {
+            return false;
+        }
+        nanoseconds = mode == timestamp_t::SOFTWARE ? 1 : 0; //kernels without SO_TIMESTAMPING still give software stamps
+        return setsockopt(static_cast<int>(_socket), SOL_SOCKET, SO_TIMESTAMPNS, &nanoseconds, sizeof(nanoseconds)) == 0;
+    }
+
+    std::string base_socket::read(rx_timestamp_t& stamp, const int flags) const {
+        _spin_readable(flags);
+        return _read_stamped(_socket, nullptr, nullptr, stamp, flags);
+    }
+
+    std::string base_socket::read_from(rx_timestamp_t& stamp, const int flags) {
+        _spin_readable(flags);
+        return _read_stamped(_socket, &_raddr, &_raddr_len, stamp, flags);
+    }
+
+    void base_socket::hand_over(const std::string& path) {
+        base_socket peer(AF_UNIX, SOCK_STREAM, 0);
+        peer.connect_local(path);
+        peer.write_fds("hand_over", {static_cast<int>(_socket)});
+        ::close(static_cast<int>(_socket)); //no shutdown, that would stop the socket for the receiver as well
+        _socket = static_cast<sockfd_t>(INVALID_SOCKET);
+    }
+
+    unsigned int base_socket::take_over(const std::string& path) {
+        base_socket listener(AF_UNIX, SOCK_STREAM, 0);
+        listener.bind_local(path);
+        listener.be_listening();
+        base_socket peer(listener.accept_and_create_sockfd());
+        std::vector<int> fds;
+        peer.read_fds(fds);
+        if(!path.empty() && path.front() != ABSTRACT_PREFIX) {
+            unlink(path.c_str());
+        }
+        if(fds.size() != 1) {
+            for(auto fd: fds) {
+                ::close(fd);
+            }
+            throw std::runtime_error(EMSG_HANDOVER);
+        }
+        return static_cast<unsigned int>(fds.front());
+    }
+
+    void base_socket::fast_open(const int queue_length) {
+        if(setsockopt(static_cast<int>(_socket), IPPROTO_TCP, TCP_FASTOPEN, &queue_length, sizeof(queue_length)) == -1) {
+            throw std::runtime_error(last_error());
+        }
+    }
+
+    void base_socket::defer_accept(const std::chrono::seconds timeout) {
+        int seconds = static_cast<int>(std::min<long long>(std::max<long long>(timeout.count(), 0), INT_MAX));
+        if(setsockopt(static_cast<int>(_socket), IPPROTO_TCP, TCP_DEFER_ACCEPT, &seconds, sizeof(seconds)) == -1) {
+            throw std::runtime_error(last_error());
+        }
+    }
+
+    long base_socket::connect_fast_open(const std::string& address, const unsigned short port, const std::string& buffer, const int flags) {
+        auto e = _assign_address(address, port);
+        if(e < 0) {
+            throw std::runtime_error(last_error());
+        }
+        if(e == 0) {
+            throw std::runtime_error(EMSG_INET_PTON);
+        }
+        if(buffer.empty()) {
+            connect_to(address, port);
+            return 0;
+        }
+        //connects and sends, the data goes in the SYN when a cookie is cached and otherwise after the handshake
+        auto i = sendto(static_cast<int>(_socket), buffer.data(), buffer.size(), flags | MSG_FASTOPEN,
+                        reinterpret_cast<struct sockaddr*>(&_addr), sizeof(_addr));
+        if(i < 0 && errno == EOPNOTSUPP) { //client side Fast Open is off
+            connect_to(address, port);
+            return _write(_socket, buffer, flags);
+        }
+        if(i < 0) {
+            throw std::runtime_error(last_error());
+        }
+        return i;
+    }
+
+    long base_socket::read_some_from(char* buffer, const size_t size, const int flags) {
+        _spin_readable(flags);
+        _raddr_len = sizeof(_raddr);
+        auto i = recvfrom(static_cast<int>(_socket), buffer, size, flags, reinterpret_cast<struct sockaddr*>(&_raddr), &_raddr_len);
+        if(i < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) { //non blocking and nothing has arrived
+            return -1;
+        }
+        if(i < 0) {
+            throw std::runtime_error(last_error());
+        }
+        return i;
+    }
+
+    unsigned int base_socket::sockfd() const {
+        return _socket;
+    }
+
     const std::string base_socket::last_error() {
         std::array<char, DEFAULT_BUFFER_SIZE> msg;
         if (strerror_r(errno, &msg.front(), msg.size()) == 0) { //The XSI-compliant version strerror
@@ -199,9 +863,16 @@ namespace net {
         }
     }
 
+    void base_socket::_close() {
+        if(_socket != static_cast<sockfd_t>(INVALID_SOCKET)) {
+            shutdown(static_cast<int>(_socket), SHUT_RDWR);
+            close(static_cast<int>(_socket));
+            _socket = static_cast<sockfd_t>(INVALID_SOCKET);
+        }
+    }
+
     base_socket::~base_socket() {
-        shutdown(static_cast<int>(_socket), SHUT_RDWR);
-        close(static_cast<int>(_socket));
+        _close();
     }
 
 }
@@ -0,0 +1,594 @@
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+
+#ifdef WIN32
+    #define poll WSAPoll
+    #define MSG_DONTWAIT 0
+#else
+    #include <poll.h>
+#endif
+
+#ifdef __linux__
+    #include <sys/prctl.h>
+#endif
+
+#include "socket_factory.h"
+
+/**
+ * @brief ep_loadgen - load generator driving many concurrent tcp_client_socket or udp_client_socket connections.
+ * @version 0.5
+ * Requests are echoed back by the server under test and a request completes once as many bytes as were sent have
+ * been read back. Every request has an *intended* start time taken from a fixed schedule, latency is measured from
+ * that intended start so queueing behind a stalled server is charged to the server (coordinated omission correction).
+ *
+ *  open loop   - requests are sent on schedule whether or not earlier requests completed (pipelined)
+ *  closed loop - a connection waits for its outstanding request before sending the next, with --rate the schedule
+ *                is still used for intended start times, without --rate requests go back to back and are uncorrected
+ *
+ *  usage: ep_loadgen [--host 127.0.0.1] [--port 5555] [--protocol tcp|udp] [--connections 100] [--threads n]
+ *                    [--rate requests_per_sec] [--mode open|closed] [--duration seconds]
+ *                    [--size fixed:N | uniform:MIN:MAX | exponential:MEAN] [--timeout ms] [--serve]
+ *
+ *  --timeout is how long a udp request waits for its reply before it is counted lost and, closed loop, the connection
+ *  moves on to its next request (default 1000ms).
+ *  --serve runs a local echo server instead, for trying the generator without a server under test.
+ *  @note thousands of connections need the open file limit raising (ulimit -n) on both ends.
+ */
+namespace loadgen {
+
+    using steady_t = std::chrono::steady_clock;
+
+    static const int MAX_UDP_PAYLOAD = net::DEFAULT_BUFFER_SIZE; //the udp products read at most DEFAULT_BUFFER_SIZE bytes
+    static const size_t UDP_ID_SIZE = sizeof(uint64_t);
+    static const auto DRAIN_TIMEOUT = std::chrono::seconds(2);
+
+    enum class mode_t {open, closed};
+
+    struct config_t {
+        std::string host = net::LOOPBACK_ADDR;
+        unsigned short port = net::DEFAULT_PORT;
+        bool udp = false;
+        size_t connections = 100;
+        size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        double rate = 0; //requests per second across all connections, 0 is as fast as possible
+        mode_t mode = mode_t::closed;
+        double duration = 10;
+        std::string size = "fixed:64";
+        std::chrono::milliseconds timeout{1000}; //a udp request with no reply after this is lost
+        bool serve = false;
+    };
+
+    /**
+     * @brief The size_distribution class draws payload sizes from a fixed, uniform or exponential distribution
+     */
+    class size_distribution {
+
+    public:
+
+        size_distribution(const std::string& spec, size_t min_size, size_t max_size, uint64_t seed):
+            _min(min_size), _max(max_size), _engine(seed) {
+            std::istringstream ss(spec);
+            std::string field;
+            std::vector<double> args;
+            std::getline(ss, _kind, ':');
+            while(std::getline(ss, field, ':')) {
+                args.push_back(std::stod(field));
+            }
+            if((_kind == "fixed" || _kind == "exponential") && args.size() == 1) {
+                _a = args[0];
+            } else if(_kind == "uniform" && args.size() == 2) {
+                _a = args[0];
+                _b = args[1];
+            } else {
+                throw std::invalid_argument("bad size distribution: " + spec);
+            }
+        }
+
+        size_t next() {
+            double size = _a;
+            if(_kind == "uniform") {
+                size = std::uniform_real_distribution<double>(_a, _b)(_engine);
+            } else if(_kind == "exponential") {
+                size = std::exponential_distribution<double>(1.0 / _a)(_engine);
+            }
+            return std::min(_max, std::max(_min, static_cast<size_t>(std::llround(size))));
+        }
+
+    private:
+
+        std::string _kind;
+        double _a = 0;
+        double _b = 0;
+        size_t _min;
+        size_t _max;
+        std::mt19937_64 _engine;
+
+    };
+
+    /**
+     * @brief The histogram class is a log linear latency histogram in nanoseconds, each power of two range is split into
+     * SUB_BUCKETS linear buckets which bounds the relative error of any reported percentile to 1/SUB_BUCKETS.
+     */
+    class histogram {
+
+        static const int SUB_BITS = 7;
+        static const uint64_t SUB_BUCKETS = 1 << SUB_BITS;
+        static const int MAGNITUDES = 64 - SUB_BITS + 1;
+
+    public:
+
+        histogram(): _counts(MAGNITUDES * SUB_BUCKETS, 0) {}
+
+        void record(uint64_t ns) {
+            ++_counts[_index(ns)];
+            ++_total;
+            _max = std::max(_max, ns);
+        }
+
+        void merge(const histogram& other) {
+            for(size_t i = 0; i < _counts.size(); ++i) {
+                _counts[i] += other._counts[i];
+            }
+            _total += other._total;
+            _max = std::max(_max, other._max);
+        }
+
+        uint64_t count() const {
+            return _total;
+        }
+
+        uint64_t max() const {
+            return _max;
+        }
+
+        /**
+         * @brief percentile - the upper bound of the bucket holding the p'th percentile
+         */
+        uint64_t percentile(double p) const {
+            auto rank = static_cast<uint64_t>(std::ceil(p / 100.0 * static_cast<double>(_total)));
+            uint64_t seen = 0;
+            for(size_t i = 0; i < _counts.size(); ++i) {
+                seen += _counts[i];
+                if(seen >= rank && seen > 0) {
+                    return std::min(_max, _upper(i));
+                }
+            }
+            return _max;
+        }
+
+    private:
+
+        static size_t _index(uint64_t v) {
+            if(v < SUB_BUCKETS) {
+                return static_cast<size_t>(v);
+            }
+            int magnitude = 63 - __builtin_clzll(v) - SUB_BITS + 1; //how far v must shift right to fit the sub buckets
+            return static_cast<size_t>(magnitude) * SUB_BUCKETS + static_cast<size_t>((v >> magnitude) & (SUB_BUCKETS - 1));
+        }
+
+        static uint64_t _upper(size_t i) {
+            auto magnitude = i / SUB_BUCKETS;
+            auto sub = i % SUB_BUCKETS;
+            return ((sub + 1) << magnitude) - 1;
+        }
+
+        std::vector<uint64_t> _counts;
+        uint64_t _total = 0;
+        uint64_t _max = 0;
+
+    };
+
+    struct request_t {
+        uint64_t id;
+        steady_t::time_point intended; //from the schedule
+        steady_t::time_point sent; //when the payload was handed to the socket
+        size_t remaining; //bytes still to be echoed back
+    };
+
+    struct connection_t {
+        std::unique_ptr<net::tcp_client_socket> tcp;
+        std::unique_ptr<net::udp_client_socket> udp;
+        std::string pending; //tcp bytes not yet accepted by the socket
+        std::deque<request_t> inflight;
+        steady_t::time_point next_due;
+        uint64_t next_id = 0;
+        bool failed = false;
+
+        unsigned int sockfd() const {
+            return tcp ? tcp->sockfd() : udp->sockfd();
+        }
+    };
+
+    struct results_t {
+        histogram corrected; //from intended start
+        histogram uncorrected; //from actual send
+        uint64_t sent = 0;
+        uint64_t completed = 0;
+        uint64_t lost = 0;
+        uint64_t errors = 0;
+        uint64_t bytes = 0;
+    };
+
+    uint64_t nanoseconds(steady_t::duration d) {
+        return static_cast<uint64_t>(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()));
+    }
+
+    void complete(results_t& results, const request_t& request, steady_t::time_point now) {
+        results.corrected.record(nanoseconds(now - request.intended));
+        results.uncorrected.record(nanoseconds(now - request.sent));
+        ++results.completed;
+    }
+
+    /**
+     * @brief on_writable - push as much of the pending tcp output as the socket will take without blocking
+     */
+    void on_writable(connection_t& c, results_t& results) {
+        thread_local std::vector<std::string_view> buffers(1);
+        buffers[0] = c.pending;
+        try {
+            auto n = c.tcp->gather_write(buffers, MSG_DONTWAIT); //0 when the send buffer is full, that waits for POLLOUT
+            c.pending.erase(0, static_cast<size_t>(n));
+        } catch (std::exception&) {
+            c.failed = true;
+            ++results.errors;
+        }
+    }
+
+    /**
+     * @brief send_request - queue one request on the connection, udp datagrams lead with the request id so replies can be matched
+     */
+    void send_request(connection_t& c, size_distribution& sizes, steady_t::time_point intended, results_t& results) {
+        auto size = sizes.next();
+        request_t request{c.next_id++, intended, steady_t::now(), size};
+        if(c.udp) {
+            std::string payload(size, 'u');
+            std::memcpy(&payload[0], &request.id, UDP_ID_SIZE);
+            try {
+                c.udp->write(payload);
+            } catch (std::exception&) { //e.g. ECONNREFUSED or ENOBUFS, the reply will never come
+                ++results.errors;
+                return;
+            }
+        } else {
+            c.pending.append(size, 't');
+        }
+        c.inflight.push_back(request);
+        results.bytes += size;
+        ++results.sent;
+        if(c.tcp) {
+            on_writable(c, results); //try to send straight away rather than waiting a poll round for POLLOUT
+        }
+    }
+
+    /**
+     * @brief on_readable - consume echoed bytes completing requests in order (tcp) or by id (udp)
+     */
+    void on_readable(connection_t& c, results_t& results) {
+        thread_local std::string reply(net::DEFAULT_BUFFER_SIZE, '\0');
+        long n;
+        try {
+            n = c.tcp ? c.tcp->read_some(&reply[0], reply.size(), MSG_DONTWAIT) : c.udp->read_some(&reply[0], reply.size(), MSG_DONTWAIT);
+        } catch (std::exception&) {
+            c.failed = true;
+            ++results.errors;
+            return;
+        }
+        if(n < 0) { //a spurious wake up is not a failure
+            return;
+        }
+        if(n == 0 && c.tcp) { //the server closed the connection
+            c.failed = true;
+            ++results.errors;
+            return;
+        }
+        auto now = steady_t::now();
+        if(c.udp) {
+            if(static_cast<size_t>(n) < UDP_ID_SIZE) {
+                return;
+            }
+            uint64_t id;
+            std::memcpy(&id, reply.data(), UDP_ID_SIZE);
+            auto it = std::find_if(c.inflight.begin(), c.inflight.end(), [id](const request_t& r){ return r.id == id; });
+            if(it != c.inflight.end()) {
+                complete(results, *it, now);
+                c.inflight.erase(it);
+            }
+            return;
+        }
+        auto received = static_cast<size_t>(n);
+        while(received > 0 && !c.inflight.empty()) {
+            auto& front = c.inflight.front();
+            auto n = std::min(received, front.remaining);
+            front.remaining -= n;
+            received -= n;
+            if(front.remaining == 0) {
+                complete(results, front, now);
+                c.inflight.pop_front();
+            }
+        }
+    }
+
+    /**
+     * @brief worker - drive a share of the connections from one thread with poll
+     */
+    void worker(const config_t& config, std::vector<connection_t>& connections, steady_t::time_point start, results_t& results, uint64_t seed) {
+        auto stop = start + std::chrono::duration_cast<steady_t::duration>(std::chrono::duration<double>(config.duration));
+        auto interval = config.rate > 0 ?
+                    std::chrono::duration_cast<steady_t::duration>(std::chrono::duration<double>(static_cast<double>(config.connections) / config.rate)) :
+                    steady_t::duration::zero();
+        size_distribution sizes(config.size, config.udp ? UDP_ID_SIZE : 1, config.udp ? MAX_UDP_PAYLOAD : SIZE_MAX, seed);
+#ifdef __linux__
+        prctl(PR_SET_TIMERSLACK, 1UL); //the default 50us timer slack would otherwise be charged to every scheduled request
+#endif
+        std::vector<pollfd> fds(connections.size());
+        for(size_t i = 0; i < connections.size(); ++i) {
+            fds[i].fd = static_cast<int>(connections[i].sockfd());
+        }
+        for(;;) {
+            auto now = steady_t::now();
+            auto sending = now < stop;
+            auto next_wake = sending ? stop : now + DRAIN_TIMEOUT;
+            bool busy = false;
+            for(size_t i = 0; i < connections.size(); ++i) {
+                auto& c = connections[i];
+                if(c.failed) {
+                    fds[i].fd = -1; //poll reports POLLHUP and POLLERR whatever the events, so leave the socket out
+                    continue;
+                }
+                if(c.udp) { //datagrams are lost for good, oldest first as they were sent in order
+                    while(!c.inflight.empty() && c.inflight.front().sent + config.timeout <= now) {
+                        c.inflight.pop_front();
+                        ++results.lost;
+                    }
+                    if(!c.inflight.empty()) {
+                        next_wake = std::min(next_wake, c.inflight.front().sent + config.timeout);
+                    }
+                }
+                if(sending) {
+                    if(config.mode == mode_t::open) {
+                        while(c.next_due <= now) { //catch up on every request the schedule says is due
+                            send_request(c, sizes, c.next_due, results);
+                            c.next_due += interval;
+                        }
+                    } else if(c.inflight.empty() && c.next_due <= now) {
+                        send_request(c, sizes, interval > steady_t::duration::zero() ? c.next_due : now, results);
+                        c.next_due = interval > steady_t::duration::zero() ? c.next_due + interval : now;
+                    }
+                    if(config.mode == mode_t::open || c.inflight.empty()) {
+                        next_wake = std::min(next_wake, c.next_due);
+                    }
+                }
+                fds[i].events = static_cast<short>(POLLIN | (c.pending.empty() ? 0 : POLLOUT));
+                busy = busy || !c.inflight.empty();
+            }
+            if(!sending && (!busy || now >= stop + DRAIN_TIMEOUT)) {
+                break;
+            }
+            auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(std::max(next_wake - steady_t::now(), steady_t::duration::zero()));
+#ifdef __linux__
+            timespec ts{static_cast<time_t>(wait.count() / 1000000000), static_cast<long>(wait.count() % 1000000000)};
+            auto ready = ppoll(fds.data(), fds.size(), &ts, nullptr);
+#else
+            auto ready = poll(fds.data(), static_cast<unsigned long>(fds.size()), static_cast<int>((wait.count() + 999999) / 1000000));
+#endif
+            if(ready <= 0) {
+                continue;
+            }
+            for(size_t i = 0; i < connections.size(); ++i) {
+                if(connections[i].failed) {
+                    continue;
+                }
+                if(fds[i].revents & (POLLIN | POLLERR | POLLHUP)) {
+                    on_readable(connections[i], results);
+                }
+                if((fds[i].revents & POLLOUT) && !connections[i].failed) {
+                    on_writable(connections[i], results);
+                }
+            }
+        }
+        for(auto& c: connections) {
+            results.lost += c.inflight.size();
+        }
+    }
+
+    std::string number(double d) {
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(3) << d;
+        return ss.str();
+    }
+
+    std::string percentiles(const histogram& h) {
+        std::ostringstream ss;
+        ss << "{\"p50_us\": " << number(h.percentile(50) / 1e3)
+           << ", \"p90_us\": " << number(h.percentile(90) / 1e3)
+           << ", \"p99_us\": " << number(h.percentile(99) / 1e3)
+           << ", \"p999_us\": " << number(h.percentile(99.9) / 1e3)
+           << ", \"p9999_us\": " << number(h.percentile(99.99) / 1e3)
+           << ", \"max_us\": " << number(h.max() / 1e3) << "}";
+        return ss.str();
+    }
+
+    void report(const config_t& config, const results_t& r, double elapsed) {
+        std::cout << "{\"protocol\": \"" << (config.udp ? "udp" : "tcp") << "\""
+                  << ", \"mode\": \"" << (config.mode == mode_t::open ? "open" : "closed") << "\""
+                  << ", \"connections\": " << config.connections
+                  << ", \"target_rate\": " << number(config.rate)
+                  << ", \"seconds\": " << number(elapsed)
+                  << ", \"sent\": " << r.sent
+                  << ", \"completed\": " << r.completed
+                  << ", \"lost\": " << r.lost
+                  << ", \"errors\": " << r.errors
+                  << ", \"achieved_rate\": " << number(static_cast<double>(r.completed) / elapsed)
+                  << ", \"mib_per_sec\": " << number(static_cast<double>(r.bytes) / (1024.0 * 1024.0) / elapsed)
+                  << ", \"corrected\": " << percentiles(r.corrected)
+                  << ", \"uncorrected\": " << percentiles(r.uncorrected)
+                  << "}" << std::endl;
+    }
+
+    /**
+     * @brief run - connect everything up front, then run the workers and merge their results
+     */
+    void run(const config_t& config) {
+        auto threads = std::min(config.threads, config.connections);
+        std::vector<std::vector<connection_t>> shares(threads);
+        for(size_t i = 0; i < config.connections; ++i) {
+            connection_t c;
+            if(config.udp) {
+                c.udp = std::make_unique<net::udp_client_socket>(config.host, config.port);
+            } else {
+                c.tcp = std::make_unique<net::tcp_client_socket>(config.host, config.port);
+            }
+            shares[i % threads].push_back(std::move(c));
+        }
+        auto start = steady_t::now();
+        auto interval = config.rate > 0 ? std::chrono::duration<double>(static_cast<double>(config.connections) / config.rate) : std::chrono::duration<double>::zero();
+        for(size_t i = 0; i < config.connections; ++i) { //stagger the schedules so connections do not fire in lock step
+            shares[i % threads][i / threads].next_due = start + std::chrono::duration_cast<steady_t::duration>(interval * (static_cast<double>(i) / static_cast<double>(config.connections)));
+        }
+        std::vector<results_t> results(threads);
+        std::vector<std::thread> workers;
+        for(size_t t = 0; t < threads; ++t) {
+            workers.emplace_back(worker, std::cref(config), std::ref(shares[t]), start, std::ref(results[t]), t + 1);
+        }
+        for(auto& w: workers) {
+            w.join();
+        }
+        auto elapsed = std::chrono::duration<double>(steady_t::now() - start).count();
+        results_t total;
+        for(auto& r: results) {
+            total.corrected.merge(r.corrected);
+            total.uncorrected.merge(r.uncorrected);
+            total.sent += r.sent;
+            total.completed += r.completed;
+            total.lost += r.lost;
+            total.errors += r.errors;
+            total.bytes += r.bytes;
+        }
+        report(config, total, std::min(elapsed, config.duration));
+    }
+
+    /**
+     * @brief serve - single threaded poll echo server for trying the generator out locally
+     */
+    void serve(const config_t& config) {
+        if(config.udp) {
+            net::udp_server_socket server(config.host, config.port);
+            for(;;) {
+                server.write_back(server.read_from());
+            }
+        }
+        net::tcp_server_socket server(config.host, config.port);
+        std::vector<std::unique_ptr<net::tcp_active_socket>> clients;
+        std::vector<pollfd> fds;
+        for(;;) {
+            fds.assign(1, pollfd{static_cast<int>(server.sockfd()), POLLIN, 0});
+            for(auto& c: clients) {
+                fds.push_back(pollfd{static_cast<int>(c->sockfd()), POLLIN, 0});
+            }
+            if(poll(fds.data(), static_cast<unsigned long>(fds.size()), -1) <= 0) {
+                continue;
+            }
+            for(size_t i = fds.size() - 1; i > 0; --i) {
+                if(fds[i].revents) {
+                    try {
+                        auto& c = *clients[i - 1];
+                        auto message = c.read();
+                        for(size_t sent = 0; sent < message.size(); ) {
+                            sent += static_cast<size_t>(c.write(message.substr(sent)));
+                        }
+                    } catch (std::exception&) { //peer closed
+                        clients.erase(clients.begin() + static_cast<long>(i - 1));
+                    }
+                }
+            }
+            if(fds[0].revents & POLLIN) {
+                clients.push_back(std::make_unique<net::tcp_active_socket>(server.accept_and_create_socket()));
+            }
+        }
+    }
+
+    config_t parse(int argc, char* argv[]) {
+        config_t config;
+        for(int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if(i + 1 >= argc) {
+                    throw std::invalid_argument("missing value for " + arg);
+                }
+                return argv[++i];
+            };
+            if(arg == "--host") {
+                config.host = value();
+            } else if(arg == "--port") {
+                config.port = static_cast<unsigned short>(std::stoi(value()));
+            } else if(arg == "--protocol") {
+                config.udp = value() == "udp";
+            } else if(arg == "--connections") {
+                config.connections = std::stoul(value());
+            } else if(arg == "--threads") {
+                config.threads = std::stoul(value());
+            } else if(arg == "--rate") {
+                config.rate = std::stod(value());
+            } else if(arg == "--mode") {
+                config.mode = value() == "open" ? mode_t::open : mode_t::closed;
+            } else if(arg == "--duration") {
+                config.duration = std::stod(value());
+            } else if(arg == "--size") {
+                config.size = value();
+            } else if(arg == "--timeout") {
+                config.timeout = std::chrono::milliseconds(std::stol(value()));
+            } else if(arg == "--serve") {
+                config.serve = true;
+            } else {
+                throw std::invalid_argument("unknown option " + arg);
+            }
+        }
+        if(config.mode == mode_t::open && config.rate <= 0) {
+            throw std::invalid_argument("open loop needs a --rate");
+        }
+        if(config.connections == 0 || config.threads == 0) {
+            throw std::invalid_argument("need at least one connection and one thread");
+        }
+        return config;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+
+#ifdef WIN32
+    net::startup();
+#endif
+
+    try {
+        auto config = loadgen::parse(argc, argv);
+        if(config.serve) {
+            loadgen::serve(config);
+        } else {
+            loadgen::run(config);
+        }
+    } catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+#ifdef WIN32
+    net::cleanup();
+#endif
+
+    return 0;
+
+}
@@ -0,0 +1,430 @@
+#ifndef MESSAGE_CODEC_H
+#define MESSAGE_CODEC_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "buffered_reader.h"
+#include "socket_errors.h"
+
+namespace net {
+
+    /**
+     * @brief codec - how a type T is laid out in a typed message payload, specialize it to send a type of your own:
+     *     static constexpr bool flat;  //true when the encoding is the object's own sizeof(T) bytes
+     *     static size_t size(const T& value);  //encoded bytes
+     *     static char* encode(const T& value, char* out);  //write size(value) bytes, return the end
+     *     static const char* decode(T& value, const char* in, const char* end);  //read from [in, end), return what is left
+     * The encodings below are flat and fixed layout in host byte order (both ends must share the architecture and the
+     * struct definitions, as with shm_channel):
+     * trivially copyable types (numbers, enums, plain structs, std::array of them) - their bytes, copied once at most;
+     * std::string and std::vector - a uint32_t element count, then the elements;
+     * other aggregates (e.g. structs with string members) - their fields in declaration order, each with its own codec,
+     * found at compile time from the aggregate's structured bindings (no base classes, up to MAX_CODEC_FIELDS fields).
+     */
+    template<typename T, typename = void>
+    struct codec;
+
+    namespace codec_detail {
+
+        static const size_t MAX_CODEC_FIELDS = 16;
+
+        //converts to anything, so T{any_field x N} compiles exactly when T is an aggregate of N (or more) fields
+        struct any_field {
+            template<typename U>
+            operator U() const;
+        };
+
+        template<typename T, typename... A>
+        constexpr auto brace_constructible(int) -> decltype(T{std::declval<A>()...}, true) {
+            return true;
+        }
+
+        template<typename T, typename... A>
+        constexpr bool brace_constructible(...) {
+            return false;
+        }
+
+        template<typename T, typename... A>
+        constexpr size_t field_count() {
+            if constexpr (sizeof...(A) > MAX_CODEC_FIELDS) {
+                return sizeof...(A);
+            } else if constexpr (brace_constructible<T, A..., any_field>(0)) {
+                return field_count<T, A..., any_field>();
+            } else {
+                return sizeof...(A);
+            }
+        }
+
+        /**
+         * @brief fields - a tuple of references to the aggregate's fields, in declaration order
+         */
+        template<typename T>
+        constexpr auto fields(T& value) {
+            constexpr auto n = field_count<std::remove_const_t<T>>();
+            static_assert(n > 0 && n <= MAX_CODEC_FIELDS, "codec: aggregate has no fields or more than MAX_CODEC_FIELDS");
+            if constexpr (n == 1) {
+                auto& [a] = value;
+                return std::tie(a);
+            } else if constexpr (n == 2) {
+                auto& [a, b] = value;
+                return std::tie(a, b);
+            } else if constexpr (n == 3) {
+                auto& [a, b, c] = value;
+                return std::tie(a, b, c);
+            } else if constexpr (n == 4) {
+                auto& [a, b, c, d] = value;
+                return std::tie(a, b, c, d);
+            } else if constexpr (n == 5) {
+                auto& [a, b, c, d, e] = value;
+                return std::tie(a, b, c, d, e);
+            } else if constexpr (n == 6) {
+                auto& [a, b, c, d, e, f] = value;
+                return std::tie(a, b, c, d, e, f);
+            } else if constexpr (n == 7) {
+                auto& [a, b, c, d, e, f, g] = value;
+                return std::tie(a, b, c, d, e, f, g);
+            } else if constexpr (n == 8) {
+                auto& [a, b, c, d, e, f, g, h] = value;
+                return std::tie(a, b, c, d, e, f, g, h);
+            } else if constexpr (n == 9) {
+                auto& [a, b, c, d, e, f, g, h, i] = value;
+                return std::tie(a, b, c, d, e, f, g, h, i);
+            } else if constexpr (n == 10) {
+                auto& [a, b, c, d, e, f, g, h, i, j] = value;
+                return std::tie(a, b, c, d, e, f, g, h, i, j);
+            } else if constexpr (n == 11) {
+                auto& [a, b, c, d, e, f, g, h, i, j, k] = value;
+                return std::tie(a, b, c, d, e, f, g, h, i, j, k);
+            } else if constexpr (n == 12) {
+                auto& [a, b, c, d, e, f, g, h, i, j, k, l] = value;
+                return std::tie(a, b, c, d, e, f, g, h, i, j, k, l);
+            } else if constexpr (n == 13) {
+                auto& [a, b, c, d, e, f, g, h, i, j, k, l, m] = value;
+                return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m);
+            } else if constexpr (n == 14) {
+                auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, o] = value;
+                return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, o);
+            } else if constexpr (n == 15) {
+                auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, o, p] = value;
+                return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, o, p);
+            } else {
+                auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, o, p, q] = value;
+                return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, o, p, q);
+            }
+        }
+
+        inline void require(const char* in, const char* end, const size_t n) {
+            if(static_cast<size_t>(end - in) < n) {
+                throw std::runtime_error(EMSG_CODEC_SIZE);
+            }
+        }
+
+        //frame length word, network byte order like encode_frame's
+        static const size_t LENGTH_SIZE = sizeof(uint32_t);
+
+        inline void put_length(char* out, const size_t length) {
+            if(length > UINT32_MAX) {
+                throw std::runtime_error(EMSG_CODEC_LENGTH);
+            }
+            for(size_t i = LENGTH_SIZE; i-- > 0; ) {
+                out[LENGTH_SIZE - 1 - i] = static_cast<char>((length >> (8 * i)) & 0xFF);
+            }
+        }
+
+        inline size_t get_length(const char* in) {
+            size_t length = 0;
+            for(size_t i = 0; i < LENGTH_SIZE; ++i) {
+                length = (length << 8) | static_cast<unsigned char>(in[i]);
+            }
+            return length;
+        }
+
+        //per thread scratch the non flat messages are encoded into, grown as needed and never shrunk
+        inline char* scratch(const size_t size) {
+            thread_local std::unique_ptr<char[]> buffer;
+            thread_local size_t capacity = 0;
+            if(size > capacity) {
+                capacity = std::max(size, capacity * 2);
+                buffer.reset(new char[capacity]);
+            }
+            return buffer.get();
+        }
+
+        //send a whole frame: a short write (signal, send timeout, full buffer) resumes where it stopped, as the length and
+        //scratch buffers do not outlive the call. Nothing sent at all is reported as 0 so non blocking callers can retry
+        template<typename S>
+        long write_frame(S& socket, std::vector<std::string_view>& buffers, const int flags) {
+            size_t total = 0;
+            for(auto& buffer: buffers) {
+                total += buffer.size();
+            }
+            size_t sent = 0;
+            while(sent < total) {
+                auto n = static_cast<size_t>(std::max(socket.gather_write(buffers, flags), 0L));
+                if(n == 0 && sent == 0) {
+                    return 0;
+                }
+                sent += n;
+                size_t done = 0;
+                while(n > 0 && done < buffers.size()) {
+                    auto i = std::min(n, buffers[done].size());
+                    buffers[done].remove_prefix(i);
+                    n -= i;
+                    if(buffers[done].empty()) {
+                        ++done;
+                    }
+                }
+                buffers.erase(buffers.begin(), buffers.begin() + static_cast<long>(done));
+            }
+            return static_cast<long>(sent);
+        }
+
+    }
+
+    //------------trivially copyable codec------------
+    template<typename T>
+    struct codec<T, std::enable_if_t<std::is_trivially_copyable_v<T>>> {
+
+        static constexpr bool flat = true;
+
+        static constexpr size_t size(const T&) {
+            return sizeof(T);
+        }
+
+        static char* encode(const T& value, char* out) {
+            std::memcpy(out, &value, sizeof(T));
+            return out + sizeof(T);
+        }
+
+        static const char* decode(T& value, const char* in, const char* end) {
+            codec_detail::require(in, end, sizeof(T));
+            std::memcpy(&value, in, sizeof(T));
+            return in + sizeof(T);
+        }
+
+    };
+
+    //------------string codec------------
+    template<>
+    struct codec<std::string> {
+
+        static constexpr bool flat = false;
+
+        static size_t size(const std::string& value) {
+            return sizeof(uint32_t) + value.size();
+        }
+
+        static char* encode(const std::string& value, char* out) {
+            out = codec<uint32_t>::encode(static_cast<uint32_t>(value.size()), out);
+            std::memcpy(out, value.data(), value.size());
+            return out + value.size();
+        }
+
+        static const char* decode(std::string& value, const char* in, const char* end) {
+            uint32_t n;
+            in = codec<uint32_t>::decode(n, in, end);
+            codec_detail::require(in, end, n);
+            value.assign(in, n);
+            return in + n;
+        }
+
+    };
+
+    //------------vector codec------------
+    template<typename U>
+    struct codec<std::vector<U>> {
+
+        static constexpr bool flat = false;
+
+        static size_t size(const std::vector<U>& value) {
+            if constexpr (std::is_trivially_copyable_v<U>) {
+                return sizeof(uint32_t) + value.size() * sizeof(U);
+            } else {
+                size_t n = sizeof(uint32_t);
+                for(auto& element: value) {
+                    n += codec<U>::size(element);
+                }
+                return n;
+            }
+        }
+
+        static char* encode(const std::vector<U>& value, char* out) {
+            out = codec<uint32_t>::encode(static_cast<uint32_t>(value.size()), out);
+            if constexpr (std::is_trivially_copyable_v<U>) {
+                if(!value.empty()) {
+                    std::memcpy(out, value.data(), value.size() * sizeof(U));
+                }
+                return out + value.size() * sizeof(U);
+            } else {
+                for(auto& element: value) {
+                    out = codec<U>::encode(element, out);
+                }
+                return out;
+            }
+        }
+
+        static const char* decode(std::vector<U>& value, const char* in, const char* end) {
+            uint32_t n;
+            in = codec<uint32_t>::decode(n, in, end);
+            if constexpr (std::is_trivially_copyable_v<U>) {
+                codec_detail::require(in, end, static_cast<size_t>(n) * sizeof(U));
+                value.resize(n);
+                if(n > 0) {
+                    std::memcpy(value.data(), in, n * sizeof(U));
+                }
+                return in + n * sizeof(U);
+            } else {
+                value.clear();
+                value.reserve(std::min<size_t>(n, static_cast<size_t>(end - in))); //every element takes a byte at least
+                for(uint32_t i = 0; i < n; ++i) {
+                    value.emplace_back();
+                    in = codec<U>::decode(value.back(), in, end);
+                }
+                return in;
+            }
+        }
+
+    };
+
+    //------------aggregate codec------------
+    template<typename T>
+    struct codec<T, std::enable_if_t<!std::is_trivially_copyable_v<T> && std::is_aggregate_v<T> && !std::is_array_v<T>>> {
+
+        static constexpr bool flat = false;
+
+        static size_t size(const T& value) {
+            return std::apply([](auto&... field) {
+                return (size_t{0} + ... + codec<std::decay_t<decltype(field)>>::size(field));
+            }, codec_detail::fields(value));
+        }
+
+        static char* encode(const T& value, char* out) {
+            std::apply([&out](auto&... field) {
+                ((out = codec<std::decay_t<decltype(field)>>::encode(field, out)), ...);
+            }, codec_detail::fields(value));
+            return out;
+        }
+
+        static const char* decode(T& value, const char* in, const char* end) {
+            std::apply([&in, end](auto&... field) {
+                ((in = codec<std::decay_t<decltype(field)>>::decode(field, in, end)), ...);
+            }, codec_detail::fields(value));
+            return in;
+        }
+
+    };
+
+    /**
+     * @brief decode_message - a T from exactly the payload of one typed message
+     */
+    template<typename T>
+    T decode_message(std::string_view payload) {
+        T value{};
+        auto end = payload.data() + payload.size();
+        if(codec<T>::decode(value, payload.data(), end) != end) {
+            throw std::runtime_error(EMSG_CODEC_SIZE);
+        }
+        return value;
+    }
+
+    /**
+     * @brief send - write message as one typed message: a 4 byte payload length in network byte order, then the payload
+     * A flat message is sent from where it is, gathered with the length by one sendmsg, anything else is encoded into
+     * a per thread buffer reused from message to message, never into a std::string.
+     * The whole frame is always written: once any of it has gone, short writes are resumed until the rest has too.
+     * @tparam S - a stream multi_socket product with gather_write, e.g. tcp_client_socket or tcp_active_socket
+     * @param flags - as gather_write, MSG_DONTWAIT returns 0 when the send buffer had no room for any of the frame
+     * @return long - bytes written, the frame's length and payload, or 0
+     */
+    template<typename T, typename S>
+    long send(S& socket, const T& message, const int flags = 0) {
+        thread_local std::vector<std::string_view> buffers;
+        auto size = codec<T>::size(message);
+        buffers.clear();
+        if constexpr (codec<T>::flat) {
+            std::array<char, codec_detail::LENGTH_SIZE> length;
+            codec_detail::put_length(length.data(), size);
+            buffers.emplace_back(length.data(), length.size());
+            buffers.emplace_back(reinterpret_cast<const char*>(&message), size);
+            return codec_detail::write_frame(socket, buffers, flags);
+        } else {
+            auto frame = codec_detail::scratch(codec_detail::LENGTH_SIZE + size);
+            codec_detail::put_length(frame, size);
+            codec<T>::encode(message, frame + codec_detail::LENGTH_SIZE);
+            buffers.emplace_back(frame, codec_detail::LENGTH_SIZE + size);
+            return codec_detail::write_frame(socket, buffers, flags);
+        }
+    }
+
+    /**
+     * @brief receive - the next typed message, decoded straight out of the reader's buffer, blocking until it has arrived
+     * @note throws EMSG_READER_EOF at end of stream and EMSG_READER_OVERFLOW for a message over the reader's max_size
+     */
+    template<typename T, typename S>
+    T receive(buffered_reader<S>& reader) {
+        auto length = codec_detail::get_length(reader.read_exact(codec_detail::LENGTH_SIZE).data());
+        return decode_message<T>(reader.read_exact(length));
+    }
+
+    /**
+     * @brief try_receive - the next typed message if all of it is already buffered, for event loop use after fill(MSG_DONTWAIT)
+     */
+    template<typename T, typename S>
+    std::optional<T> try_receive(buffered_reader<S>& reader) {
+        auto data = reader.data();
+        if(data.size() < codec_detail::LENGTH_SIZE) {
+            return std::nullopt;
+        }
+        auto length = codec_detail::get_length(data.data());
+        if(codec_detail::LENGTH_SIZE + length > reader.max_size()) {
+            throw std::runtime_error(EMSG_READER_OVERFLOW);
+        }
+        if(data.size() - codec_detail::LENGTH_SIZE < length) {
+            return std::nullopt;
+        }
+        auto value = decode_message<T>(data.substr(codec_detail::LENGTH_SIZE, length));
+        reader.consume(codec_detail::LENGTH_SIZE + length);
+        return value;
+    }
+
+    /**
+     * @brief receive - the next typed message of a flat type, received by read_some straight into the returned object
+     * @tparam S - a stream multi_socket product with read_some, blocking
+     */
+    template<typename T, typename S, typename = std::enable_if_t<codec<T>::flat>>
+    T receive(S& socket) {
+        auto read_fully = [&socket](char* buffer, size_t size) {
+            while(size > 0) {
+                auto i = socket.read_some(buffer, size);
+                if(i <= 0) {
+                    throw std::runtime_error(EMSG_READER_EOF);
+                }
+                buffer += i;
+                size -= static_cast<size_t>(i);
+            }
+        };
+        std::array<char, codec_detail::LENGTH_SIZE> length;
+        read_fully(length.data(), length.size());
+        if(codec_detail::get_length(length.data()) != sizeof(T)) {
+            throw std::runtime_error(EMSG_CODEC_SIZE);
+        }
+        T value;
+        read_fully(reinterpret_cast<char*>(&value), sizeof(T));
+        return value;
+    }
+
+}
+
+#endif // MESSAGE_CODEC_H
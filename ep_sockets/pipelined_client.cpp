@@ -0,0 +1,166 @@
+#include "pipelined_client.h"
+
+namespace net {
+
+    namespace {
+
+        //big endian (network byte order) helpers, byte by byte so they are independent of host order and alignment
+        void put_be(std::string& out, uint64_t value, size_t bytes) {
+            for(size_t i = bytes; i-- > 0; ) {
+                out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+            }
+        }
+
+        uint64_t get_be(const char* in, size_t bytes) {
+            uint64_t value = 0;
+            for(size_t i = 0; i < bytes; ++i) {
+                value = (value << 8) | static_cast<unsigned char>(in[i]);
+            }
+            return value;
+        }
+
+    }
+
+    std::string encode_frame(uint64_t id, const std::string& payload) {
+        if(payload.size() > UINT32_MAX - sizeof(uint64_t)) {
+            throw std::runtime_error(EMSG_FRAME_LENGTH);
+        }
+        std::string frame;
+        frame.reserve(frame_decoder::HEADER_SIZE + payload.size());
+        put_be(frame, sizeof(uint64_t) + payload.size(), sizeof(uint32_t));
+        put_be(frame, id, sizeof(uint64_t));
+        frame.append(payload);
+        return frame;
+    }
+
+    //------------frame_decoder implementation------------
+    frame_decoder::frame_decoder(const size_t max_size): _max_size(max_size) {}
+
+    void frame_decoder::feed(const std::string& bytes) {
+        if(_offset > 0 && _offset >= _buffer.size() / 2) { //compact once at least half the buffer is consumed
+            _buffer.erase(0, _offset);
+            _offset = 0;
+        }
+        _buffer.append(bytes);
+    }
+
+    bool frame_decoder::next(frame_t& frame) {
+        if(_buffer.size() - _offset < HEADER_SIZE) {
+            return false;
+        }
+        auto length = get_be(&_buffer[_offset], sizeof(uint32_t));
+        if(length < sizeof(uint64_t)) {
+            throw std::runtime_error(EMSG_BAD_FRAME);
+        }
+        if(length - sizeof(uint64_t) > _max_size) {
+            throw std::runtime_error(EMSG_FRAME_MAX_SIZE);
+        }
+        if(_buffer.size() - _offset < sizeof(uint32_t) + length) {
+            return false;
+        }
+        frame.id = get_be(&_buffer[_offset + sizeof(uint32_t)], sizeof(uint64_t));
+        frame.payload.assign(_buffer, _offset + HEADER_SIZE, length - sizeof(uint64_t));
+        _offset += sizeof(uint32_t) + length;
+        return true;
+    }
+
+    //------------pipelined_client implementation------------
+    pipelined_client::pipelined_client(const std::string addr, const unsigned short port):
+        _socket(addr, port) {
+        _reader = std::thread(&pipelined_client::_read_responses, this);
+    }
+
+    std::future<std::string> pipelined_client::request(const std::string& payload) {
+        auto promise = std::make_shared<std::promise<std::string>>();
+        auto future = promise->get_future();
+        _send(payload, [promise](std::exception_ptr error, const std::string& response) {
+            if(error) {
+                promise->set_exception(error);
+            } else {
+                promise->set_value(response);
+            }
+        });
+        return future;
+    }
+
+    void pipelined_client::request(const std::string& payload, handler_t handler) {
+        _send(payload, std::move(handler));
+    }
+
+    size_t pipelined_client::outstanding() const {
+        std::lock_guard<std::mutex> lock(_outstanding_mutex);
+        return _outstanding.size();
+    }
+
+    void pipelined_client::_send(const std::string& payload, handler_t handler) {
+        auto id = _next_id++;
+        auto frame = encode_frame(id, payload);
+        {
+            std::lock_guard<std::mutex> lock(_outstanding_mutex);
+            if(_failed) {
+                std::rethrow_exception(_failed);
+            }
+            _outstanding.emplace(id, std::move(handler)); //registered before sending so a fast response always finds it
+        }
+        try {
+            std::lock_guard<std::mutex> lock(_write_mutex);
+            for(size_t sent = 0; sent < frame.size(); ) {
+                sent += static_cast<size_t>(_socket.write(sent ? frame.substr(sent) : frame));
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(_outstanding_mutex);
+            _outstanding.erase(id);
+            throw;
+        }
+    }
+
+    void pipelined_client::_read_responses() {
+        frame_decoder decoder;
+        frame_t frame;
+        try {
+            for(;;) {
+                decoder.feed(_socket.read());
+                while(decoder.next(frame)) {
+                    handler_t handler;
+                    {
+                        std::lock_guard<std::mutex> lock(_outstanding_mutex);
+                        auto it = _outstanding.find(frame.id);
+                        if(it == _outstanding.end()) {
+                            continue; //unsolicited or duplicate response
+                        }
+                        handler = std::move(it->second);
+                        _outstanding.erase(it);
+                    }
+                    try {
+                        handler(nullptr, frame.payload);
+                    } catch (...) {} //a throwing callback is its own failure, the connection and other requests carry on
+                }
+            }
+        } catch (...) { //peer closed, connection error, bad frame or shut down by the destructor
+            try {
+                _socket.stop(action_t::READ_AND_WRITE); //nothing more is read, so the peer should not go on sending
+            } catch (std::exception&) {} //already disconnected
+            _fail_outstanding(std::current_exception());
+        }
+    }
+
+    void pipelined_client::_fail_outstanding(std::exception_ptr error) {
+        std::unordered_map<uint64_t, handler_t> failed;
+        {
+            std::lock_guard<std::mutex> lock(_outstanding_mutex);
+            _failed = error;
+            failed.swap(_outstanding);
+        }
+        for(auto& entry: failed) {
+            entry.second(error, std::string{});
+        }
+    }
+
+    pipelined_client::~pipelined_client() {
+        try {
+            _socket.stop(action_t::READ_AND_WRITE); //wakes the reader blocked in read
+        } catch (std::exception&) {} //already disconnected
+        _reader.join();
+    }
+
+}
@@ -0,0 +1,139 @@
+#ifndef PIPELINED_CLIENT_H
+#define PIPELINED_CLIENT_H
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "socket_factory.h"
+
+namespace net {
+
+    /**
+     * @brief frame_t - one correlated message, the id ties a response to the request that caused it
+     */
+    struct frame_t {
+        uint64_t id;
+        std::string payload;
+    };
+
+    /**
+     * @brief encode_frame - wire format shared by the pipelined client and the servers it talks to:
+     * 4 byte length of everything after it, 8 byte correlation id, payload - both integers in network byte order.
+     * @param id - correlation id, a server echoes the request id back on its response
+     * @param payload - message body, throws when it and the id do not fit the 4 byte length
+     * @return string - the encoded frame
+     */
+    std::string encode_frame(uint64_t id, const std::string& payload);
+
+    /**
+     * @brief The frame_decoder class reassembles frames from whatever chunks the stream socket read returns.
+     */
+    class frame_decoder {
+
+    public:
+
+        static const size_t HEADER_SIZE = sizeof(uint32_t) + sizeof(uint64_t);
+
+        static const size_t DEFAULT_MAX_SIZE = 16 * 1024 * 1024;
+
+        /**
+         * @brief frame_decoder
+         * @param max_size - the longest payload accepted, a longer frame throws rather than being buffered
+         */
+        explicit frame_decoder(const size_t max_size = DEFAULT_MAX_SIZE);
+
+        /**
+         * @brief feed - append received bytes
+         */
+        void feed(const std::string& bytes);
+
+        /**
+         * @brief next - pop the next complete frame
+         * @return true and fills frame if one was complete
+         */
+        bool next(frame_t& frame);
+
+    private:
+
+        size_t _max_size;
+        std::string _buffer;
+        size_t _offset = 0; //start of the first undecoded byte, consumed bytes are compacted away lazily
+
+    };
+
+    /**
+     * @brief The pipelined_client class multiplexes many outstanding requests over one tcp_client_socket.
+     * @version 0.5
+     * Requests are framed with a correlation id and written straight away without waiting for earlier responses,
+     * a background reader thread matches responses to requests by id (so servers may answer out of order) and
+     * completes the request's future or callback. Throughput per connection is then bounded by bandwidth rather
+     * than one round trip per request.
+     * @note callbacks run on the reader thread and should not block, an exception one throws is discarded.
+     */
+    class pipelined_client {
+
+    public:
+
+        /**
+         * @brief handler_t - completion callback, error is set (and response empty) if the connection failed first
+         */
+        using handler_t = std::function<void(std::exception_ptr error, const std::string& response)>;
+
+        pipelined_client(const std::string addr, const unsigned short port);
+
+        pipelined_client(const pipelined_client&) = delete;
+
+        pipelined_client& operator= (const pipelined_client&) = delete;
+
+        /**
+         * @brief request - send a request and return a future for its response
+         * @param payload - request body
+         * @return future - the response, or the connection error
+         */
+        std::future<std::string> request(const std::string& payload);
+
+        /**
+         * @brief request - send a request and invoke handler on the reader thread when the response arrives
+         * @param payload - request body
+         * @param handler - completion callback
+         */
+        void request(const std::string& payload, handler_t handler);
+
+        /**
+         * @brief outstanding - requests sent but not yet answered
+         */
+        size_t outstanding() const;
+
+        /**
+         * @brief ~pipelined_client - shuts the connection down, failing anything still outstanding, and joins the reader
+         */
+        ~pipelined_client();
+
+    private:
+
+        void _send(const std::string& payload, handler_t handler);
+
+        void _read_responses();
+
+        void _fail_outstanding(std::exception_ptr error);
+
+        tcp_client_socket _socket;
+        std::atomic<uint64_t> _next_id{0};
+        mutable std::mutex _outstanding_mutex;
+        std::unordered_map<uint64_t, handler_t> _outstanding;
+        std::exception_ptr _failed; //set once the reader has stopped, later requests fail immediately
+        std::mutex _write_mutex; //frames must go out whole, not interleaved
+        std::thread _reader;
+
+    };
+
+}
+
+#endif // PIPELINED_CLIENT_H
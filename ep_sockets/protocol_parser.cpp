@@ -0,0 +1,385 @@
+#include "protocol_parser.h"
+
+#include <array>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #include <immintrin.h>
+    #define EP_SOCKETS_X86_KERNELS //compiled with target attributes, only run when the cpu supports them
+#endif
+
+namespace net {
+
+    namespace {
+
+        using find_eol_t = size_t (*)(const char* data, size_t size);
+        using split_t = size_t (*)(const char* data, size_t size, char delim, std::vector<std::string_view>& records);
+
+        struct kernels_t {
+            simd_t level;
+            find_eol_t find_eol;
+            split_t split;
+        };
+
+        //------------scalar kernels------------
+        size_t find_eol_scalar(const char* data, size_t size) {
+            for(size_t i = 0; i < size; ++i) {
+                if(data[i] == '\r' || data[i] == '\n') {
+                    return i;
+                }
+            }
+            return std::string_view::npos;
+        }
+
+        /**
+         * @brief split_tail - split records searching from offset from, the current record having begun at start
+         * @return offset of the incomplete tail
+         */
+        size_t split_tail(const char* data, size_t size, size_t start, size_t from, char delim, std::vector<std::string_view>& records) {
+            while(auto p = static_cast<const char*>(std::memchr(data + from, delim, size - from))) {
+                auto end = static_cast<size_t>(p - data);
+                records.emplace_back(data + start, end - start);
+                start = from = end + 1;
+            }
+            return start;
+        }
+
+        size_t split_scalar(const char* data, size_t size, char delim, std::vector<std::string_view>& records) {
+            return split_tail(data, size, 0, 0, delim, records);
+        }
+
+#ifdef EP_SOCKETS_X86_KERNELS
+        //------------SSE4.2 kernels------------
+        __attribute__((target("sse4.2")))
+        size_t find_eol_sse42(const char* data, size_t size) {
+            const auto set = _mm_setr_epi8('\r', '\n', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+            size_t i = 0;
+            for(; i + 16 <= size; i += 16) {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                auto at = _mm_cmpestri(set, 2, block, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+                if(at < 16) {
+                    return i + static_cast<size_t>(at);
+                }
+            }
+            auto rest = find_eol_scalar(data + i, size - i);
+            return rest == std::string_view::npos ? rest : i + rest;
+        }
+
+        __attribute__((target("sse4.2")))
+        size_t split_sse42(const char* data, size_t size, char delim, std::vector<std::string_view>& records) {
+            const auto pattern = _mm_set1_epi8(delim);
+            size_t start = 0;
+            size_t i = 0;
+            for(; i + 16 <= size; i += 16) {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern)));
+                while(mask) { //one bit per delimiter, many short records cost one compare per 16 bytes
+                    auto end = i + static_cast<size_t>(__builtin_ctz(mask));
+                    records.emplace_back(data + start, end - start);
+                    start = end + 1;
+                    mask &= mask - 1;
+                }
+            }
+            return split_tail(data, size, start, i, delim, records);
+        }
+
+        //------------AVX2 kernels------------
+        __attribute__((target("avx2")))
+        size_t find_eol_avx2(const char* data, size_t size) {
+            const auto cr = _mm256_set1_epi8('\r');
+            const auto lf = _mm256_set1_epi8('\n');
+            size_t i = 0;
+            for(; i + 32 <= size; i += 32) {
+                auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                auto mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block, cr),
+                                                                                       _mm256_cmpeq_epi8(block, lf))));
+                if(mask) {
+                    return i + static_cast<size_t>(__builtin_ctz(mask));
+                }
+            }
+            auto rest = find_eol_sse42(data + i, size - i);
+            return rest == std::string_view::npos ? rest : i + rest;
+        }
+
+        __attribute__((target("avx2")))
+        size_t split_avx2(const char* data, size_t size, char delim, std::vector<std::string_view>& records) {
+            const auto pattern = _mm256_set1_epi8(delim);
+            size_t start = 0;
+            size_t i = 0;
+            for(; i + 32 <= size; i += 32) {
+                auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                auto mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, pattern)));
+                while(mask) {
+                    auto end = i + static_cast<size_t>(__builtin_ctz(mask));
+                    records.emplace_back(data + start, end - start);
+                    start = end + 1;
+                    mask &= mask - 1;
+                }
+            }
+            return split_tail(data, size, start, i, delim, records);
+        }
+#endif
+
+        kernels_t select_kernels(simd_t wanted) {
+#ifdef EP_SOCKETS_X86_KERNELS
+            __builtin_cpu_init();
+            if(wanted >= simd_t::AVX2 && __builtin_cpu_supports("avx2")) {
+                return {simd_t::AVX2, find_eol_avx2, split_avx2};
+            }
+            if(wanted >= simd_t::SSE42 && __builtin_cpu_supports("sse4.2")) {
+                return {simd_t::SSE42, find_eol_sse42, split_sse42};
+            }
+#endif
+            (void)wanted;
+            return {simd_t::SCALAR, find_eol_scalar, split_scalar};
+        }
+
+        kernels_t kernels = select_kernels(simd_t::AVX2);
+
+        /**
+         * @brief to_number - parse a non negative decimal, at most 18 digits so it cannot overflow
+         * @return long long - or -1 when text is empty, too long or not all digits
+         */
+        long long to_number(std::string_view text) {
+            if(text.empty() || text.size() > 18) {
+                return -1;
+            }
+            long long n = 0;
+            for(auto c: text) {
+                if(c < '0' || c > '9') {
+                    return -1;
+                }
+                n = n * 10 + (c - '0');
+            }
+            return n;
+        }
+
+        char to_lower(char c) {
+            return c >= 'A' && c <= 'Z' ? static_cast<char>(c | 0x20) : c; //header names are ASCII tokens, no locale
+        }
+
+        bool iequals(std::string_view a, std::string_view b) {
+            if(a.size() != b.size()) {
+                return false;
+            }
+            for(size_t i = 0; i < a.size(); ++i) {
+                if(to_lower(a[i]) != to_lower(b[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        std::string_view trim(std::string_view text) {
+            while(!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+                text.remove_prefix(1);
+            }
+            while(!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+                text.remove_suffix(1);
+            }
+            return text;
+        }
+
+        /**
+         * @brief next_line - the line starting at pos, without its CRLF or LF
+         * @param pos - advanced past the line ending
+         * @return bool - false when the line ending has not arrived yet
+         */
+        bool next_line(std::string_view data, size_t& pos, std::string_view& line) {
+            auto at = kernels.find_eol(data.data() + pos, data.size() - pos);
+            if(at == std::string_view::npos) {
+                return false;
+            }
+            auto end = pos + at;
+            auto next = end + 1;
+            if(data[end] == '\r') {
+                if(next == data.size()) {
+                    return false;
+                }
+                if(data[next] != '\n') {
+                    throw std::runtime_error(EMSG_BAD_HTTP); //a lone CR is never a line ending
+                }
+                ++next;
+            }
+            line = data.substr(pos, end - pos);
+            pos = next;
+            return true;
+        }
+
+    }
+
+    simd_t simd_level() {
+        return kernels.level;
+    }
+
+    void force_simd(const simd_t level) {
+        kernels = select_kernels(level);
+    }
+
+    size_t find_eol(std::string_view data) {
+        return kernels.find_eol(data.data(), data.size());
+    }
+
+    size_t split_records(std::string_view data, std::vector<std::string_view>& records, const char delim) {
+        records.clear();
+        return kernels.split(data.data(), data.size(), delim, records);
+    }
+
+    //------------http_request_t implementation------------
+    std::optional<std::string_view> http_request_t::header(std::string_view name) const {
+        for(auto& h: headers) {
+            if(iequals(h.name, name)) {
+                return h.value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    size_t http_request_t::content_length() const {
+        long long length = -1;
+        for(auto& h: headers) { //every field, a second one that disagrees could smuggle a request past a proxy (RFC 9112 6.3)
+            if(!iequals(h.name, "Content-Length")) {
+                continue;
+            }
+            auto n = to_number(h.value); //a list such as "5, 5" is not all digits and fails here
+            if(n < 0 || (length >= 0 && n != length)) {
+                throw std::runtime_error(EMSG_BAD_HTTP);
+            }
+            length = n;
+        }
+        return length < 0 ? 0 : static_cast<size_t>(length);
+    }
+
+    bool http_request_t::keep_alive() const {
+        auto connection = header("Connection");
+        if(connection && iequals(*connection, "close")) {
+            return false;
+        }
+        if(connection && iequals(*connection, "keep-alive")) {
+            return true;
+        }
+        return minor_version >= 1;
+    }
+
+    //------------parsers implementation------------
+    size_t parse_http_request(std::string_view data, http_request_t& request) {
+        request.headers.clear();
+        size_t pos = 0;
+        std::string_view line;
+        while(true) { //RFC 9112 - ignore at least one empty line before the request line
+            if(!next_line(data, pos, line)) {
+                return 0;
+            }
+            if(!line.empty()) {
+                break;
+            }
+        }
+        //request line - method SP target SP HTTP/1.x
+        auto sp1 = line.find(' ');
+        auto sp2 = line.rfind(' ');
+        if(sp1 == 0 || sp1 == std::string_view::npos || sp2 == sp1 || sp2 + 9 != line.size() ||
+                line.compare(sp2 + 1, 7, "HTTP/1.") != 0 || line.back() < '0' || line.back() > '9') {
+            throw std::runtime_error(EMSG_BAD_HTTP);
+        }
+        request.method = line.substr(0, sp1);
+        request.target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+        request.minor_version = line.back() - '0';
+        if(request.target.empty() || request.target.find(' ') != std::string_view::npos) {
+            throw std::runtime_error(EMSG_BAD_HTTP);
+        }
+        //header fields - name ":" OWS value OWS, up to an empty line
+        while(true) {
+            if(!next_line(data, pos, line)) {
+                return 0;
+            }
+            if(line.empty()) {
+                return pos;
+            }
+            auto colon = line.find(':');
+            if(colon == 0 || colon == std::string_view::npos) {
+                throw std::runtime_error(EMSG_BAD_HTTP);
+            }
+            auto name = line.substr(0, colon);
+            if(name.find_first_of(" \t") != std::string_view::npos || request.headers.size() == MAX_HTTP_HEADERS) {
+                throw std::runtime_error(EMSG_BAD_HTTP); //no white space before the colon, RFC 9112 5.1
+            }
+            request.headers.push_back({name, trim(line.substr(colon + 1))});
+        }
+    }
+
+    size_t parse_resp(std::string_view data, std::vector<resp_token_t>& tokens) {
+        tokens.clear();
+        std::array<long long, MAX_RESP_DEPTH> pending; //elements still to come of each enclosing array
+        size_t depth = 0;
+        size_t pos = 0;
+        do {
+            if(pos == data.size()) {
+                return 0;
+            }
+            auto type = static_cast<resp_t>(data[pos]);
+            auto at = kernels.find_eol(data.data() + pos + 1, data.size() - pos - 1);
+            if(at == std::string_view::npos || pos + 1 + at + 1 >= data.size()) {
+                return 0;
+            }
+            auto end = pos + 1 + at;
+            if(data[end] != '\r' || data[end + 1] != '\n') {
+                throw std::runtime_error(EMSG_BAD_RESP);
+            }
+            auto line = data.substr(pos + 1, end - pos - 1);
+            pos = end + 2;
+            resp_token_t token{type, std::string_view(), 0};
+            switch(type) {
+            case resp_t::SIMPLE:
+            case resp_t::ERROR:
+                token.text = line;
+                break;
+            case resp_t::INTEGER:
+                if(!line.empty() && line.front() == '-') {
+                    token.number = to_number(line.substr(1));
+                    if(token.number < 0) {
+                        throw std::runtime_error(EMSG_BAD_RESP);
+                    }
+                    token.number = -token.number;
+                } else if((token.number = to_number(line)) < 0) {
+                    throw std::runtime_error(EMSG_BAD_RESP);
+                }
+                break;
+            case resp_t::BULK:
+            case resp_t::ARRAY:
+                token.number = line == "-1" ? -1 : to_number(line);
+                if(token.number < 0 && line != "-1") {
+                    throw std::runtime_error(EMSG_BAD_RESP);
+                }
+                if(type == resp_t::BULK && token.number >= 0) {
+                    auto size = static_cast<size_t>(token.number);
+                    if(data.size() - pos < size + 2) {
+                        return 0;
+                    }
+                    if(data[pos + size] != '\r' || data[pos + size + 1] != '\n') {
+                        throw std::runtime_error(EMSG_BAD_RESP);
+                    }
+                    token.text = data.substr(pos, size);
+                    pos += size + 2;
+                }
+                break;
+            default:
+                throw std::runtime_error(EMSG_BAD_RESP);
+            }
+            tokens.push_back(token);
+            if(depth > 0) {
+                --pending[depth - 1];
+            }
+            if(type == resp_t::ARRAY && token.number > 0) {
+                if(depth == MAX_RESP_DEPTH) {
+                    throw std::runtime_error(EMSG_BAD_RESP);
+                }
+                pending[depth++] = token.number;
+            }
+            while(depth > 0 && pending[depth - 1] == 0) { //close every array this value completed
+                --depth;
+            }
+        } while(depth > 0);
+        return pos;
+    }
+
+}
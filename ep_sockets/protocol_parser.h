@@ -0,0 +1,176 @@
+#ifndef PROTOCOL_PARSER_H
+#define PROTOCOL_PARSER_H
+
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "buffered_reader.h"
+#include "socket_errors.h"
+
+namespace net {
+
+    /**
+     * @brief simd_t - instruction set used by the parsing kernels, chosen once at start up from what the cpu supports
+     */
+    enum class simd_t {SCALAR, SSE42, AVX2};
+
+    /**
+     * @brief simd_level - the kernels in use
+     */
+    simd_t simd_level();
+
+    /**
+     * @brief force_simd - use a lower tier than detected, for benchmarking and checking the kernels against each other
+     * @note requesting a tier the cpu lacks selects the best supported one, not thread safe against concurrent parsing
+     */
+    void force_simd(const simd_t level);
+
+    /**
+     * @brief find_eol - offset of the first '\r' or '\n' in data
+     * @return size_t - or std::string_view::npos
+     */
+    size_t find_eol(std::string_view data);
+
+    /**
+     * @brief split_records - split complete delimiter terminated records off the front of a buffer
+     * @param data - received bytes, the last record may be incomplete
+     * @param records - cleared then given a view of every complete record, without its delimiter
+     * @param delim - record terminator, '\n' for newline delimited (JSON lines, logs...)
+     * @return size_t - bytes consumed, the incomplete tail starts here
+     */
+    size_t split_records(std::string_view data, std::vector<std::string_view>& records, const char delim = '\n');
+
+    /**
+     * @brief http_header_t - one header field, views into the parsed buffer
+     */
+    struct http_header_t {
+        std::string_view name;
+        std::string_view value; //optional white space trimmed
+    };
+
+    /**
+     * @brief http_request_t - a parsed HTTP/1.x request head, every view points into the parsed buffer
+     */
+    struct http_request_t {
+        std::string_view method;
+        std::string_view target;
+        int minor_version = 1; //HTTP/1.minor_version
+        std::vector<http_header_t> headers; //cleared, not shrunk, by each parse so steady state parsing does not allocate
+
+        /**
+         * @brief header - value of the first header field with this name, compared case insensitively
+         */
+        std::optional<std::string_view> header(std::string_view name) const;
+
+        /**
+         * @brief content_length - the Content-Length header as a number, 0 when absent
+         * @note throws EMSG_BAD_HTTP for a value that is not a single number or for several fields that disagree
+         */
+        size_t content_length() const;
+
+        /**
+         * @brief keep_alive - whether the connection persists after this request by HTTP/1.0 and 1.1 defaults and the Connection header
+         */
+        bool keep_alive() const;
+    };
+
+    /**
+     * @brief parse_http_request - parse an HTTP/1.x request head (request line and headers up to the empty line)
+     * Lines end with CRLF, a bare LF is tolerated as RFC 9112 allows.
+     * @throw runtime_error - EMSG_BAD_HTTP for a malformed head or more than MAX_HTTP_HEADERS fields
+     * @return size_t - length of the head, the body (if any) follows, or 0 when the head is not yet complete
+     */
+    size_t parse_http_request(std::string_view data, http_request_t& request);
+
+    static const size_t MAX_HTTP_HEADERS = 100;
+
+    /**
+     * @brief resp_t - RESP2 value types, by their leading byte
+     */
+    enum class resp_t : char {SIMPLE = '+', ERROR = '-', INTEGER = ':', BULK = '$', ARRAY = '*'};
+
+    /**
+     * @brief resp_token_t - one RESP value, arrays are followed by their elements (pre-order) so nesting needs no allocation
+     */
+    struct resp_token_t {
+        resp_t type;
+        std::string_view text; //SIMPLE, ERROR and BULK contents, a view into the parsed buffer
+        long long number; //INTEGER value, BULK and ARRAY length, -1 for null
+    };
+
+    /**
+     * @brief parse_resp - parse one complete RESP2 value, e.g. a command (array of bulk strings) or a reply
+     * @param tokens - cleared then filled with the value's tokens
+     * @throw runtime_error - EMSG_BAD_RESP for a malformed value or nesting deeper than MAX_RESP_DEPTH
+     * @return size_t - bytes the value occupies, or 0 when it is not yet complete
+     */
+    size_t parse_resp(std::string_view data, std::vector<resp_token_t>& tokens);
+
+    static const size_t MAX_RESP_DEPTH = 32;
+
+    template<typename S>
+    void _fill_or_throw(buffered_reader<S>& reader) {
+        if(reader.buffered() >= reader.max_size()) {
+            throw std::runtime_error(EMSG_READER_OVERFLOW);
+        }
+        if(reader.is_eof() || reader.fill() == 0) {
+            throw std::runtime_error(EMSG_READER_EOF);
+        }
+    }
+
+    /**
+     * @brief try_read_http_request - parse a request head already buffered in a reader and consume it, never receives
+     * @note the request's views stay valid until the reader's next fill
+     */
+    template<typename S>
+    bool try_read_http_request(buffered_reader<S>& reader, http_request_t& request) {
+        auto n = parse_http_request(reader.data(), request);
+        reader.consume(n);
+        return n > 0;
+    }
+
+    /**
+     * @brief read_http_request - receive until a whole request head is buffered, parse it and consume it
+     * @throw runtime_error - EMSG_READER_EOF when the connection closes first, EMSG_READER_OVERFLOW when the head outgrows the reader
+     */
+    template<typename S>
+    void read_http_request(buffered_reader<S>& reader, http_request_t& request) {
+        while(!try_read_http_request(reader, request)) {
+            _fill_or_throw(reader);
+        }
+    }
+
+    /**
+     * @brief try_read_resp - parse a RESP value already buffered in a reader and consume it, never receives
+     */
+    template<typename S>
+    bool try_read_resp(buffered_reader<S>& reader, std::vector<resp_token_t>& tokens) {
+        auto n = parse_resp(reader.data(), tokens);
+        reader.consume(n);
+        return n > 0;
+    }
+
+    /**
+     * @brief read_resp - receive until a whole RESP value is buffered, parse it and consume it
+     */
+    template<typename S>
+    void read_resp(buffered_reader<S>& reader, std::vector<resp_token_t>& tokens) {
+        while(!try_read_resp(reader, tokens)) {
+            _fill_or_throw(reader);
+        }
+    }
+
+    /**
+     * @brief try_read_records - split every complete record already buffered in a reader and consume them, never receives
+     */
+    template<typename S>
+    bool try_read_records(buffered_reader<S>& reader, std::vector<std::string_view>& records, const char delim = '\n') {
+        reader.consume(split_records(reader.data(), records, delim));
+        return !records.empty();
+    }
+
+}
+
+#endif // PROTOCOL_PARSER_H
@@ -0,0 +1,446 @@
+#include "reliable_udp.h"
+
+#ifdef __linux__
+
+#include <algorithm>
+
+namespace net {
+
+    namespace {
+
+        //wire format, integers in network byte order:
+        //datagram - mark (1), packet number (4), frames
+        //ACK frame - type (1), ack delay in microseconds (4), range count (1), ranges as high (4), low (4), highest first
+        //DATA frame - type (1), stream (2), message number on the stream (4), length (2), payload
+        static const char PACKET_MARK = static_cast<char>(0xE5);
+        static const char ACK_FRAME = 0x01;
+        static const char DATA_FRAME = 0x02;
+        static const size_t PACKET_HEADER_SIZE = 1 + sizeof(uint32_t);
+        static const size_t ACK_HEADER_SIZE = 1 + sizeof(uint32_t) + 1;
+        static const size_t ACK_RANGE_SIZE = 2 * sizeof(uint32_t);
+        static const size_t DATA_HEADER_SIZE = 1 + sizeof(uint16_t) + sizeof(uint32_t) + sizeof(uint16_t);
+        static const size_t MIN_DATAGRAM_SIZE = PACKET_HEADER_SIZE + ACK_HEADER_SIZE + ACK_RANGE_SIZE + DATA_HEADER_SIZE + 1; //an ack and a byte
+
+        static const uint32_t PACKET_THRESHOLD = 3; //initial reordering threshold (RFC 9002 kPacketThreshold)
+        static const std::chrono::milliseconds GRANULARITY{1}; //timer granularity (kGranularity)
+        static const unsigned int MAX_PROBE_BACKOFF = 16;
+        static const size_t PROBE_DATAGRAMS = 2;
+
+        char* put(char* out, uint64_t value, size_t bytes) {
+            for(size_t i = bytes; i-- > 0; ) {
+                *out++ = static_cast<char>((value >> (8 * i)) & 0xFF);
+            }
+            return out;
+        }
+
+        uint64_t get(const char* in, size_t bytes) {
+            uint64_t value = 0;
+            for(size_t i = 0; i < bytes; ++i) {
+                value = (value << 8) | static_cast<unsigned char>(in[i]);
+            }
+            return value;
+        }
+
+    }
+
+    //------------reliable_session implementation------------
+    reliable_session::reliable_session(const reliable_options_t& options):
+        _options(options), _reorder_threshold(PACKET_THRESHOLD),
+        _latest_rtt(options.initial_rtt), _smoothed_rtt(options.initial_rtt), _rtt_variation(options.initial_rtt / 2),
+        _min_rtt(options.initial_rtt), _window(options.initial_window * options.max_datagram),
+        _recovery_start(clock_t::time_point::min()), _tokens(static_cast<double>(_window)), _refilled(clock_t::now()) {
+        if(options.max_datagram < MIN_DATAGRAM_SIZE || options.max_datagram > MAX_DATAGRAM_SIZE || options.minimum_window == 0 ||
+           options.initial_window < options.minimum_window || options.initial_rtt.count() <= 0 || options.max_ack_delay.count() < 0 ||
+           !(options.pacing_gain > 0)) {
+            throw std::runtime_error(EMSG_RELIABLE_OPTIONS);
+        }
+        _stats.congestion_window = _window;
+        _stats.smoothed_rtt = std::chrono::duration_cast<std::chrono::microseconds>(_smoothed_rtt);
+        _stats.rtt_variation = std::chrono::duration_cast<std::chrono::microseconds>(_rtt_variation);
+    }
+
+    bool reliable_session::send(const uint16_t stream, std::string message) {
+        if(message.size() > max_message_size()) {
+            throw std::runtime_error(EMSG_RELIABLE_SIZE);
+        }
+        _queued_bytes += message.size();
+        _queue.push_back({stream, _streams[stream].next_send++, std::move(message)});
+        ++_stats.messages_sent;
+        return _queued_bytes <= _options.max_queued;
+    }
+
+    std::optional<reliable_message_t> reliable_session::receive() {
+        if(_delivered.empty()) {
+            return std::nullopt;
+        }
+        auto message = std::move(_delivered.front());
+        _delivered.pop_front();
+        return message;
+    }
+
+    void reliable_session::on_datagram(const char* data, const size_t size, const clock_t::time_point now) {
+        if(size < PACKET_HEADER_SIZE || size > _options.max_datagram || data[0] != PACKET_MARK) {
+            ++_stats.malformed;
+            return;
+        }
+        ++_stats.datagrams_received;
+        auto number = static_cast<uint32_t>(get(data + 1, sizeof(uint32_t)));
+        auto end = data + size;
+        auto eliciting = false;
+        for(auto p = data + PACKET_HEADER_SIZE; p < end; ) {
+            auto type = *p++;
+            if(type == ACK_FRAME && static_cast<size_t>(end - p) >= ACK_HEADER_SIZE - 1 &&
+               static_cast<size_t>(end - p) >= ACK_HEADER_SIZE - 1 + ACK_RANGE_SIZE * static_cast<unsigned char>(p[sizeof(uint32_t)])) {
+                auto length = ACK_HEADER_SIZE - 1 + ACK_RANGE_SIZE * static_cast<unsigned char>(p[sizeof(uint32_t)]);
+                _on_ack(p, p + length, now);
+                p += length;
+            } else if(type == DATA_FRAME && static_cast<size_t>(end - p) >= DATA_HEADER_SIZE - 1 &&
+                      static_cast<size_t>(end - p) >= DATA_HEADER_SIZE - 1 + get(p + sizeof(uint16_t) + sizeof(uint32_t), sizeof(uint16_t))) {
+                auto stream = static_cast<uint16_t>(get(p, sizeof(uint16_t)));
+                auto sequence = static_cast<uint32_t>(get(p + sizeof(uint16_t), sizeof(uint32_t)));
+                auto length = static_cast<size_t>(get(p + sizeof(uint16_t) + sizeof(uint32_t), sizeof(uint16_t)));
+                p += DATA_HEADER_SIZE - 1;
+                _on_message({stream, sequence, std::string(p, length)});
+                p += length;
+                eliciting = true;
+            } else { //truncated or unknown, what was read so far stands
+                ++_stats.malformed;
+                break;
+            }
+        }
+        auto in_order = _received.empty() ? number == 0 : number == _received.front().second + 1;
+        if(_received.empty() || number > _received.front().second) {
+            _largest_received_time = now;
+        }
+        _record_received(number);
+        if(eliciting) {
+            ++_unacked_eliciting;
+            if(_unacked_eliciting >= 2 || !in_order) { //a gap or a late packet is acked at once so the sender learns of losses sooner
+                _ack_now = true;
+            } else if(_ack_deadline == clock_t::time_point::max()) {
+                _ack_deadline = now + _options.max_ack_delay;
+            }
+        }
+    }
+
+    size_t reliable_session::next_datagram(char* buffer, const clock_t::time_point now) {
+        _refill(now);
+        auto data = !_retransmit.empty() || !_queue.empty();
+        auto may_send = _probes > 0 || (data && _stats.bytes_in_flight + _options.max_datagram <= _window && _tokens > 0);
+        auto ack = _unacked_eliciting > 0 && (_ack_now || now >= _ack_deadline || may_send); //acks ride along with data
+        if(!may_send && !ack) {
+            return 0;
+        }
+        auto p = buffer;
+        auto end = buffer + _options.max_datagram;
+        *p++ = PACKET_MARK;
+        p = put(p, _next_number, sizeof(uint32_t));
+        if(ack) {
+            auto delay = std::chrono::duration_cast<std::chrono::microseconds>(now - _largest_received_time).count();
+            auto ranges = std::min({_received.size(), MAX_ACK_RANGES, (static_cast<size_t>(end - p) - ACK_HEADER_SIZE) / ACK_RANGE_SIZE});
+            *p++ = ACK_FRAME;
+            p = put(p, static_cast<uint64_t>(std::max<long long>(delay, 0)), sizeof(uint32_t));
+            *p++ = static_cast<char>(ranges);
+            for(size_t i = 0; i < ranges; ++i) {
+                p = put(p, _received[i].second, sizeof(uint32_t));
+                p = put(p, _received[i].first, sizeof(uint32_t));
+            }
+            _unacked_eliciting = 0;
+            _ack_now = false;
+            _ack_deadline = clock_t::time_point::max();
+        }
+        sent_packet_t packet{_next_number, now, 0, false, false, {}};
+        if(may_send) {
+            auto write = [&p](const pending_t& message) {
+                *p++ = DATA_FRAME;
+                p = put(p, message.stream, sizeof(uint16_t));
+                p = put(p, message.sequence, sizeof(uint32_t));
+                p = put(p, message.payload.size(), sizeof(uint16_t));
+                p = std::copy(message.payload.begin(), message.payload.end(), p);
+            };
+            for(auto queue: {&_retransmit, &_queue}) {
+                while(!queue->empty() && static_cast<size_t>(end - p) >= DATA_HEADER_SIZE + queue->front().payload.size()) {
+                    write(queue->front());
+                    _queued_bytes -= queue->front().payload.size();
+                    packet.messages.push_back(std::move(queue->front()));
+                    queue->pop_front();
+                }
+            }
+            if(packet.messages.empty() && _probes > 0) { //nothing new to probe with, send the oldest unacked messages again
+                auto oldest = std::find_if(_sent.begin(), _sent.end(), [](const sent_packet_t& s) { return s.in_flight; });
+                if(oldest != _sent.end()) {
+                    for(auto& message: oldest->messages) {
+                        if(static_cast<size_t>(end - p) < DATA_HEADER_SIZE + message.payload.size()) {
+                            break;
+                        }
+                        write(message);
+                        packet.messages.push_back(message);
+                        ++_stats.retransmissions;
+                    }
+                }
+            }
+            if(packet.messages.empty()) {
+                if(_retransmit.empty() && _queue.empty() &&
+                   std::none_of(_sent.begin(), _sent.end(), [](const sent_packet_t& s) { return s.in_flight; })) {
+                    _probes = 0; //nothing to probe with, an ack only leaves them owed to the next datagram
+                }
+            } else {
+                packet.in_flight = true;
+                packet.size = static_cast<size_t>(p - buffer);
+                _stats.bytes_in_flight += packet.size;
+                _tokens -= static_cast<double>(packet.size);
+                _last_ack_eliciting = now;
+                if(_probes > 0) {
+                    --_probes;
+                }
+            }
+        }
+        if(!ack && !packet.in_flight) {
+            return 0;
+        }
+        ++_next_number;
+        ++_stats.datagrams_sent;
+        _sent.push_back(std::move(packet));
+        _trim_sent();
+        return static_cast<size_t>(p - buffer);
+    }
+
+    void reliable_session::on_timeout(const clock_t::time_point now) {
+        if(_loss_time <= now) {
+            _detect_losses(now);
+        } else if(_stats.bytes_in_flight > 0 && _last_ack_eliciting + _probe_timeout() <= now) {
+            ++_probe_count;
+            _probes = PROBE_DATAGRAMS;
+        }
+    }
+
+    reliable_session::clock_t::time_point reliable_session::next_deadline() const {
+        auto deadline = clock_t::time_point::max();
+        if(_loss_time != clock_t::time_point::max()) {
+            deadline = _loss_time;
+        } else if(_stats.bytes_in_flight > 0) {
+            deadline = _last_ack_eliciting + _probe_timeout();
+        }
+        if(_unacked_eliciting > 0) {
+            deadline = std::min(deadline, _ack_now ? clock_t::time_point::min() : _ack_deadline);
+        }
+        if(_probes > 0) {
+            return clock_t::time_point::min();
+        }
+        if((!_retransmit.empty() || !_queue.empty()) && _stats.bytes_in_flight + _options.max_datagram <= _window) {
+            auto rate = _options.pacing_gain * static_cast<double>(_window) / std::chrono::duration<double>(_smoothed_rtt).count();
+            auto wait = std::chrono::duration<double>(std::max(-_tokens, 0.0) / rate);
+            deadline = std::min(deadline, _refilled + std::chrono::duration_cast<clock_t::duration>(wait) + std::chrono::microseconds(1));
+        }
+        return deadline;
+    }
+
+    bool reliable_session::idle() const {
+        return _queue.empty() && _retransmit.empty() && _stats.bytes_in_flight == 0;
+    }
+
+    const reliable_stats_t& reliable_session::stats() const {
+        return _stats;
+    }
+
+    size_t reliable_session::max_message_size() const {
+        return std::min<size_t>(_options.max_datagram - PACKET_HEADER_SIZE - DATA_HEADER_SIZE, UINT16_MAX);
+    }
+
+    void reliable_session::_on_ack(const char* data, const char* end, const clock_t::time_point now) {
+        auto ack_delay = std::chrono::microseconds(get(data, sizeof(uint32_t)));
+        auto ranges = data + ACK_HEADER_SIZE - 1;
+        if(ranges == end) {
+            return;
+        }
+        auto largest = static_cast<uint32_t>(get(ranges, sizeof(uint32_t)));
+        if(largest >= _next_number) { //acks a packet never sent
+            ++_stats.malformed;
+            return;
+        }
+        auto newly_acked = false;
+        for(auto p = ranges; p < end && !_sent.empty(); p += ACK_RANGE_SIZE) {
+            auto high = std::min<uint64_t>(get(p, sizeof(uint32_t)), _sent.back().number);
+            auto low = std::max<uint64_t>(get(p + sizeof(uint32_t), sizeof(uint32_t)), _sent.front().number);
+            for(auto number = low; number <= high; ++number) {
+                auto& packet = _sent[number - _sent.front().number];
+                if(packet.lost) { //only late, its messages went again regardless
+                    packet.lost = false;
+                    ++_stats.spurious_losses;
+                    _reorder_threshold = std::min(_reorder_threshold + 1, MAX_REORDER_THRESHOLD);
+                }
+                if(!packet.in_flight) {
+                    continue;
+                }
+                packet.in_flight = false;
+                packet.messages.clear();
+                _stats.bytes_in_flight -= packet.size;
+                newly_acked = true;
+                if(number == largest) {
+                    _on_rtt_sample(now - packet.time, ack_delay);
+                }
+                if(packet.time <= _recovery_start) { //sent before the last loss, the window stays as recovery set it
+                } else if(_window < _slow_start_threshold) {
+                    _window += packet.size;
+                } else {
+                    _window += _options.max_datagram * packet.size / _window;
+                }
+            }
+        }
+        _largest_acked = std::max<int64_t>(_largest_acked, largest);
+        if(newly_acked) {
+            _probe_count = 0;
+            _detect_losses(now);
+        }
+        _stats.congestion_window = _window;
+    }
+
+    void reliable_session::_on_message(pending_t message) {
+        auto& stream = _streams[message.stream];
+        if(message.sequence < stream.next_deliver || stream.early.count(message.sequence)) {
+            ++_stats.duplicates;
+            return;
+        }
+        if(message.sequence != stream.next_deliver) { //a gap on this stream only, the others deliver on
+            stream.early.emplace(message.sequence, std::move(message.payload));
+            return;
+        }
+        _delivered.push_back({message.stream, std::move(message.payload)});
+        ++stream.next_deliver;
+        ++_stats.messages_delivered;
+        for(auto i = stream.early.begin(); i != stream.early.end() && i->first == stream.next_deliver; i = stream.early.erase(i)) {
+            _delivered.push_back({message.stream, std::move(i->second)});
+            ++stream.next_deliver;
+            ++_stats.messages_delivered;
+        }
+    }
+
+    void reliable_session::_on_rtt_sample(const clock_t::duration latest, const clock_t::duration ack_delay) {
+        _latest_rtt = latest;
+        if(!_rtt_sampled) {
+            _rtt_sampled = true;
+            _min_rtt = latest;
+            _smoothed_rtt = latest;
+            _rtt_variation = latest / 2;
+        } else {
+            _min_rtt = std::min(_min_rtt, latest);
+            auto adjusted = latest;
+            auto delay = std::min<clock_t::duration>(ack_delay, _options.max_ack_delay);
+            if(latest >= _min_rtt + delay) { //the peer's ack delay is not part of the path's RTT
+                adjusted -= delay;
+            }
+            _rtt_variation = (3 * _rtt_variation + std::chrono::abs(_smoothed_rtt - adjusted)) / 4;
+            _smoothed_rtt = (7 * _smoothed_rtt + adjusted) / 8;
+        }
+        _stats.smoothed_rtt = std::chrono::duration_cast<std::chrono::microseconds>(_smoothed_rtt);
+        _stats.rtt_variation = std::chrono::duration_cast<std::chrono::microseconds>(_rtt_variation);
+        _stats.min_rtt = std::chrono::duration_cast<std::chrono::microseconds>(_min_rtt);
+    }
+
+    void reliable_session::_detect_losses(const clock_t::time_point now) {
+        _loss_time = clock_t::time_point::max();
+        if(_largest_acked < 0) {
+            return;
+        }
+        //9/8 of an RTT to start with, as the reordering threshold grows so does the time allowed, up to 22/8
+        auto delay = std::max<clock_t::duration>((_reorder_threshold + 6) * std::max(_latest_rtt, _smoothed_rtt) / 8, GRANULARITY);
+        for(auto& packet: _sent) {
+            if(packet.number > _largest_acked) {
+                break;
+            }
+            if(!packet.in_flight) {
+                continue;
+            }
+            if(_largest_acked - packet.number >= _reorder_threshold || packet.time + delay <= now) {
+                _on_lost(packet, now);
+            } else {
+                _loss_time = std::min(_loss_time, packet.time + delay);
+            }
+        }
+        _trim_sent();
+    }
+
+    void reliable_session::_on_lost(sent_packet_t& packet, const clock_t::time_point now) {
+        packet.in_flight = false;
+        packet.lost = true;
+        _stats.bytes_in_flight -= packet.size;
+        ++_stats.packets_lost;
+        for(auto& message: packet.messages) {
+            _queued_bytes += message.payload.size();
+            _retransmit.push_back(std::move(message));
+            ++_stats.retransmissions;
+        }
+        packet.messages.clear();
+        if(packet.time > _recovery_start) { //one window reduction per round trip of losses (NewReno)
+            _recovery_start = now;
+            _slow_start_threshold = std::max(_window / 2, _options.minimum_window * _options.max_datagram);
+            _window = _slow_start_threshold;
+            _stats.congestion_window = _window;
+        }
+    }
+
+    void reliable_session::_record_received(const uint32_t number) {
+        for(size_t i = 0; i < _received.size(); ++i) {
+            auto& range = _received[i];
+            if(number > range.second + 1) {
+                _received.insert(_received.begin() + static_cast<long>(i), {number, number});
+                break;
+            }
+            if(number == range.second + 1) {
+                range.second = number;
+                if(i > 0 && _received[i - 1].first == number + 1) { //closes the gap to the range above
+                    _received[i - 1].first = range.first;
+                    _received.erase(_received.begin() + static_cast<long>(i));
+                }
+                return;
+            }
+            if(number >= range.first) { //a duplicate
+                return;
+            }
+            if(number + 1 == range.first) {
+                range.first = number;
+                if(i + 1 < _received.size() && _received[i + 1].second + 1 == number) { //closes the gap to the range below
+                    range.first = _received[i + 1].first;
+                    _received.erase(_received.begin() + static_cast<long>(i) + 1);
+                }
+                return;
+            }
+            if(i + 1 == _received.size()) {
+                _received.push_back({number, number});
+                break;
+            }
+        }
+        if(_received.empty()) {
+            _received.push_back({number, number});
+        }
+        if(_received.size() > MAX_ACK_RANGES) { //the oldest range is forgotten, its packets were acked many times by now
+            _received.pop_back();
+        }
+    }
+
+    void reliable_session::_trim_sent() {
+        //the window of unsettled packets starts at the oldest in flight, or lost recently enough that an ack may yet come
+        while(!_sent.empty() && !_sent.front().in_flight &&
+              (!_sent.front().lost || _sent.front().number + 2 * MAX_REORDER_THRESHOLD < _largest_acked)) {
+            _sent.pop_front();
+        }
+    }
+
+    reliable_session::clock_t::duration reliable_session::_probe_timeout() const {
+        auto timeout = _smoothed_rtt + std::max<clock_t::duration>(4 * _rtt_variation, GRANULARITY) + _options.max_ack_delay;
+        return timeout * (1u << std::min(_probe_count, MAX_PROBE_BACKOFF));
+    }
+
+    void reliable_session::_refill(const clock_t::time_point now) {
+        if(now <= _refilled) {
+            return;
+        }
+        auto rate = _options.pacing_gain * static_cast<double>(_window) / std::chrono::duration<double>(_smoothed_rtt).count();
+        auto burst = static_cast<double>(_options.initial_window * _options.max_datagram);
+        _tokens = std::min(burst, _tokens + rate * std::chrono::duration<double>(now - _refilled).count());
+        _refilled = now;
+    }
+
+}
+
+#endif // __linux__
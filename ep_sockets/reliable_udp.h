@@ -0,0 +1,460 @@
+#ifndef RELIABLE_UDP_H
+#define RELIABLE_UDP_H
+
+#ifdef __linux__
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <optional>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "poll.h"
+#include "sys/socket.h"
+
+#include "socket_factory.h"
+
+namespace net {
+
+    /**
+     * @brief reliable_options_t - datagram size, acknowledgement, RTT and congestion settings of a reliable_session,
+     * which throws EMSG_RELIABLE_OPTIONS for settings it cannot work with
+     */
+    struct reliable_options_t {
+        size_t max_datagram = 1200; //bytes per datagram, headers included, kept below the path MTU as QUIC does
+        std::chrono::milliseconds max_ack_delay{5}; //acks go at the latest this long after a packet needing one, else every second packet
+        std::chrono::milliseconds initial_rtt{100}; //RTT assumed until the first sample
+        size_t initial_window = 10; //congestion window to start with and largest burst pacing allows, in datagrams
+        size_t minimum_window = 2; //congestion window floor after losses, in datagrams
+        double pacing_gain = 1.25; //datagrams are spread at this multiple of a congestion window per smoothed RTT
+        size_t max_queued = 4 * 1024 * 1024; //bytes queued unsent above which send reports backpressure
+    };
+
+    /**
+     * @brief reliable_message_t - one message of a stream, streams are delivered independently of each other
+     */
+    struct reliable_message_t {
+        uint16_t stream;
+        std::string payload;
+    };
+
+    /**
+     * @brief reliable_stats_t - counters and the current RTT and congestion state of a reliable_session
+     */
+    struct reliable_stats_t {
+        uint64_t datagrams_sent = 0;
+        uint64_t datagrams_received = 0;
+        uint64_t messages_sent = 0;
+        uint64_t messages_delivered = 0;
+        uint64_t packets_lost = 0; //declared lost by the packet or time threshold
+        uint64_t spurious_losses = 0; //of packets_lost, those acked later after all, each raises the reordering threshold
+        uint64_t retransmissions = 0; //messages sent again, after a loss or as a probe
+        uint64_t duplicates = 0; //messages received more than once, dropped
+        uint64_t malformed = 0; //datagrams dropped as not of this protocol
+        std::chrono::microseconds smoothed_rtt{0};
+        std::chrono::microseconds rtt_variation{0};
+        std::chrono::microseconds min_rtt{0};
+        size_t congestion_window = 0; //bytes
+        size_t bytes_in_flight = 0;
+    };
+
+    /**
+     * @brief The reliable_session class is the protocol state of one end of a reliable, ordered association over UDP, with
+     * no I/O of its own: feed it the datagrams that arrive and send the ones it builds, reliable_channel does both.
+     * @version 0.5
+     * Messages go on numbered streams, each delivered in order, but a loss on one stream never holds up the others.
+     * Every datagram has a fresh packet number (retransmissions too, so RTT samples are never ambiguous) and carries as many
+     * whole messages as fit. Receivers answer with selective acks of up to MAX_ACK_RANGES packet number ranges, at once for
+     * every second packet or out of order arrival, else within max_ack_delay. Loss detection and the probe timeout follow
+     * QUIC (RFC 9002): a packet is lost once three later ones are acked or it is 9/8 of an RTT older than an acked one,
+     * and a probe goes out when acks stop. A lost packet acked after all shows the path reorders: the three grows by one
+     * each time, up to MAX_REORDER_THRESHOLD, and the 9/8 by 1/8 with it. Congestion control is NewReno over bytes in flight, and sends are paced at
+     * pacing_gain x window / smoothed RTT with bursts of up to initial_window datagrams.
+     * @note messages must fit one datagram (max_datagram less 14 bytes of headers). Packet and message numbers are 32 bit, an
+     * association must be replaced before 2^32 of either. Not thread safe.
+     */
+    class reliable_session {
+
+    public:
+
+        using clock_t = std::chrono::steady_clock;
+
+        static const size_t MAX_ACK_RANGES = 32;
+
+        static const uint32_t MAX_REORDER_THRESHOLD = 16;
+
+        explicit reliable_session(const reliable_options_t& options = reliable_options_t{});
+
+        /**
+         * @brief send - queue a message on a stream, it goes out as the congestion window and pacing allow
+         * @return bool - false once more than max_queued bytes wait to be sent, the message is queued regardless
+         */
+        bool send(const uint16_t stream, std::string message);
+
+        /**
+         * @brief receive - the next message delivered in order on its stream, if any
+         */
+        std::optional<reliable_message_t> receive();
+
+        /**
+         * @brief on_datagram - process a datagram from the peer, its acks and messages
+         */
+        void on_datagram(const char* data, const size_t size, const clock_t::time_point now = clock_t::now());
+
+        /**
+         * @brief next_datagram - build the next datagram due to be sent into buffer (max_datagram bytes)
+         * @return size_t - its size, 0 when nothing may be sent now
+         */
+        size_t next_datagram(char* buffer, const clock_t::time_point now = clock_t::now());
+
+        /**
+         * @brief on_timeout - run the loss and probe timers, call when next_deadline has passed
+         */
+        void on_timeout(const clock_t::time_point now = clock_t::now());
+
+        /**
+         * @brief next_deadline - when on_timeout or next_datagram next has work to do, time_point::max() when neither has
+         */
+        clock_t::time_point next_deadline() const;
+
+        /**
+         * @brief idle - every message sent has been acknowledged
+         */
+        bool idle() const;
+
+        const reliable_stats_t& stats() const;
+
+        size_t max_message_size() const;
+
+    private:
+
+        struct pending_t {
+            uint16_t stream;
+            uint32_t sequence;
+            std::string payload;
+        };
+
+        struct sent_packet_t {
+            uint32_t number;
+            clock_t::time_point time;
+            size_t size;
+            bool in_flight; //carries messages and is neither acked nor lost yet
+            bool lost; //declared lost and not acked since
+            std::vector<pending_t> messages;
+        };
+
+        struct stream_t {
+            uint32_t next_send = 0;
+            uint32_t next_deliver = 0;
+            std::map<uint32_t, std::string> early; //arrived ahead of next_deliver
+        };
+
+        void _on_ack(const char* data, const char* end, const clock_t::time_point now);
+
+        void _on_message(pending_t message);
+
+        void _on_rtt_sample(const clock_t::duration latest, const clock_t::duration ack_delay);
+
+        void _detect_losses(const clock_t::time_point now);
+
+        void _on_lost(sent_packet_t& packet, const clock_t::time_point now);
+
+        void _record_received(const uint32_t number);
+
+        void _trim_sent();
+
+        clock_t::duration _probe_timeout() const;
+
+        void _refill(const clock_t::time_point now);
+
+        reliable_options_t _options;
+        reliable_stats_t _stats;
+        std::unordered_map<uint16_t, stream_t> _streams;
+        std::deque<reliable_message_t> _delivered;
+
+        //sending
+        std::deque<pending_t> _queue; //new messages
+        std::deque<pending_t> _retransmit; //lost messages, sent before new ones
+        size_t _queued_bytes = 0;
+        std::deque<sent_packet_t> _sent; //every packet number from the oldest unsettled one up, in order
+        uint32_t _next_number = 0;
+        int64_t _largest_acked = -1;
+        uint32_t _reorder_threshold; //later packets acked before one is lost
+        clock_t::time_point _last_ack_eliciting; //when the newest packet carrying messages went
+        clock_t::time_point _loss_time = clock_t::time_point::max(); //when the oldest not yet lost packet will be by time
+        unsigned int _probe_count = 0; //probe timeouts in a row, each doubles the next
+        size_t _probes = 0; //datagrams owed to a probe timeout, sent regardless of window and pacing
+
+        //RTT and congestion
+        bool _rtt_sampled = false;
+        clock_t::duration _latest_rtt;
+        clock_t::duration _smoothed_rtt;
+        clock_t::duration _rtt_variation;
+        clock_t::duration _min_rtt;
+        size_t _window;
+        size_t _slow_start_threshold = SIZE_MAX;
+        clock_t::time_point _recovery_start; //packets sent before this do not shrink the window again
+        double _tokens; //pacing credit in bytes
+        clock_t::time_point _refilled;
+
+        //receiving
+        std::vector<std::pair<uint32_t, uint32_t>> _received; //packet number ranges [low, high], highest first
+        clock_t::time_point _largest_received_time;
+        size_t _unacked_eliciting = 0; //packets needing an ack since the last one was sent
+        bool _ack_now = false;
+        clock_t::time_point _ack_deadline = clock_t::time_point::max();
+
+    };
+
+    /**
+     * @brief datagram_transmit, datagram_receive and datagram_next_due - how reliable_channel sends on, receives from and
+     * waits for a datagram socket: a connected udp_client_socket, a udp_server_socket answering the last peer it heard from
+     * or a lossy_link over either. datagram_receive never blocks and returns -1 when nothing is ready.
+     */
+    inline long datagram_transmit(udp_client_socket& socket, const char* data, const size_t size) {
+        thread_local std::vector<std::string_view> buffers(1);
+        buffers[0] = std::string_view(data, size);
+        return socket.gather_write(buffers);
+    }
+
+    inline long datagram_transmit(udp_server_socket& socket, const char* data, const size_t size) {
+        thread_local std::string buffer;
+        buffer.assign(data, size);
+        return socket.write_back(buffer);
+    }
+
+    inline long datagram_receive(udp_client_socket& socket, char* buffer, const size_t size) {
+        return socket.read_some(buffer, size, MSG_DONTWAIT);
+    }
+
+    inline long datagram_receive(udp_server_socket& socket, char* buffer, const size_t size) {
+        return socket.read_some_from(buffer, size, MSG_DONTWAIT);
+    }
+
+    template<typename S>
+    reliable_session::clock_t::time_point datagram_next_due(const S&) {
+        return reliable_session::clock_t::time_point::max(); //a real socket's datagrams are due when they arrive
+    }
+
+    /**
+     * @brief loss_options_t - the impairment a lossy_link applies to what it receives
+     */
+    struct loss_options_t {
+        double loss = 0.0; //probability a datagram is dropped
+        std::chrono::microseconds delay{0}; //added to every datagram kept
+        std::chrono::microseconds jitter{0}; //up to this much more, at random, which reorders datagrams
+        unsigned int seed = 1;
+    };
+
+    /**
+     * @brief The lossy_link class is a test shim between a datagram socket and a reliable_channel that drops, delays and
+     * reorders the datagrams received, to exercise retransmission and congestion control on loopback. Wrap both ends to
+     * impair both directions.
+     * @tparam S - udp_client_socket or udp_server_socket
+     */
+    template<typename S>
+    class lossy_link {
+
+    public:
+
+        lossy_link(S&& socket, const loss_options_t& options):
+            _socket(std::move(socket)), _options(options), _random(options.seed) {}
+
+        long transmit(const char* data, const size_t size) {
+            return datagram_transmit(_socket, data, size);
+        }
+
+        /**
+         * @brief receive - take in every datagram the socket has, then hand out the first one whose delay has passed
+         */
+        long receive(char* buffer, const size_t size) {
+            auto now = reliable_session::clock_t::now();
+            std::uniform_real_distribution<double> chance(0.0, 1.0);
+            _datagram.resize(size);
+            long i;
+            while((i = datagram_receive(_socket, &_datagram[0], size)) >= 0) {
+                if(chance(_random) < _options.loss) {
+                    continue;
+                }
+                auto jitter = _options.jitter.count() ? std::chrono::microseconds(std::uniform_int_distribution<long long>(0, _options.jitter.count())(_random))
+                                                      : std::chrono::microseconds(0);
+                _held.push({now + _options.delay + jitter, _datagram.substr(0, static_cast<size_t>(i))});
+            }
+            if(_held.empty() || _held.top().first > now) {
+                return -1;
+            }
+            auto& next = _held.top().second;
+            auto n = std::min(size, next.size());
+            std::copy(next.begin(), next.begin() + static_cast<long>(n), buffer);
+            _held.pop();
+            return static_cast<long>(n);
+        }
+
+        reliable_session::clock_t::time_point next_due() const {
+            return _held.empty() ? reliable_session::clock_t::time_point::max() : _held.top().first;
+        }
+
+        S& socket() {
+            return _socket;
+        }
+
+        unsigned int sockfd() const {
+            return _socket.sockfd();
+        }
+
+    private:
+
+        using held_t = std::pair<reliable_session::clock_t::time_point, std::string>;
+
+        struct later_t {
+            bool operator()(const held_t& a, const held_t& b) const {
+                return a.first > b.first;
+            }
+        };
+
+        S _socket;
+        loss_options_t _options;
+        std::mt19937 _random;
+        std::string _datagram; //receive buffer
+        std::priority_queue<held_t, std::vector<held_t>, later_t> _held; //soonest due on top
+
+    };
+
+    template<typename S>
+    long datagram_transmit(lossy_link<S>& link, const char* data, const size_t size) {
+        return link.transmit(data, size);
+    }
+
+    template<typename S>
+    long datagram_receive(lossy_link<S>& link, char* buffer, const size_t size) {
+        return link.receive(buffer, size);
+    }
+
+    template<typename S>
+    reliable_session::clock_t::time_point datagram_next_due(const lossy_link<S>& link) {
+        return link.next_due();
+    }
+
+    /**
+     * @brief The reliable_channel class runs a reliable_session over a datagram socket it owns, polling the socket and the
+     * session's timers from the calling thread: send queues and transmits what the window allows, receive and flush keep
+     * the protocol going (acks, retransmissions, paced sends) while they wait.
+     * @version 0.5
+     * @note not thread safe, one thread sends and receives. Both ends of the association must use one.
+     * @tparam S - udp_client_socket, udp_server_socket (it talks to the last peer heard from) or a lossy_link over one
+     */
+    template<typename S>
+    class reliable_channel {
+
+    public:
+
+        using clock_t = reliable_session::clock_t;
+
+        reliable_channel(S&& socket, const reliable_options_t& options = reliable_options_t{}):
+            _socket(std::move(socket)), _session(options), _buffer(options.max_datagram + 1, '\0') {}
+
+        reliable_channel(const reliable_channel&) = delete;
+
+        reliable_channel& operator= (const reliable_channel&) = delete;
+
+        /**
+         * @brief send - queue a message on a stream and transmit what may go now
+         * @return bool - false while the session has more than max_queued bytes waiting, back off until it drains
+         */
+        bool send(const uint16_t stream, std::string message) {
+            auto accepted = _session.send(stream, std::move(message));
+            _transmit(clock_t::now());
+            return accepted;
+        }
+
+        /**
+         * @brief receive - the next message of any stream, keeping the session going until one is delivered or timeout passes
+         */
+        std::optional<reliable_message_t> receive(const std::chrono::milliseconds timeout) {
+            auto end = clock_t::now() + timeout;
+            while(true) {
+                if(auto message = _session.receive()) {
+                    return message;
+                }
+                auto now = clock_t::now();
+                if(now >= end) {
+                    return std::nullopt;
+                }
+                service(end - now);
+            }
+        }
+
+        /**
+         * @brief flush - keep the session going until every message sent is acknowledged or timeout passes
+         * @return bool - true when all were acknowledged
+         */
+        bool flush(const std::chrono::milliseconds timeout) {
+            auto end = clock_t::now() + timeout;
+            for(auto now = clock_t::now(); !_session.idle() && now < end; now = clock_t::now()) {
+                service(end - now);
+            }
+            return _session.idle();
+        }
+
+        /**
+         * @brief service - wait up to max_wait for a datagram or a timer, then receive, run the timers and transmit
+         */
+        void service(const clock_t::duration max_wait) {
+            auto now = clock_t::now();
+            auto deadline = std::min({_session.next_deadline(), datagram_next_due(_socket), now + max_wait});
+            if(deadline > now) {
+                auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now);
+                timespec ts{static_cast<time_t>(wait.count() / 1000000000), static_cast<long>(wait.count() % 1000000000)};
+                pollfd readable{static_cast<int>(_socket.sockfd()), POLLIN, 0};
+                ppoll(&readable, 1, &ts, nullptr);
+                now = clock_t::now();
+            }
+            long i;
+            for(size_t n = 0; n < MAX_BATCH && (i = datagram_receive(_socket, &_buffer[0], _buffer.size())) >= 0; ++n) {
+                _session.on_datagram(_buffer.data(), static_cast<size_t>(i), now);
+            }
+            _session.on_timeout(now);
+            _transmit(now);
+        }
+
+        const reliable_stats_t& stats() const {
+            return _session.stats();
+        }
+
+        reliable_session& session() {
+            return _session;
+        }
+
+        S& socket() {
+            return _socket;
+        }
+
+        unsigned int sockfd() const {
+            return _socket.sockfd();
+        }
+
+    private:
+
+        void _transmit(const clock_t::time_point now) {
+            size_t n;
+            while((n = _session.next_datagram(&_buffer[0], now)) > 0) {
+                datagram_transmit(_socket, _buffer.data(), n);
+            }
+        }
+
+        S _socket;
+        reliable_session _session;
+        std::string _buffer; //one datagram and a byte, to tell an oversized one
+    };
+
+}
+
+#endif // __linux__
+
+#endif // RELIABLE_UDP_H
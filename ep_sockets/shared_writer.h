@@ -0,0 +1,183 @@
+#ifndef SHARED_WRITER_H
+#define SHARED_WRITER_H
+
+#include <atomic>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace net {
+
+    /**
+     * @brief The shared_writer class lets many threads write to one stream socket without a mutex: writers push their message
+     * onto a lock free MPSC queue (Vyukov's intrusive list, one exchange per push) and whichever thread finds the socket
+     * idle becomes its owner and drains the queue, many messages per gather_write (writev), until the queue is empty.
+     * @version 0.5
+     * Messages are never interleaved - each is queued whole and the owner sends them in queue order, finishing a partial
+     * send before anything else. Writers that find an owner at work return at once instead of convoying on a lock, the
+     * owner sends what they queued in its next batch.
+     * With MSG_DONTWAIT the owner stops when the send buffer is full and leaves the rest queued, an event loop should then
+     * call flush when the socket is writable (or use enqueue and flush only, for a dedicated owner thread).
+     * A send that throws fails the writer for good: that owner rethrows, and so does every later write or flush.
+     * @note write returning means queued, not sent. The socket must outlive the writer, and no one else may write to it.
+     * @tparam S - a stream multi_socket product with gather_write, e.g. tcp_active_socket or tcp_client_socket
+     */
+    template<typename S>
+    class shared_writer {
+
+        struct node_t {
+            std::atomic<node_t*> next{nullptr};
+            std::string message;
+        };
+
+    public:
+
+        /**
+         * @brief shared_writer
+         * @param socket - the connection written to
+         * @param flags - gather_write flags, e.g. MSG_NOSIGNAL, or MSG_DONTWAIT when an event loop finishes flushing
+         */
+        explicit shared_writer(S& socket, const int flags = 0):
+            _socket(socket), _flags(flags), _head(new node_t), _tail(_head) {}
+
+        shared_writer(const shared_writer&) = delete;
+
+        shared_writer& operator= (const shared_writer&) = delete;
+
+        /**
+         * @brief write - queue a message and, unless another thread is already sending, send the queue
+         */
+        void write(std::string message) {
+            enqueue(std::move(message));
+            flush();
+        }
+
+        /**
+         * @brief enqueue - queue a message for the owner to send, never sends itself
+         */
+        void enqueue(std::string message) {
+            _check();
+            if(message.empty()) {
+                return; //would look like a full send buffer to the owner
+            }
+            auto n = new node_t;
+            n->message = std::move(message);
+            _buffered.fetch_add(n->message.size(), std::memory_order_relaxed);
+            auto previous = _tail.exchange(n, std::memory_order_seq_cst);
+            previous->next.store(n, std::memory_order_seq_cst); //until this link the owner sees the queue end at previous
+        }
+
+        /**
+         * @brief flush - become the owner and send the queue, returns at once when another thread already owns it
+         * @return size_t - bytes sent by this call
+         */
+        size_t flush() {
+            _check();
+            size_t sent = 0;
+            while(!_draining.exchange(true, std::memory_order_seq_cst)) {
+                try {
+                    auto drained = _drain(sent);
+                    auto head = _head; //once ownership is given up another flush may be moving _head
+                    _draining.store(false, std::memory_order_seq_cst);
+                    if(!drained || _tail.load(std::memory_order_seq_cst) == head) {
+                        break; //send buffer full, or nothing was queued after the last look - a later push finds the socket idle
+                    }
+                } catch (...) {
+                    _error = std::current_exception();
+                    _failed.store(true, std::memory_order_release);
+                    _draining.store(false, std::memory_order_seq_cst);
+                    throw;
+                }
+            }
+            return sent;
+        }
+
+        /**
+         * @brief buffered - bytes queued and not yet sent
+         */
+        size_t buffered() const {
+            return _buffered.load(std::memory_order_relaxed);
+        }
+
+        ~shared_writer() {
+            while(auto next = _head->next.load(std::memory_order_acquire)) {
+                delete _head;
+                _head = next;
+            }
+            delete _head;
+        }
+
+    private:
+
+        static const size_t MAX_GATHER = 64; //messages per gather_write
+
+        void _check() const {
+            if(_failed.load(std::memory_order_acquire)) {
+                std::rethrow_exception(_error);
+            }
+        }
+
+        //send until the queue is empty, false when a non blocking send stopped first - owner only
+        bool _drain(size_t& sent) {
+            for(;;) {
+                _iov.clear();
+                auto n = _head->next.load(std::memory_order_acquire);
+                if(!n && _tail.load(std::memory_order_seq_cst) != _head) { //a writer is between its two steps, its link is a moment away
+                    std::this_thread::yield();
+                    continue;
+                }
+                for(; n && _iov.size() < MAX_GATHER; n = n->next.load(std::memory_order_acquire)) {
+                    _iov.emplace_back(n->message);
+                }
+                if(_iov.empty()) {
+                    return true;
+                }
+                _iov.front().remove_prefix(_offset);
+                auto i = static_cast<size_t>(_socket.gather_write(_iov, _flags));
+                if(i == 0) {
+                    return false;
+                }
+                sent += i;
+                _consume(i);
+            }
+        }
+
+        //pop fully sent messages, the old head node is freed and the last one sent becomes the new head (stub)
+        void _consume(size_t n) {
+            _buffered.fetch_sub(n, std::memory_order_relaxed);
+            n += _offset;
+            for(;;) {
+                auto next = _head->next.load(std::memory_order_acquire);
+                if(n < next->message.size()) {
+                    _offset = n;
+                    return;
+                }
+                n -= next->message.size();
+                delete _head;
+                _head = next;
+                next->message = std::string(); //the stub's message was sent, free it now rather than when the next one is
+                _offset = 0;
+                if(n == 0) {
+                    return;
+                }
+            }
+        }
+
+        S& _socket;
+        int _flags;
+        node_t* _head; //owner side stub, its successors are the queue
+        std::atomic<node_t*> _tail; //last pushed, exchanged by writers
+        std::atomic<bool> _draining{false}; //someone owns the socket
+        std::atomic<size_t> _buffered{0};
+        std::atomic<bool> _failed{false};
+        std::exception_ptr _error; //written once before _failed is set
+        size_t _offset = 0; //bytes of the first queued message already sent - owner only
+        std::vector<std::string_view> _iov; //owner only
+
+    };
+
+}
+
+#endif // SHARED_WRITER_H
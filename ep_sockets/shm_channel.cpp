@@ -0,0 +1,425 @@
+#include "shm_channel.h"
+
+#ifdef __linux__
+
+#include <climits>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include "fcntl.h"
+#include "linux/futex.h"
+#include "sys/mman.h"
+#include "sys/stat.h"
+#include "sys/syscall.h"
+#include "unistd.h"
+
+#include "socket_factory.h"
+
+namespace net {
+
+    namespace {
+
+        static const unsigned long long MAGIC = 0x6570736863686e31ULL; //"epshchn1", written last by the creator
+        static const size_t DATA_OFFSET = 4096; //the ring starts on its own page after the header
+        static const size_t MIN_CAPACITY = 4096;
+        static const size_t RECORD_HEADER = 8; //length word and padding, keeps every record 8 byte aligned
+        static const uint32_t PUBLISHED = 0x80000000u; //set in a length word by the release store that publishes the record
+        static const uint32_t WRAP = 0xffffffffu; //length word of the filler before a record that would not fit at the end of the ring
+        static const long long EMPTY = -1;
+        static const long long CLOSED = -2;
+
+        size_t record_size(const size_t payload) {
+            return RECORD_HEADER + ((payload + 7) & ~size_t(7));
+        }
+
+        inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#elif defined(__aarch64__)
+            asm volatile("yield");
+#endif
+        }
+
+        //not FUTEX_PRIVATE_FLAG, the word is shared between processes
+        void futex_wait(std::atomic<uint32_t>* word, const uint32_t expected) {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+        }
+
+        void futex_wake(std::atomic<uint32_t>* word, const int count) {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, count, nullptr, nullptr, 0);
+        }
+
+        /**
+         * @brief await - until ready, spinning for busy_poll then sleeping on seq, false at once when non blocking and not ready.
+         * Sleepers announce themselves then check again, and notify checks for sleepers after publishing, the fences between make
+         * sure at least one side sees the other (Dekker) so no wake up is lost. notify clears the count as it wakes, so a sleeper
+         * costs one wake up however many records go by before it runs again, and announces itself afresh if it has to sleep again.
+         */
+        template<typename ready_t>
+        bool await(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& sleepers, const std::chrono::microseconds busy_poll, const int flags, ready_t ready) {
+            if(ready()) {
+                return true;
+            }
+            if(flags & MSG_DONTWAIT) {
+                return false;
+            }
+            if(busy_poll.count() > 0) {
+                auto until = std::chrono::steady_clock::now() + busy_poll;
+                for(unsigned spins = 1; ; ++spins) {
+                    cpu_relax();
+                    if(ready()) {
+                        return true;
+                    }
+                    if(spins % 64 == 0 && std::chrono::steady_clock::now() >= until) {
+                        break;
+                    }
+                }
+            }
+            for(;;) {
+                auto s = seq.load(std::memory_order_acquire);
+                sleepers.fetch_add(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if(ready()) {
+                    return true; //the count is left for the next notify to clear, one spurious wake up at most
+                }
+                futex_wait(&seq, s); //returns at once if seq moved on since it was read
+                if(ready()) {
+                    return true;
+                }
+            }
+        }
+
+        void notify(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& sleepers, const int count) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if(sleepers.load(std::memory_order_relaxed) > 0 && sleepers.exchange(0, std::memory_order_relaxed) > 0) {
+                seq.fetch_add(1, std::memory_order_release);
+                futex_wake(&seq, count);
+            }
+        }
+
+    }
+
+    //------------header_t implementation------------
+    /**
+     * @brief The header_t struct is the start of the shared segment, each side's hot word on its own cache line.
+     */
+    struct shm_channel::header_t {
+
+        std::atomic<unsigned long long> magic;
+        unsigned long long capacity;
+        ring_t ring;
+        std::atomic<uint32_t> writers_closed;
+        std::atomic<uint32_t> reader_closed;
+        alignas(64) std::atomic<unsigned long long> tail; //reserved by writers, records up to here are published or being copied in
+        alignas(64) std::atomic<unsigned long long> head; //consumed by the reader, everything from here to head + capacity is free and zero
+        alignas(64) std::atomic<uint32_t> data_seq; //futex word the reader sleeps on
+        std::atomic<uint32_t> reader_sleepers;
+        alignas(64) std::atomic<uint32_t> space_seq; //futex word writers sleep on when the ring is full
+        std::atomic<uint32_t> writer_sleepers;
+
+    };
+
+    static_assert(std::atomic<unsigned long long>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+                  "shared memory atomics must not hide a process local lock");
+
+    //------------shm_channel implementation------------
+    shm_channel shm_channel::create(const std::string& name, const shm_options_t& options) {
+        shm_unlink(name.c_str()); //a segment left behind by an earlier run
+        auto fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if(fd < 0) {
+            throw std::runtime_error(base_socket::last_error());
+        }
+        shm_channel channel(fd, name, options.busy_poll);
+        channel._initialise(options);
+        return channel;
+    }
+
+    shm_channel shm_channel::create(const shm_options_t& options) {
+        auto fd = memfd_create("ep_shm_channel", MFD_CLOEXEC);
+        if(fd < 0) {
+            throw std::runtime_error(base_socket::last_error());
+        }
+        shm_channel channel(fd, std::string(), options.busy_poll);
+        channel._initialise(options);
+        return channel;
+    }
+
+    shm_channel shm_channel::attach(const std::string& name, const std::chrono::microseconds busy_poll) {
+        auto fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+        if(fd < 0) {
+            throw std::runtime_error(base_socket::last_error());
+        }
+        return attach(fd, busy_poll);
+    }
+
+    shm_channel shm_channel::attach(const int fd, const std::chrono::microseconds busy_poll) {
+        shm_channel channel(fd, std::string(), busy_poll);
+        struct stat st;
+        if(fstat(fd, &st) < 0) {
+            throw std::runtime_error(base_socket::last_error());
+        }
+        channel._mapped = static_cast<size_t>(st.st_size);
+        if(channel._mapped < DATA_OFFSET + MIN_CAPACITY) {
+            throw std::runtime_error(EMSG_SHM_SEGMENT);
+        }
+        channel._map();
+        if(channel._header->magic.load(std::memory_order_acquire) != MAGIC || DATA_OFFSET + channel._header->capacity != channel._mapped) {
+            throw std::runtime_error(EMSG_SHM_SEGMENT);
+        }
+        return channel;
+    }
+
+    shm_channel::shm_channel(const int fd, const std::string& name, const std::chrono::microseconds busy_poll):
+        _fd(fd), _name(name), _busy_poll(busy_poll) {}
+
+    shm_channel::shm_channel(shm_channel&& other) noexcept:
+        _fd(other._fd), _name(std::move(other._name)), _busy_poll(other._busy_poll), _header(other._header), _ring(other._ring),
+        _mapped(other._mapped), _head_cache(other._head_cache.load(std::memory_order_relaxed)), _partial(other._partial) {
+        other._fd = -1;
+        other._name.clear();
+        other._header = nullptr;
+    }
+
+    shm_channel& shm_channel::operator=(shm_channel&& other) noexcept {
+        if(this != &other) {
+            _close();
+            _fd = other._fd;
+            _name = std::move(other._name);
+            _busy_poll = other._busy_poll;
+            _header = other._header;
+            _ring = other._ring;
+            _mapped = other._mapped;
+            _head_cache.store(other._head_cache.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            _partial = other._partial;
+            other._fd = -1;
+            other._name.clear();
+            other._header = nullptr;
+        }
+        return *this;
+    }
+
+    void shm_channel::_map() {
+        auto p = mmap(nullptr, _mapped, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, 0);
+        if(p == MAP_FAILED) {
+            throw std::runtime_error(base_socket::last_error());
+        }
+        _header = static_cast<header_t*>(p);
+        _ring = static_cast<char*>(p) + DATA_OFFSET;
+    }
+
+    void shm_channel::_initialise(const shm_options_t& options) {
+        size_t capacity = MIN_CAPACITY;
+        while(capacity < options.capacity) {
+            capacity <<= 1;
+        }
+        _mapped = DATA_OFFSET + capacity;
+        if(ftruncate(_fd, static_cast<off_t>(_mapped)) < 0) { //a new segment reads as zero, so is the ring
+            throw std::runtime_error(base_socket::last_error());
+        }
+        _map();
+        new (_header) header_t{};
+        _header->capacity = capacity;
+        _header->ring = options.ring;
+        _header->magic.store(MAGIC, std::memory_order_release);
+    }
+
+    std::string shm_channel::read(const int flags) {
+        auto length = _next(flags);
+        if(length == EMPTY) {
+            throw std::runtime_error(EMSG_SHM_EMPTY);
+        }
+        if(length == CLOSED) {
+            throw std::runtime_error(EMSG_SHM_CLOSED);
+        }
+        auto offset = _header->head.load(std::memory_order_relaxed) & (_header->capacity - 1);
+        std::string message(_ring + offset + RECORD_HEADER + _partial, static_cast<size_t>(length) - _partial);
+        _release();
+        return message;
+    }
+
+    long shm_channel::write(const std::string& buffer, const int flags) {
+        if(buffer.size() > max_message()) {
+            throw std::runtime_error(EMSG_SHM_MESSAGE_SIZE);
+        }
+        auto position = _reserve(buffer.size(), flags);
+        if(position < 0) {
+            return -1;
+        }
+        std::string_view view(buffer);
+        _publish(static_cast<unsigned long long>(position), &view, 1, buffer.size());
+        return static_cast<long>(buffer.size());
+    }
+
+    long shm_channel::gather_write(const std::vector<std::string_view>& buffers, const int flags) {
+        size_t size = 0;
+        for(auto& b: buffers) {
+            size += b.size();
+        }
+        size = std::min(size, max_message());
+        auto position = _reserve(size, flags);
+        if(position < 0) {
+            return 0;
+        }
+        _publish(static_cast<unsigned long long>(position), buffers.data(), buffers.size(), size);
+        return static_cast<long>(size);
+    }
+
+    long shm_channel::read_some(char* buffer, const size_t size, const int flags) {
+        for(;;) {
+            auto length = _next(flags);
+            if(length == EMPTY) {
+                return -1;
+            }
+            if(length == CLOSED) {
+                return 0;
+            }
+            auto offset = _header->head.load(std::memory_order_relaxed) & (_header->capacity - 1);
+            auto n = std::min(size, static_cast<size_t>(length) - _partial);
+            memcpy(buffer, _ring + offset + RECORD_HEADER + _partial, n);
+            _partial += n;
+            if(_partial == static_cast<size_t>(length)) {
+                _release(); //also skips empty messages, a stream has no use for them
+            }
+            if(n > 0) {
+                return static_cast<long>(n);
+            }
+        }
+    }
+
+    void shm_channel::stop(action_t action) {
+        if(action != action_t::READ) {
+            _header->writers_closed.store(1, std::memory_order_release);
+            notify(_header->data_seq, _header->reader_sleepers, 1);
+        }
+        if(action != action_t::WRITE) {
+            _header->reader_closed.store(1, std::memory_order_release);
+            notify(_header->space_seq, _header->writer_sleepers, INT_MAX);
+        }
+    }
+
+    size_t shm_channel::max_message() const {
+        return _header->capacity / 2 - RECORD_HEADER;
+    }
+
+    unsigned int shm_channel::sockfd() const {
+        return static_cast<unsigned int>(_fd);
+    }
+
+    long long shm_channel::_reserve(const size_t size, const int flags) {
+        auto& h = *_header;
+        auto capacity = h.capacity;
+        auto need = record_size(size);
+        for(;;) {
+            if(h.reader_closed.load(std::memory_order_relaxed)) {
+                throw std::runtime_error(EMSG_SHM_CLOSED);
+            }
+            auto tail = h.tail.load(std::memory_order_relaxed);
+            auto offset = tail & (capacity - 1);
+            auto total = offset + need > capacity ? capacity - offset + need : need; //wrap rather than split a record
+            if(tail + total - _head_cache.load(std::memory_order_acquire) > capacity) { //with the reader's release of the space
+                auto fits = [&]() {
+                    auto head = h.head.load(std::memory_order_acquire);
+                    _head_cache.store(head, std::memory_order_release);
+                    return tail + total - head <= capacity || h.reader_closed.load(std::memory_order_relaxed)
+                            || h.tail.load(std::memory_order_relaxed) != tail; //another writer moved on, recompute
+                };
+                if(!await(h.space_seq, h.writer_sleepers, _busy_poll, flags, fits)) {
+                    return -1;
+                }
+                continue;
+            }
+            if(h.ring == ring_t::SPSC) {
+                h.tail.store(tail + total, std::memory_order_relaxed);
+            } else if(!h.tail.compare_exchange_weak(tail, tail + total, std::memory_order_relaxed)) {
+                continue;
+            }
+            if(total != need) {
+                __atomic_store_n(reinterpret_cast<uint32_t*>(_ring + offset), WRAP, __ATOMIC_RELEASE);
+                return static_cast<long long>(tail + total - need);
+            }
+            return static_cast<long long>(tail);
+        }
+    }
+
+    void shm_channel::_publish(const unsigned long long position, const std::string_view* buffers, const size_t count, const size_t size) {
+        auto record = _ring + (position & (_header->capacity - 1));
+        auto p = record + RECORD_HEADER;
+        auto left = size;
+        for(size_t i = 0; i < count && left > 0; ++i) {
+            auto n = std::min(left, buffers[i].size());
+            memcpy(p, buffers[i].data(), n);
+            p += n;
+            left -= n;
+        }
+        __atomic_store_n(reinterpret_cast<uint32_t*>(record), static_cast<uint32_t>(size) | PUBLISHED, __ATOMIC_RELEASE);
+        notify(_header->data_seq, _header->reader_sleepers, 1);
+    }
+
+    long long shm_channel::_next(const int flags) {
+        auto& h = *_header;
+        for(;;) {
+            auto head = h.head.load(std::memory_order_relaxed); //only the reader moves it
+            auto offset = head & (h.capacity - 1);
+            auto word_ptr = reinterpret_cast<uint32_t*>(_ring + offset);
+            uint32_t word = 0;
+            auto published = [&]() {
+                word = __atomic_load_n(word_ptr, __ATOMIC_ACQUIRE);
+                return word != 0 || h.writers_closed.load(std::memory_order_acquire);
+            };
+            if(!await(h.data_seq, h.reader_sleepers, _busy_poll, flags, published)) {
+                return EMPTY;
+            }
+            if(word == 0) {
+                word = __atomic_load_n(word_ptr, __ATOMIC_ACQUIRE); //published just before the writers stopped
+                if(word == 0) {
+                    if(h.tail.load(std::memory_order_acquire) == head) {
+                        return CLOSED;
+                    }
+                    cpu_relax(); //an MPSC writer is still copying in a record it reserved before the stop
+                    continue;
+                }
+            }
+            if(word == WRAP) {
+                *word_ptr = 0;
+                h.head.store(head + (h.capacity - offset), std::memory_order_release);
+                notify(h.space_seq, h.writer_sleepers, INT_MAX);
+                continue;
+            }
+            return static_cast<long long>(word & ~PUBLISHED);
+        }
+    }
+
+    void shm_channel::_release() {
+        auto& h = *_header;
+        auto head = h.head.load(std::memory_order_relaxed);
+        auto record = _ring + (head & (h.capacity - 1));
+        auto size = record_size(*reinterpret_cast<uint32_t*>(record) & ~PUBLISHED);
+        memset(record, 0, size);
+        _partial = 0;
+        h.head.store(head + size, std::memory_order_release);
+        notify(h.space_seq, h.writer_sleepers, INT_MAX);
+    }
+
+    void shm_channel::_close() {
+        if(_header) {
+            munmap(_header, _mapped);
+            _header = nullptr;
+        }
+        if(_fd >= 0) {
+            close(_fd);
+            _fd = -1;
+        }
+        if(!_name.empty()) {
+            shm_unlink(_name.c_str());
+            _name.clear();
+        }
+    }
+
+    shm_channel::~shm_channel() {
+        _close();
+    }
+
+}
+
+#endif // __linux__
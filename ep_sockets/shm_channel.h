@@ -0,0 +1,160 @@
+#ifndef SHM_CHANNEL_H
+#define SHM_CHANNEL_H
+
+#ifdef __linux__
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "socket_constants.h"
+#include "socket_errors.h"
+
+namespace net {
+
+    /**
+     * @brief ring_t - how many processes or threads may write to a shm_channel, there is always a single reader
+     */
+    enum class ring_t {SPSC, MPSC};
+
+    /**
+     * @brief shm_options_t - size and writer mode of a new shm_channel, and how long either side spins before sleeping
+     */
+    struct shm_options_t {
+        size_t capacity = 1024 * 1024; //ring bytes, rounded up to a power of two, a message may use up to half of it
+        ring_t ring = ring_t::SPSC; //MPSC reserves space with a compare and swap so writers may share the channel
+        std::chrono::microseconds busy_poll{0}; //spin this long for data or space before sleeping on the futex, 0 sleeps at once
+    };
+
+    /**
+     * @brief The shm_channel class is a one way same host transport with the read/write API of the socket products, messages
+     * move through a lock free ring in shared memory so steady state traffic makes no system calls at all.
+     * @version 0.5
+     * Each write is one record (length word then payload, 8 byte aligned) that the writer publishes with a release store of the
+     * length word, the reader zeroes records as it consumes them so free space is always zero and an unpublished length reads 0.
+     * A reader or writer that finds the ring empty or full spins for busy_poll then sleeps on a futex in the shared header,
+     * the other side only pays for the wake up system call when someone is actually asleep.
+     * For a duplex conversation use two channels. Segments are either named (shm_open, found by name like a unix socket path)
+     * or anonymous (memfd) and handed to the peer with write_fds on a unix socket.
+     * @note one reader per channel, and one writer unless created ring_t::MPSC, whose writer threads may share one object or
+     * attach their own. A crashed peer is not detected.
+     */
+    class shm_channel {
+
+        struct header_t;
+
+    public:
+
+        /**
+         * @brief create - a new named channel, a stale segment of the same name is replaced and the name is unlinked again on destruction
+         * @param name - shm_open name e.g. "/ep_sidecar"
+         */
+        static shm_channel create(const std::string& name, const shm_options_t& options = shm_options_t{});
+
+        /**
+         * @brief create - a new anonymous channel, pass sockfd() to the peer (e.g. write_fds) to attach it
+         */
+        static shm_channel create(const shm_options_t& options = shm_options_t{});
+
+        /**
+         * @brief attach - the other end of a named channel
+         */
+        static shm_channel attach(const std::string& name, const std::chrono::microseconds busy_poll = std::chrono::microseconds(0));
+
+        /**
+         * @brief attach - the other end of a channel from its descriptor, e.g. received by read_fds, this channel then owns fd
+         */
+        static shm_channel attach(const int fd, const std::chrono::microseconds busy_poll = std::chrono::microseconds(0));
+
+        shm_channel(shm_channel&& other) noexcept;
+
+        shm_channel& operator= (shm_channel&& other) noexcept;
+
+        shm_channel(const shm_channel&) = delete;
+
+        shm_channel& operator= (const shm_channel&) = delete;
+
+        /**
+         * @brief read - the next message whole, or what is left of one read_some started
+         * @param flags - MSG_DONTWAIT throws EMSG_SHM_EMPTY rather than waiting when the ring is empty
+         * @return string - the message, throws EMSG_SHM_CLOSED once the writers stopped and the ring is drained
+         */
+        std::string read(const int flags = 0);
+
+        /**
+         * @brief write - publish buffer as one message, waiting for space when the ring is full
+         * @param flags - MSG_DONTWAIT returns -1 rather than waiting when the ring is full
+         * @return long - the number of bytes written, else -1
+         */
+        long write(const std::string& buffer, const int flags = 0);
+
+        /**
+         * @brief gather_write - publish the buffers as one message, stream style, up to max_message bytes of them
+         * @return long - the number of bytes written, 0 when non blocking and the ring is full
+         */
+        long gather_write(const std::vector<std::string_view>& buffers, const int flags = 0);
+
+        /**
+         * @brief read_some - copy up to size bytes of the next message, the rest stays for the next read, so buffered_reader works on a channel
+         * @return long - bytes read, 0 once the writers stopped and the ring is drained, -1 when non blocking and the ring is empty
+         */
+        long read_some(char* buffer, const size_t size, const int flags = 0);
+
+        /**
+         * @brief stop - WRITE tells the reader no more messages follow, READ makes further writes throw, both wake any sleeper
+         */
+        void stop(action_t action);
+
+        /**
+         * @brief max_message - the largest message the ring takes
+         */
+        size_t max_message() const;
+
+        /**
+         * @brief sockfd - the shared memory descriptor, for passing to the peer with write_fds (it is not pollable)
+         * @note ownership is retained by this channel, do not close it.
+         */
+        unsigned int sockfd() const;
+
+        ~shm_channel();
+
+    private:
+
+        shm_channel(const int fd, const std::string& name, const std::chrono::microseconds busy_poll);
+
+        void _map();
+
+        void _close();
+
+        void _initialise(const shm_options_t& options);
+
+        //reserve space for a record of size payload bytes, returns the ring position of its length word or -1 when non blocking and full
+        long long _reserve(const size_t size, const int flags);
+
+        //copy the first size bytes of the buffers in and publish the record reserved at position
+        void _publish(const unsigned long long position, const std::string_view* buffers, const size_t count, const size_t size);
+
+        //the payload length of the next record once one is published, -1 when non blocking and empty, -2 once the writers stopped and it is drained
+        long long _next(const int flags);
+
+        //zero the record at the head and hand its space back to the writers
+        void _release();
+
+        int _fd = -1;
+        std::string _name; //unlinked on destruction when this side created it
+        std::chrono::microseconds _busy_poll;
+        header_t* _header = nullptr;
+        char* _ring = nullptr;
+        size_t _mapped = 0;
+        std::atomic<unsigned long long> _head_cache{0}; //writer side view of the reader's head, refreshed only when the ring looks full, atomic as MPSC writer threads may share this object
+        size_t _partial = 0; //bytes of the head record already returned by read_some
+
+    };
+
+}
+
+#endif // __linux__
+
+#endif // SHM_CHANNEL_H
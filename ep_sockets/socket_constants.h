@@ -2,23 +2,62 @@
 #define SOCKET_CONSTANTS_H
 
 #include <string>
+#include <chrono>
+#include <tuple>
 
 namespace net {
 
     //multi_socket template behaviour selectors
     enum class protocol_t {ANY, TCP, UDP, ICMP, IGMP, RFCOMM, ICMPv6, PGM};
-    enum class role_t {client, server, active};
-    enum class family_t {IPv4, IPv6, IrDA, Bluetooth};
-    enum class socket_t {STREAM, DGRAM, RAW, RDM};
+    enum class role_t {client, server, active, publisher, subscriber};
+    enum class family_t {IPv4, IPv6, IrDA, Bluetooth, Unix};
+    enum class socket_t {STREAM, DGRAM, RAW, RDM, SEQPACKET};
 
     //stop actions
     enum class action_t {READ, WRITE, READ_AND_WRITE};
 
+    //receive timestamp sources
+    enum class timestamp_t {NONE, SOFTWARE, HARDWARE};
+
     //socket constants
     static const std::string LOOPBACK_ADDR = {"127.0.0.1"};
+    static const std::string ANY_ADDR = {"0.0.0.0"}; //any local interface, e.g. let the kernel choose where to join a multicast group
     static const int DEFAULT_PORT = 5555;
     static const int DEFAULT_BUFFER_SIZE = 512;
     static const int BLUETOOTH_BACKLOG = 4;
+    static const int MULTICAST_TTL = 1; //multicast stays on the local subnet unless a larger TTL is asked for
+    static const size_t MAX_BATCH = 64; //datagrams per read_batch call
+    static const size_t MAX_GSO_SEGMENTS = 64; //kernel limit on datagrams per UDP_SEGMENT send
+    static const size_t MAX_DATAGRAM_SIZE = 65507; //largest UDP payload over IPv4, also the largest coalesced GRO train
+    static const size_t TLS_RECORD_SIZE = 16384; //largest TLS record payload, what one tls_socket read returns at most
+    static const size_t COMPRESSION_BLOCK_SIZE = 64 * 1024; //most a compressed_stream block holds, messages are split into blocks of it
+    static const size_t MAX_PASSED_FDS = 64; //descriptors per write_fds message, the kernel allows up to 253 (SCM_MAX_FD)
+    static const char ABSTRACT_PREFIX = '@'; //a local socket path starting with this names the Linux abstract namespace, not a file
+    static const std::chrono::milliseconds CONNECTION_ATTEMPT_DELAY{250}; //RFC 8305 recommended stagger between racing connection attempts
+
+    /**
+     * @brief endpoint_t - a text format Internet address and port pair identifying a peer
+     */
+    struct endpoint_t {
+        std::string address;
+        unsigned short port;
+    };
+
+    /**
+     * @brief rx_timestamp_t - when the kernel received the data a read returned, zero for a source that is off or gave none
+     */
+    struct rx_timestamp_t {
+        std::chrono::nanoseconds software{0}; //arrival in the network stack, CLOCK_REALTIME since the epoch
+        std::chrono::nanoseconds hardware{0}; //arrival at the NIC, on the NIC's clock (CLOCK_REALTIME where PTP disciplines it)
+    };
+
+    inline bool operator<(const endpoint_t& lhs, const endpoint_t& rhs) {
+        return std::tie(lhs.address, lhs.port) < std::tie(rhs.address, rhs.port);
+    }
+
+    inline bool operator==(const endpoint_t& lhs, const endpoint_t& rhs) {
+        return lhs.address == rhs.address && lhs.port == rhs.port;
+    }
 
 }
 
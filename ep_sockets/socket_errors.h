@@ -12,6 +12,38 @@ namespace net {
     static const std::string EMSG_SUCCESS = "Success";
     static const std::string EMSG_UNKNOWN = "Unrecognised error number.";
     static const std::string EMSG_INET_PTON = "src does not contain a character string representing a valid network address in the specified address family.";
+    static const std::string EMSG_POOL_EXHAUSTED = "Every pooled connection to the endpoint stayed in use for the whole checkout timeout.";
+    static const std::string EMSG_BAD_FRAME = "Received frame length is shorter than its correlation id.";
+    static const std::string EMSG_FRAME_LENGTH = "Frame payload is too long for a 32 bit frame length.";
+    static const std::string EMSG_FRAME_MAX_SIZE = "Received frame payload is longer than the frame_decoder max_size.";
+    static const std::string EMSG_POOL_SIZES = "Connection pool max_size must be at least 1 and no smaller than min_size.";
+    static const std::string EMSG_READER_OVERFLOW = "Buffered reader filled its maximum size without finding the delimiter or the requested number of bytes.";
+    static const std::string EMSG_READER_EOF = "Connection closed before the buffered reader found the delimiter or the requested number of bytes.";
+    static const std::string EMSG_BAD_HTTP = "Malformed HTTP/1.x request head.";
+    static const std::string EMSG_BAD_RESP = "Malformed RESP value.";
+    static const std::string EMSG_LOCAL_PATH = "Local (AF_UNIX) socket path is longer than sun_path.";
+    static const std::string EMSG_LOCAL_UNSUPPORTED = "Local (AF_UNIX) sockets and descriptor passing are not supported on this platform.";
+    static const std::string EMSG_SHM_SEGMENT = "Shared memory segment is not an initialised shm_channel.";
+    static const std::string EMSG_SHM_MESSAGE_SIZE = "Message is larger than half the shm_channel ring.";
+    static const std::string EMSG_SHM_EMPTY = "Non blocking shm_channel read found the ring empty.";
+    static const std::string EMSG_SHM_CLOSED = "The other end of the shm_channel stopped.";
+    static const std::string EMSG_XDP_OPTIONS = "xdp_options_t frames and frame_size must be powers of two, frame_size at least 2048.";
+    static const std::string EMSG_XDP_FRAME = "Datagram does not fit one xdp_udp_server_socket frame.";
+    static const std::string EMSG_TLS_CONTEXT = "TLS context setup failed: ";
+    static const std::string EMSG_TLS_HANDSHAKE = "TLS handshake failed: ";
+    static const std::string EMSG_TLS_IO = "TLS read or write failed: ";
+    static const std::string EMSG_TLS_CLOSED = "TLS peer closed the connection.";
+    static const std::string EMSG_HANDOVER = "Listener handover message did not carry exactly one descriptor.";
+    static const std::string EMSG_FDS_EMPTY = "write_fds needs at least one byte to send, an empty message reads as end of stream.";
+    static const std::string EMSG_FDS_TOO_MANY = "write_fds was given more descriptors than MAX_PASSED_FDS.";
+    static const std::string EMSG_FDS_TRUNCATED = "Passed descriptors were discarded, more arrived than read_fds has room for.";
+    static const std::string EMSG_CODEC_SIZE = "Typed message payload is shorter or longer than its codec decodes.";
+    static const std::string EMSG_CODEC_LENGTH = "Typed message is longer than a 32 bit frame length.";
+    static const std::string EMSG_COMPRESSION_UNSUPPORTED = "Compression algorithm was not compiled in (EP_SOCKETS_LZ4, EP_SOCKETS_ZSTD).";
+    static const std::string EMSG_COMPRESSION_FORMAT = "Compressed stream block could not be encoded or decoded, or is malformed or truncated.";
+    static const std::string EMSG_COMPRESSION_CLOSED = "Compressed stream peer closed the connection.";
+    static const std::string EMSG_RELIABLE_OPTIONS = "reliable_options_t max_datagram must be 29 to MAX_DATAGRAM_SIZE bytes, windows at least 1 and initial_window at least minimum_window, initial_rtt and pacing_gain positive.";
+    static const std::string EMSG_RELIABLE_SIZE = "Message is larger than one reliable_session datagram carries.";
 
 #ifdef WIN32
 
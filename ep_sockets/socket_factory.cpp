@@ -16,6 +16,38 @@ namespace net {
         return base_socket::write_back(buffer, flags);
     }
 
+    size_t udp_server_socket::read_batch(std::vector<std::string>& messages, const size_t max_messages, const size_t max_size, const int flags) {
+        return base_socket::read_batch(messages, max_messages, max_size, flags);
+    }
+
+    void udp_server_socket::gro(const bool enable) {
+        base_socket::gro(enable);
+    }
+
+    size_t udp_server_socket::read_segments(std::string& buffer, std::vector<std::string_view>& segments, const int flags) {
+        return base_socket::read_segments(buffer, segments, flags);
+    }
+
+    bool udp_server_socket::busy_poll(const std::chrono::microseconds spin_budget) {
+        return base_socket::busy_poll(spin_budget);
+    }
+
+    std::string udp_server_socket::read_from(rx_timestamp_t& stamp, const int flags) {
+        return base_socket::read_from(stamp, flags);
+    }
+
+    bool udp_server_socket::timestamps(const timestamp_t mode) {
+        return base_socket::timestamps(mode);
+    }
+
+    long udp_server_socket::read_some_from(char* buffer, const size_t size, const int flags) {
+        return base_socket::read_some_from(buffer, size, flags);
+    }
+
+    unsigned int udp_server_socket::sockfd() const {
+        return base_socket::sockfd();
+    }
+
     //------------udp_client_socket implementation------------
     udp_client_socket::multi_socket(const std::string addr, const unsigned short port):
         base_socket(AF_INET, SOCK_DGRAM, 0) {
@@ -30,6 +62,88 @@ namespace net {
         return  base_socket::write(buffer, flags);
     }
 
+    long udp_client_socket::gather_write(const std::vector<std::string_view>& buffers, const int flags) const {
+        return base_socket::gather_write(buffers, flags);
+    }
+
+    long udp_client_socket::read_some(char* buffer, const size_t size, const int flags) const {
+        return base_socket::read_some(buffer, size, flags);
+    }
+
+    long udp_client_socket::write_segmented(std::string_view buffer, const size_t segment_size, const int flags) const {
+        return base_socket::write_segmented(buffer, segment_size, flags);
+    }
+
+    unsigned int udp_client_socket::sockfd() const {
+        return base_socket::sockfd();
+    }
+
+    //------------udp_publisher_socket implementation------------
+    udp_publisher_socket::multi_socket(const std::string group, const unsigned short port, const int ttl, const std::string interface_addr):
+        base_socket(AF_INET, SOCK_DGRAM, 0) {
+        connect_to(group, port);
+        base_socket::multicast_ttl(ttl);
+        if(interface_addr != ANY_ADDR) {
+            base_socket::multicast_interface(interface_addr);
+        }
+    }
+
+    long udp_publisher_socket::write(const std::string& buffer, const int flags) const {
+        return base_socket::write(buffer, flags);
+    }
+
+    long udp_publisher_socket::gather_write(const std::vector<std::string_view>& buffers, const int flags) const {
+        return base_socket::gather_write(buffers, flags);
+    }
+
+    void udp_publisher_socket::multicast_ttl(const int ttl) {
+        base_socket::multicast_ttl(ttl);
+    }
+
+    void udp_publisher_socket::multicast_loopback(const bool enable) {
+        base_socket::multicast_loopback(enable);
+    }
+
+    void udp_publisher_socket::multicast_interface(const std::string& interface_addr) {
+        base_socket::multicast_interface(interface_addr);
+    }
+
+    unsigned int udp_publisher_socket::sockfd() const {
+        return base_socket::sockfd();
+    }
+
+    //------------udp_subscriber_socket implementation------------
+    udp_subscriber_socket::multi_socket(const std::string group, const unsigned short port, const std::string interface_addr):
+        base_socket(AF_INET, SOCK_DGRAM, 0) {
+        reset(); //so every subscriber on this host can bind the group's port
+#ifdef WIN32
+        bind_to(ANY_ADDR, port); //Windows cannot bind to a multicast address
+#else
+        bind_to(group, port); //rather than any address, so datagrams for other groups on the same port are filtered out
+#endif
+        base_socket::join_group(group, interface_addr);
+    }
+
+    std::string udp_subscriber_socket::read_from(const int flags) {
+        return base_socket::read_from(flags);
+    }
+
+    size_t udp_subscriber_socket::read_batch(std::vector<std::string>& messages, const size_t max_messages, const size_t max_size, const int flags) {
+        return base_socket::read_batch(messages, max_messages, max_size, flags);
+    }
+
+    void udp_subscriber_socket::join_group(const std::string& group, const std::string& interface_addr) {
+        base_socket::join_group(group, interface_addr);
+    }
+
+    void udp_subscriber_socket::leave_group(const std::string& group, const std::string& interface_addr) {
+        base_socket::leave_group(group, interface_addr);
+    }
+
+    unsigned int udp_subscriber_socket::sockfd() const {
+        return base_socket::sockfd();
+    }
+
     //------------tcp_active_socket implementation------------
     tcp_active_socket::multi_socket(unsigned int socket): base_socket(socket) {}
 
@@ -41,27 +155,108 @@ namespace net {
         return  base_socket::write(buffer, flags);
     }
 
+    bool tcp_active_socket::is_alive() const {
+        return base_socket::is_alive();
+    }
+
+    void tcp_active_socket::keep_alive(const bool enable) {
+        base_socket::keep_alive(enable);
+    }
+
+    void tcp_active_socket::stop(action_t action) {
+        base_socket::stop(action);
+    }
+
+    long tcp_active_socket::gather_write(const std::vector<std::string_view>& buffers, const int flags) const {
+        return base_socket::gather_write(buffers, flags);
+    }
+
+    long tcp_active_socket::read_some(char* buffer, const size_t size, const int flags) const {
+        return base_socket::read_some(buffer, size, flags);
+    }
+
+    bool tcp_active_socket::busy_poll(const std::chrono::microseconds spin_budget) {
+        return base_socket::busy_poll(spin_budget);
+    }
+
+    std::string tcp_active_socket::read(rx_timestamp_t& stamp, const int flags) const {
+        return base_socket::read(stamp, flags);
+    }
+
+    bool tcp_active_socket::timestamps(const timestamp_t mode) {
+        return base_socket::timestamps(mode);
+    }
+
+    unsigned int tcp_active_socket::sockfd() const {
+        return base_socket::sockfd();
+    }
+
     //------------tcp_server_socket implementation------------
-    tcp_server_socket::multi_socket(const std::string addr, const unsigned short port):
+    tcp_server_socket::multi_socket(const std::string addr, const unsigned short port, const int backlog):
         base_socket(AF_INET, SOCK_STREAM, 0) {
         bind_to(addr, port);
-        be_listening();
+        be_listening(backlog);
+    }
+
+    tcp_server_socket::multi_socket(unsigned int socket): base_socket(socket) {}
+
+    tcp_server_socket tcp_server_socket::take_over(const std::string& path) {
+        return tcp_server_socket(base_socket::take_over(path));
     }
 
     tcp_active_socket tcp_server_socket::accept_and_create_socket()  {
         return tcp_active_socket(base_socket::accept_and_create_sockfd());
     }
 
+    tcp_active_socket tcp_server_socket::accept_and_create_socket(const int flags)  {
+        return tcp_active_socket(base_socket::accept_and_create_sockfd(flags));
+    }
+
+    size_t tcp_server_socket::accept_batch(std::vector<unsigned int>& sockfds, const size_t max_sockets, const int flags) {
+        return base_socket::accept_batch(sockfds, max_sockets, flags);
+    }
+
     void tcp_server_socket::stop(action_t action) {
         base_socket::stop(action);
     }
 
+    void tcp_server_socket::hand_over(const std::string& path) {
+        base_socket::hand_over(path);
+    }
+
+    void tcp_server_socket::fast_open(const int queue_length) {
+        base_socket::fast_open(queue_length);
+    }
+
+    void tcp_server_socket::defer_accept(const std::chrono::seconds timeout) {
+        base_socket::defer_accept(timeout);
+    }
+
+    unsigned int tcp_server_socket::sockfd() const {
+        return base_socket::sockfd();
+    }
+
     //------------tcp_client_socket implementation------------
     tcp_client_socket::multi_socket(const std::string addr, const unsigned short port):
         base_socket(AF_INET, SOCK_STREAM, 0) {
         connect_to(addr, port);
     }
 
+    tcp_client_socket::multi_socket(const std::string addr, const unsigned short port, const std::chrono::milliseconds timeout):
+        base_socket(AF_INET, SOCK_STREAM, 0) {
+        connect_to(addr, port, timeout);
+    }
+
+    tcp_client_socket::multi_socket(const std::string addr, const unsigned short port, const std::string first_message):
+        base_socket(AF_INET, SOCK_STREAM, 0) {
+        connect_fast_open(addr, port, first_message);
+    }
+
+    tcp_client_socket::multi_socket(const std::vector<endpoint_t>& candidates, const std::chrono::milliseconds timeout, const std::chrono::milliseconds stagger):
+        base_socket(AF_INET, SOCK_STREAM, 0) {
+        connect_to_first(candidates, timeout, stagger);
+    }
+
     std::string tcp_client_socket::read(const int flags) const  {
         return base_socket::read(flags);
     }
@@ -70,4 +265,321 @@ namespace net {
         return  base_socket::write(buffer, flags);
     }
 
+    bool tcp_client_socket::is_alive() const {
+        return base_socket::is_alive();
+    }
+
+    void tcp_client_socket::keep_alive(const bool enable) {
+        base_socket::keep_alive(enable);
+    }
+
+    void tcp_client_socket::stop(action_t action) {
+        base_socket::stop(action);
+    }
+
+    long tcp_client_socket::gather_write(const std::vector<std::string_view>& buffers, const int flags) const {
+        return base_socket::gather_write(buffers, flags);
+    }
+
+    long tcp_client_socket::read_some(char* buffer, const size_t size, const int flags) const {
+        return base_socket::read_some(buffer, size, flags);
+    }
+
+    std::string tcp_client_socket::read(rx_timestamp_t& stamp, const int flags) const {
+        return base_socket::read(stamp, flags);
+    }
+
+    bool tcp_client_socket::timestamps(const timestamp_t mode) {
+        return base_socket::timestamps(mode);
+    }
+
+    unsigned int tcp_client_socket::sockfd() const {
+        return base_socket::sockfd();
+    }
+
+#ifdef __linux__
+
+    //------------unix_active_socket implementation------------
+    unix_active_socket::multi_socket(unsigned int socket): base_socket(socket) {}
+
+    std::string unix_active_socket::read(const int flags) const {
+        return base_socket::read(flags);
+    }
+
+    long unix_active_socket::write(const std::string& buffer, const int flags) const {
+        return base_socket::write(buffer, flags);
+    }
+
+    long unix_active_socket::gather_write(const std::vector<std::string_view>& buffers, const int flags) const {
+        return base_socket::gather_write(buffers, flags);
+    }
+
+    long unix_active_socket::read_some(char* buffer, const size_t size, const int flags) const {
+        return base_socket::read_some(buffer, size, flags);
+    }
+
+    long unix_active_socket::write_fds(const std::string& buffer, const std::vector<int>& fds, const int flags) const {
+        return base_socket::write_fds(buffer, fds, flags);
+    }
+
+    std::string unix_active_socket::read_fds(std::vector<int>& fds, const int flags) const {
+        return base_socket::read_fds(fds, flags);
+    }
+
+    bool unix_active_socket::is_alive() const {
+        return base_socket::is_alive();
+    }
+
+    void unix_active_socket::stop(action_t action) {
+        base_socket::stop(action);
+    }
+
+    unsigned int unix_active_socket::sockfd() const {
+        return base_socket::sockfd();
+    }
+
+    //------------unix_server_socket implementation------------
+    unix_server_socket::multi_socket(const std::string path):
+        base_socket(AF_UNIX, SOCK_STREAM, 0), _path(path) {
+        bind_local(path);
+        be_listening();
+    }
+
+    unix_active_socket unix_server_socket::accept_and_create_socket()  {
+        return unix_active_socket(base_socket::accept_and_create_sockfd());
+    }
+
+    void unix_server_socket::stop(action_t action) {
+        base_socket::stop(action);
+    }
+
+    unsigned int unix_server_socket::sockfd() const {
+        return base_socket::sockfd();
+    }
+
+    unix_server_socket::~multi_socket() {
+        if(!_path.empty() && _path.front() != ABSTRACT_PREFIX) {
+            unlink(_path.c_str());
+        }
+    }
+
+    //------------unix_client_socket implementation------------
+    unix_client_socket::multi_socket(const std::string path):
+        base_socket(AF_UNIX, SOCK_STREAM, 0) {
+        connect_local(path);
+    }
+
+    std::string unix_client_socket::read(const int flags) const {
+        return base_socket::read(flags);
+    }
+
+    long unix_client_socket::write(const std::string& buffer, const int flags) const {
+        return base_socket::write(buffer, flags);
+    }
+
+    long unix_client_socket::gather_write(const std::vector<std::string_view>& buffers, const int flags) const {
+        return base_socket::gather_write(buffers, flags);
+    }
+
+    long unix_client_socket::read_some(char* buffer, const size_t size, const int flags) const {
+        return base_socket::read_some(buffer, size, flags);
+    }
+
+    long unix_client_socket::write_fds(const std::string& buffer, const std::vector<int>& fds, const int flags) const {
+        return base_socket::write_fds(buffer, fds, flags);
+    }
+
+    std::string unix_client_socket::read_fds(std::vector<int>& fds, const int flags) const {
+        return base_socket::read_fds(fds, flags);
+    }
+
+    bool unix_client_socket::is_alive() const {
+        return base_socket::is_alive();
+    }
+
+    void unix_client_socket::stop(action_t action) {
+        base_socket::stop(action);
+    }
+
+    unsigned int unix_client_socket::sockfd() const {
+        return base_socket::sockfd();
+    }
+
+    //------------seqpacket_active_socket implementation------------
+    seqpacket_active_socket::multi_socket(unsigned int socket): base_socket(socket) {}
+
+    std::string seqpacket_active_socket::read(const int flags) const {
+        return base_socket::read(flags);
+    }
+
+    long seqpacket_active_socket::write(const std::string& buffer, const int flags) const {
+        return base_socket::write(buffer, flags);
+    }
+
+    long seqpacket_active_socket::gather_write(const std::vector<std::string_view>& buffers, const int flags) const {
+        return base_socket::gather_write(buffers, flags);
+    }
+
+    long seqpacket_active_socket::read_some(char* buffer, const size_t size, const int flags) const {
+        return base_socket::read_some(buffer, size, flags);
+    }
+
+    long seqpacket_active_socket::write_fds(const std::string& buffer, const std::vector<int>& fds, const int flags) const {
+        return base_socket::write_fds(buffer, fds, flags);
+    }
+
+    std::string seqpacket_active_socket::read_fds(std::vector<int>& fds, const int flags) const {
+        return base_socket::read_fds(fds, flags);
+    }
+
+    bool seqpacket_active_socket::is_alive() const {
+        return base_socket::is_alive();
+    }
+
+    void seqpacket_active_socket::stop(action_t action) {
+        base_socket::stop(action);
+    }
+
+    unsigned int seqpacket_active_socket::sockfd() const {
+        return base_socket::sockfd();
+    }
+
+    //------------seqpacket_server_socket implementation------------
+    seqpacket_server_socket::multi_socket(const std::string path):
+        base_socket(AF_UNIX, SOCK_SEQPACKET, 0), _path(path) {
+        bind_local(path);
+        be_listening();
+    }
+
+    seqpacket_active_socket seqpacket_server_socket::accept_and_create_socket()  {
+        return seqpacket_active_socket(base_socket::accept_and_create_sockfd());
+    }
+
+    void seqpacket_server_socket::stop(action_t action) {
+        base_socket::stop(action);
+    }
+
+    unsigned int seqpacket_server_socket::sockfd() const {
+        return base_socket::sockfd();
+    }
+
+    seqpacket_server_socket::~multi_socket() {
+        if(!_path.empty() && _path.front() != ABSTRACT_PREFIX) {
+            unlink(_path.c_str());
+        }
+    }
+
+    //------------seqpacket_client_socket implementation------------
+    seqpacket_client_socket::multi_socket(const std::string path):
+        base_socket(AF_UNIX, SOCK_SEQPACKET, 0) {
+        connect_local(path);
+    }
+
+    std::string seqpacket_client_socket::read(const int flags) const {
+        return base_socket::read(flags);
+    }
+
+    long seqpacket_client_socket::write(const std::string& buffer, const int flags) const {
+        return base_socket::write(buffer, flags);
+    }
+
+    long seqpacket_client_socket::gather_write(const std::vector<std::string_view>& buffers, const int flags) const {
+        return base_socket::gather_write(buffers, flags);
+    }
+
+    long seqpacket_client_socket::read_some(char* buffer, const size_t size, const int flags) const {
+        return base_socket::read_some(buffer, size, flags);
+    }
+
+    long seqpacket_client_socket::write_fds(const std::string& buffer, const std::vector<int>& fds, const int flags) const {
+        return base_socket::write_fds(buffer, fds, flags);
+    }
+
+    std::string seqpacket_client_socket::read_fds(std::vector<int>& fds, const int flags) const {
+        return base_socket::read_fds(fds, flags);
+    }
+
+    bool seqpacket_client_socket::is_alive() const {
+        return base_socket::is_alive();
+    }
+
+    void seqpacket_client_socket::stop(action_t action) {
+        base_socket::stop(action);
+    }
+
+    unsigned int seqpacket_client_socket::sockfd() const {
+        return base_socket::sockfd();
+    }
+
+    //------------unix_datagram_server_socket implementation------------
+    unix_datagram_server_socket::multi_socket(const std::string path):
+        base_socket(AF_UNIX, SOCK_DGRAM, 0), _path(path) {
+        bind_local(path);
+    }
+
+    std::string unix_datagram_server_socket::read_from(const int flags) {
+        return base_socket::read_from(flags);
+    }
+
+    long unix_datagram_server_socket::write_back(const std::string& buffer, const int flags) {
+        return base_socket::write_back(buffer, flags);
+    }
+
+    size_t unix_datagram_server_socket::read_batch(std::vector<std::string>& messages, const size_t max_messages, const size_t max_size, const int flags) {
+        return base_socket::read_batch(messages, max_messages, max_size, flags);
+    }
+
+    std::string unix_datagram_server_socket::read_fds(std::vector<int>& fds, const int flags) const {
+        return base_socket::read_fds(fds, flags);
+    }
+
+    unsigned int unix_datagram_server_socket::sockfd() const {
+        return base_socket::sockfd();
+    }
+
+    unix_datagram_server_socket::~multi_socket() {
+        if(!_path.empty() && _path.front() != ABSTRACT_PREFIX) {
+            unlink(_path.c_str());
+        }
+    }
+
+    //------------unix_datagram_client_socket implementation------------
+    unix_datagram_client_socket::multi_socket(const std::string path, const std::string local_path):
+        base_socket(AF_UNIX, SOCK_DGRAM, 0), _local_path(local_path) {
+        bind_local(local_path); //unlike udp a local datagram socket has no address to be answered at until it binds one
+        connect_local(path);
+    }
+
+    std::string unix_datagram_client_socket::read(const int flags) const {
+        return base_socket::read(flags);
+    }
+
+    long unix_datagram_client_socket::write(const std::string& buffer, const int flags) const {
+        return base_socket::write(buffer, flags);
+    }
+
+    long unix_datagram_client_socket::gather_write(const std::vector<std::string_view>& buffers, const int flags) const {
+        return base_socket::gather_write(buffers, flags);
+    }
+
+    long unix_datagram_client_socket::read_some(char* buffer, const size_t size, const int flags) const {
+        return base_socket::read_some(buffer, size, flags);
+    }
+
+    long unix_datagram_client_socket::write_fds(const std::string& buffer, const std::vector<int>& fds, const int flags) const {
+        return base_socket::write_fds(buffer, fds, flags);
+    }
+
+    unsigned int unix_datagram_client_socket::sockfd() const {
+        return base_socket::sockfd();
+    }
+
+    unix_datagram_client_socket::~multi_socket() {
+        if(!_local_path.empty() && _local_path.front() != ABSTRACT_PREFIX) {
+            unlink(_local_path.c_str());
+        }
+    }
+
+#endif // __linux__
+
 }
@@ -41,10 +41,26 @@ namespace net {
     //udp sockets
     using udp_server_socket = multi_socket<net::protocol_t::UDP, net::role_t::server, net::family_t::IPv4, net::socket_t::DGRAM>;
     using udp_client_socket = multi_socket<net::protocol_t::UDP, net::role_t::client, net::family_t::IPv4, net::socket_t::DGRAM>;
+    //udp multicast sockets
+    using udp_publisher_socket = multi_socket<net::protocol_t::UDP, net::role_t::publisher, net::family_t::IPv4, net::socket_t::DGRAM>;
+    using udp_subscriber_socket = multi_socket<net::protocol_t::UDP, net::role_t::subscriber, net::family_t::IPv4, net::socket_t::DGRAM>;
     //tcp sockets
     using tcp_server_socket = multi_socket<net::protocol_t::TCP, net::role_t::server, net::family_t::IPv4, net::socket_t::STREAM>;
     using tcp_active_socket = multi_socket<net::protocol_t::TCP, net::role_t::active, net::family_t::IPv4, net::socket_t::STREAM>;
     using tcp_client_socket = multi_socket<net::protocol_t::TCP, net::role_t::client, net::family_t::IPv4, net::socket_t::STREAM>;
+#ifdef __linux__
+    //local (AF_UNIX) stream sockets
+    using unix_server_socket = multi_socket<net::protocol_t::ANY, net::role_t::server, net::family_t::Unix, net::socket_t::STREAM>;
+    using unix_active_socket = multi_socket<net::protocol_t::ANY, net::role_t::active, net::family_t::Unix, net::socket_t::STREAM>;
+    using unix_client_socket = multi_socket<net::protocol_t::ANY, net::role_t::client, net::family_t::Unix, net::socket_t::STREAM>;
+    //local (AF_UNIX) sequenced packet sockets, connected like stream but message boundaries are kept
+    using seqpacket_server_socket = multi_socket<net::protocol_t::ANY, net::role_t::server, net::family_t::Unix, net::socket_t::SEQPACKET>;
+    using seqpacket_active_socket = multi_socket<net::protocol_t::ANY, net::role_t::active, net::family_t::Unix, net::socket_t::SEQPACKET>;
+    using seqpacket_client_socket = multi_socket<net::protocol_t::ANY, net::role_t::client, net::family_t::Unix, net::socket_t::SEQPACKET>;
+    //local (AF_UNIX) datagram sockets
+    using unix_datagram_server_socket = multi_socket<net::protocol_t::ANY, net::role_t::server, net::family_t::Unix, net::socket_t::DGRAM>;
+    using unix_datagram_client_socket = multi_socket<net::protocol_t::ANY, net::role_t::client, net::family_t::Unix, net::socket_t::DGRAM>;
+#endif
 
     //------------udp_server_socket template------------
     template<>
@@ -53,10 +69,30 @@ namespace net {
 
         multi_socket(const std::string addr, const unsigned short port);
 
+        multi_socket (multi_socket&&) = default;
+
+        multi_socket& operator= (multi_socket&&) = default;
+
         std::string read_from(const int flags = 0) override final;
 
         long write_back(const std::string& buffer, const int flags = 0) override final;
 
+        size_t read_batch(std::vector<std::string>& messages, const size_t max_messages, const size_t max_size = DEFAULT_BUFFER_SIZE, const int flags = 0) override final;
+
+        void gro(const bool enable) override final;
+
+        size_t read_segments(std::string& buffer, std::vector<std::string_view>& segments, const int flags = 0) override final;
+
+        bool busy_poll(const std::chrono::microseconds spin_budget) override final;
+
+        std::string read_from(rx_timestamp_t& stamp, const int flags = 0) override final;
+
+        bool timestamps(const timestamp_t mode) override final;
+
+        long read_some_from(char* buffer, const size_t size, const int flags = 0) override final;
+
+        unsigned int sockfd() const override final;
+
         virtual ~multi_socket() override = default;
 
     };
@@ -68,14 +104,81 @@ namespace net {
 
         multi_socket(const std::string addr, const unsigned short port);
 
+        multi_socket (multi_socket&&) = default;
+
+        multi_socket& operator= (multi_socket&&) = default;
+
         std::string read(const int flags = 0) const override final;
 
         long write(const std::string& buffer, const int flags = 0) const override final;
 
+        long gather_write(const std::vector<std::string_view>& buffers, const int flags = 0) const override final;
+
+        long read_some(char* buffer, const size_t size, const int flags = 0) const override final;
+
+        long write_segmented(std::string_view buffer, const size_t segment_size, const int flags = 0) const override final;
+
+        unsigned int sockfd() const override final;
+
         virtual ~multi_socket() override = default;
 
     };
 
+    //------------udp_publisher_socket template------------
+    template<>
+    struct multi_socket<net::protocol_t::UDP, net::role_t::publisher, net::family_t::IPv4, net::socket_t::DGRAM>:
+        private base_socket {
+
+        /**
+         * @brief multi_socket - a sender of datagrams to a multicast group
+         * @param group - text format multicast address
+         * @param port - port the subscribers are bound to
+         * @param ttl - router hops the datagrams may cross
+         * @param interface_addr - local interface to send from, ANY_ADDR lets the kernel choose by routing table
+         */
+        multi_socket(const std::string group, const unsigned short port, const int ttl = MULTICAST_TTL, const std::string interface_addr = ANY_ADDR);
+
+        long write(const std::string& buffer, const int flags = 0) const override final;
+
+        long gather_write(const std::vector<std::string_view>& buffers, const int flags = 0) const override final;
+
+        void multicast_ttl(const int ttl) override final;
+
+        void multicast_loopback(const bool enable) override final;
+
+        void multicast_interface(const std::string& interface_addr) override final;
+
+        unsigned int sockfd() const override final;
+
+        virtual ~multi_socket() override = default;
+    };
+
+    //------------udp_subscriber_socket template------------
+    template<>
+    struct multi_socket<net::protocol_t::UDP, net::role_t::subscriber, net::family_t::IPv4, net::socket_t::DGRAM>:
+        private base_socket {
+
+        /**
+         * @brief multi_socket - a receiver of the datagrams sent to a multicast group, several may share a group and port on one host
+         * @param group - text format multicast address
+         * @param port - port the publisher sends to
+         * @param interface_addr - local interface to join on, ANY_ADDR lets the kernel choose by routing table
+         */
+        multi_socket(const std::string group, const unsigned short port, const std::string interface_addr = ANY_ADDR);
+
+        std::string read_from(const int flags = 0) override final;
+
+        size_t read_batch(std::vector<std::string>& messages, const size_t max_messages, const size_t max_size = DEFAULT_BUFFER_SIZE, const int flags = 0) override final;
+
+        void join_group(const std::string& group, const std::string& interface_addr = ANY_ADDR) override final;
+
+        void leave_group(const std::string& group, const std::string& interface_addr = ANY_ADDR) override final;
+
+        unsigned int sockfd() const override final;
+
+        virtual ~multi_socket() override = default;
+    };
+
     //------------tcp_active_socket template------------
     template<>
     struct multi_socket<net::protocol_t::TCP, net::role_t::active, net::family_t::IPv4, net::socket_t::STREAM>:
@@ -83,14 +186,32 @@ namespace net {
 
         explicit multi_socket(unsigned int socket);
 
-        multi_socket (const multi_socket&) = default;
+        multi_socket (multi_socket&&) = default;
 
-        multi_socket& operator= (const multi_socket&) = default;
+        multi_socket& operator= (multi_socket&&) = default;
 
         std::string read(const int flags = 0) const override final;
 
         long write(const std::string& buffer, const int flags = 0) const override final;
 
+        long gather_write(const std::vector<std::string_view>& buffers, const int flags = 0) const override final;
+
+        long read_some(char* buffer, const size_t size, const int flags = 0) const override final;
+
+        bool is_alive() const override final;
+
+        void keep_alive(const bool enable) override final;
+
+        void stop(action_t action) override final;
+
+        bool busy_poll(const std::chrono::microseconds spin_budget) override final;
+
+        std::string read(rx_timestamp_t& stamp, const int flags = 0) const override final;
+
+        bool timestamps(const timestamp_t mode) override final;
+
+        unsigned int sockfd() const override final;
+
         virtual ~multi_socket() override = default;
     };
 
@@ -99,12 +220,45 @@ namespace net {
     struct multi_socket<net::protocol_t::TCP, net::role_t::server, net::family_t::IPv4, net::socket_t::STREAM>:
         private base_socket {
 
-        multi_socket(const std::string addr, const unsigned short port);
+        /**
+         * @brief multi_socket - bind and listen
+         * @param backlog - connections the kernel queues until they are accepted, capped at net.core.somaxconn
+         */
+        multi_socket(const std::string addr, const unsigned short port, const int backlog = SOMAXCONN);
+
+        /**
+         * @brief multi_socket - adopt a listening socket, e.g. one inherited from the previous process by take_over
+         */
+        explicit multi_socket(unsigned int socket);
+
+        multi_socket (multi_socket&&) = default;
+
+        multi_socket& operator= (multi_socket&&) = default;
+
+        /**
+         * @brief take_over - wait at a local path for the listener the running process hands over, then accept on it alongside that process
+         */
+        static multi_socket take_over(const std::string& path);
 
         tcp_active_socket accept_and_create_socket();
 
+        /**
+         * @brief accept_and_create_socket - accept4 with SOCK_NONBLOCK, SOCK_CLOEXEC or both set on the new socket
+         */
+        tcp_active_socket accept_and_create_socket(const int flags);
+
+        size_t accept_batch(std::vector<unsigned int>& sockfds, const size_t max_sockets = MAX_BATCH, const int flags = SOCK_NONBLOCK | SOCK_CLOEXEC) override final;
+
         void stop(action_t action) override final;
 
+        void hand_over(const std::string& path) override final;
+
+        void fast_open(const int queue_length) override final;
+
+        void defer_accept(const std::chrono::seconds timeout) override final;
+
+        unsigned int sockfd() const override final;
+
         virtual ~multi_socket() override = default;
     };
 
@@ -115,14 +269,282 @@ namespace net {
 
         multi_socket(const std::string addr, const unsigned short port);
 
+        /**
+         * @brief multi_socket - connect giving up with ETIMEDOUT after timeout rather than blocking for the kernel SYN retries
+         */
+        multi_socket(const std::string addr, const unsigned short port, const std::chrono::milliseconds timeout);
+
+        /**
+         * @brief multi_socket - connect sending first_message with the SYN when the server's Fast Open cookie is cached, else right after the handshake
+         */
+        multi_socket(const std::string addr, const unsigned short port, const std::string first_message);
+
+        /**
+         * @brief multi_socket - race connections to the candidates (e.g. replicas), starting one every stagger, and keep the first to connect
+         */
+        multi_socket(const std::vector<endpoint_t>& candidates, const std::chrono::milliseconds timeout,
+                     const std::chrono::milliseconds stagger = CONNECTION_ATTEMPT_DELAY);
+
+        multi_socket (multi_socket&&) = default;
+
+        multi_socket& operator= (multi_socket&&) = default;
+
         std::string read(const int flags = 0) const override final;
 
         long write(const std::string& buffer, const int flags = 0) const override final;
 
+        long gather_write(const std::vector<std::string_view>& buffers, const int flags = 0) const override final;
+
+        long read_some(char* buffer, const size_t size, const int flags = 0) const override final;
+
+        bool is_alive() const override final;
+
+        void keep_alive(const bool enable) override final;
+
+        void stop(action_t action) override final;
+
+        std::string read(rx_timestamp_t& stamp, const int flags = 0) const override final;
+
+        bool timestamps(const timestamp_t mode) override final;
+
+        unsigned int sockfd() const override final;
+
         virtual ~multi_socket() override = default;
 
     };
 
+#ifdef __linux__
+
+    //------------unix_active_socket template------------
+    template<>
+    struct multi_socket<net::protocol_t::ANY, net::role_t::active, net::family_t::Unix, net::socket_t::STREAM>:
+        private base_socket {
+
+        explicit multi_socket(unsigned int socket);
+
+        multi_socket (multi_socket&&) = default;
+
+        multi_socket& operator= (multi_socket&&) = default;
+
+        std::string read(const int flags = 0) const override final;
+
+        long write(const std::string& buffer, const int flags = 0) const override final;
+
+        long gather_write(const std::vector<std::string_view>& buffers, const int flags = 0) const override final;
+
+        long read_some(char* buffer, const size_t size, const int flags = 0) const override final;
+
+        long write_fds(const std::string& buffer, const std::vector<int>& fds, const int flags = 0) const override final;
+
+        std::string read_fds(std::vector<int>& fds, const int flags = 0) const override final;
+
+        bool is_alive() const override final;
+
+        void stop(action_t action) override final;
+
+        unsigned int sockfd() const override final;
+
+        virtual ~multi_socket() override = default;
+    };
+
+    //------------unix_server_socket template------------
+    template<>
+    struct multi_socket<net::protocol_t::ANY, net::role_t::server, net::family_t::Unix, net::socket_t::STREAM>:
+        private base_socket {
+
+        /**
+         * @brief multi_socket - bind and listen at path, "@name" for the abstract namespace, a file path is unlinked first and again on destruction
+         */
+        explicit multi_socket(const std::string path);
+
+        unix_active_socket accept_and_create_socket();
+
+        void stop(action_t action) override final;
+
+        unsigned int sockfd() const override final;
+
+        virtual ~multi_socket() override;
+
+    private:
+
+        const std::string _path;
+
+    };
+
+    //------------unix_client_socket template------------
+    template<>
+    struct multi_socket<net::protocol_t::ANY, net::role_t::client, net::family_t::Unix, net::socket_t::STREAM>:
+        private base_socket {
+
+        explicit multi_socket(const std::string path);
+
+        std::string read(const int flags = 0) const override final;
+
+        long write(const std::string& buffer, const int flags = 0) const override final;
+
+        long gather_write(const std::vector<std::string_view>& buffers, const int flags = 0) const override final;
+
+        long read_some(char* buffer, const size_t size, const int flags = 0) const override final;
+
+        long write_fds(const std::string& buffer, const std::vector<int>& fds, const int flags = 0) const override final;
+
+        std::string read_fds(std::vector<int>& fds, const int flags = 0) const override final;
+
+        bool is_alive() const override final;
+
+        void stop(action_t action) override final;
+
+        unsigned int sockfd() const override final;
+
+        virtual ~multi_socket() override = default;
+
+    };
+
+    //------------seqpacket_active_socket template------------
+    template<>
+    struct multi_socket<net::protocol_t::ANY, net::role_t::active, net::family_t::Unix, net::socket_t::SEQPACKET>:
+        private base_socket {
+
+        explicit multi_socket(unsigned int socket);
+
+        multi_socket (multi_socket&&) = default;
+
+        multi_socket& operator= (multi_socket&&) = default;
+
+        std::string read(const int flags = 0) const override final;
+
+        long write(const std::string& buffer, const int flags = 0) const override final;
+
+        long gather_write(const std::vector<std::string_view>& buffers, const int flags = 0) const override final;
+
+        long read_some(char* buffer, const size_t size, const int flags = 0) const override final;
+
+        long write_fds(const std::string& buffer, const std::vector<int>& fds, const int flags = 0) const override final;
+
+        std::string read_fds(std::vector<int>& fds, const int flags = 0) const override final;
+
+        bool is_alive() const override final;
+
+        void stop(action_t action) override final;
+
+        unsigned int sockfd() const override final;
+
+        virtual ~multi_socket() override = default;
+    };
+
+    //------------seqpacket_server_socket template------------
+    template<>
+    struct multi_socket<net::protocol_t::ANY, net::role_t::server, net::family_t::Unix, net::socket_t::SEQPACKET>:
+        private base_socket {
+
+        /**
+         * @brief multi_socket - bind and listen at path, "@name" for the abstract namespace, a file path is unlinked first and again on destruction
+         */
+        explicit multi_socket(const std::string path);
+
+        seqpacket_active_socket accept_and_create_socket();
+
+        void stop(action_t action) override final;
+
+        unsigned int sockfd() const override final;
+
+        virtual ~multi_socket() override;
+
+    private:
+
+        const std::string _path;
+
+    };
+
+    //------------seqpacket_client_socket template------------
+    template<>
+    struct multi_socket<net::protocol_t::ANY, net::role_t::client, net::family_t::Unix, net::socket_t::SEQPACKET>:
+        private base_socket {
+
+        explicit multi_socket(const std::string path);
+
+        std::string read(const int flags = 0) const override final;
+
+        long write(const std::string& buffer, const int flags = 0) const override final;
+
+        long gather_write(const std::vector<std::string_view>& buffers, const int flags = 0) const override final;
+
+        long read_some(char* buffer, const size_t size, const int flags = 0) const override final;
+
+        long write_fds(const std::string& buffer, const std::vector<int>& fds, const int flags = 0) const override final;
+
+        std::string read_fds(std::vector<int>& fds, const int flags = 0) const override final;
+
+        bool is_alive() const override final;
+
+        void stop(action_t action) override final;
+
+        unsigned int sockfd() const override final;
+
+        virtual ~multi_socket() override = default;
+
+    };
+
+    //------------unix_datagram_server_socket template------------
+    template<>
+    struct multi_socket<net::protocol_t::ANY, net::role_t::server, net::family_t::Unix, net::socket_t::DGRAM>:
+        private base_socket {
+
+        /**
+         * @brief multi_socket - bind at path, "@name" for the abstract namespace, a file path is unlinked first and again on destruction
+         */
+        explicit multi_socket(const std::string path);
+
+        std::string read_from(const int flags = 0) override final;
+
+        long write_back(const std::string& buffer, const int flags = 0) override final;
+
+        size_t read_batch(std::vector<std::string>& messages, const size_t max_messages, const size_t max_size = DEFAULT_BUFFER_SIZE, const int flags = 0) override final;
+
+        std::string read_fds(std::vector<int>& fds, const int flags = 0) const override final;
+
+        unsigned int sockfd() const override final;
+
+        virtual ~multi_socket() override;
+
+    private:
+
+        const std::string _path;
+
+    };
+
+    //------------unix_datagram_client_socket template------------
+    template<>
+    struct multi_socket<net::protocol_t::ANY, net::role_t::client, net::family_t::Unix, net::socket_t::DGRAM>:
+        private base_socket {
+
+        /**
+         * @brief multi_socket - connect to the server at path, binding local_path (an autobound abstract name when empty) so replies can come back
+         */
+        explicit multi_socket(const std::string path, const std::string local_path = std::string());
+
+        std::string read(const int flags = 0) const override final;
+
+        long write(const std::string& buffer, const int flags = 0) const override final;
+
+        long gather_write(const std::vector<std::string_view>& buffers, const int flags = 0) const override final;
+
+        long read_some(char* buffer, const size_t size, const int flags = 0) const override final;
+
+        long write_fds(const std::string& buffer, const std::vector<int>& fds, const int flags = 0) const override final;
+
+        unsigned int sockfd() const override final;
+
+        virtual ~multi_socket() override;
+
+    private:
+
+        const std::string _local_path;
+
+    };
+
+#endif // __linux__
+
 }
 
 #endif // SOCKET_FACTORY_NEW_H
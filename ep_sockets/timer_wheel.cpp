@@ -0,0 +1,205 @@
+#include "timer_wheel.h"
+
+namespace net {
+
+    //------------timer implementation------------
+    timer_wheel::timer::timer(std::function<void()> on_expiry): _callback(std::move(on_expiry)) {}
+
+    void timer_wheel::timer::on_expiry(std::function<void()> callback) {
+        _callback = std::move(callback);
+    }
+
+    bool timer_wheel::timer::is_armed() const {
+        return _wheel != nullptr;
+    }
+
+    timer_wheel::timer::~timer() {
+        if(_destroyed) {
+            *_destroyed = true;
+        }
+        if(_wheel) {
+            _wheel->cancel(*this);
+        }
+    }
+
+    //------------timer_wheel implementation------------
+    timer_wheel::timer_wheel(const std::chrono::milliseconds resolution, const steady_t::time_point start):
+        _resolution(std::max(resolution, std::chrono::milliseconds(1))), _start(start) {}
+
+    void timer_wheel::arm(timer& t, const std::chrono::milliseconds delay, const steady_t::time_point now) {
+        if(t._wheel) {
+            t._wheel->cancel(t);
+        }
+        //the first tick starting at or after now + delay, so a timer never fires early
+        auto due = std::max(now + delay - _start, steady_t::duration::zero());
+        auto resolution = std::chrono::duration_cast<steady_t::duration>(_resolution);
+        t._expiry = static_cast<uint64_t>((due + resolution - steady_t::duration(1)) / resolution);
+        t._wheel = this;
+        ++_size;
+        _insert(&t);
+    }
+
+    void timer_wheel::cancel(timer& t) {
+        if(t._wheel == this) {
+            _unlink(&t);
+            t._wheel = nullptr;
+            --_size;
+        }
+    }
+
+    size_t timer_wheel::advance(const steady_t::time_point now) {
+        auto target = _tick_of(now);
+        size_t fired = 0;
+        while(_current <= target) {
+            if(_size == 0) { //nothing armed, jump straight to now
+                _current = target + 1;
+                break;
+            }
+            auto index = _current & SLOT_MASK;
+            if(index == 0 && _cascade(1, (_current >> LEVEL_BITS) & SLOT_MASK) == 0 &&
+                    _cascade(2, (_current >> (2 * LEVEL_BITS)) & SLOT_MASK) == 0) {
+                _cascade(3, (_current >> (3 * LEVEL_BITS)) & SLOT_MASK);
+            }
+            //detach the due slot so callbacks arming or cancelling timers never disturb the walk
+            link_t expired;
+            auto& slot = _slots[0][index];
+            if(slot.next != &slot) {
+                expired.next = slot.next;
+                expired.prev = slot.prev;
+                expired.next->prev = &expired;
+                expired.prev->next = &expired;
+                slot.next = slot.prev = &slot;
+            }
+            ++_current;
+            while(expired.next != &expired) {
+                auto t = static_cast<timer*>(expired.next);
+                _unlink(t);
+                t->_wheel = nullptr;
+                --_size;
+                ++fired;
+                if(t->_callback) { //run from a local so a callback destroying its own timer survives its own call
+                    std::function<void()> callback;
+                    callback.swap(t->_callback);
+                    auto destroyed = false;
+                    t->_destroyed = &destroyed;
+                    callback();
+                    if(!destroyed) {
+                        t->_destroyed = nullptr;
+                        if(!t->_callback) { //unless on_expiry replaced it meanwhile
+                            t->_callback = std::move(callback);
+                        }
+                    }
+                }
+            }
+        }
+        return fired;
+    }
+
+    std::chrono::milliseconds timer_wheel::until_next(const steady_t::time_point now) const {
+        if(_size == 0) {
+            return std::chrono::milliseconds(-1);
+        }
+        auto wake = (_current | SLOT_MASK) + 1; //the next cascade
+        for(uint64_t tick = _current; tick < wake; ++tick) {
+            auto& slot = _slots[0][tick & SLOT_MASK];
+            if(slot.next != &slot) {
+                wake = tick;
+                break;
+            }
+        }
+        auto at = _start + std::chrono::milliseconds(static_cast<int64_t>(wake) * _resolution.count());
+        if(at <= now) {
+            return std::chrono::milliseconds(0);
+        }
+        return std::chrono::duration_cast<std::chrono::milliseconds>(at - now + std::chrono::milliseconds(1) - steady_t::duration(1));
+    }
+
+    size_t timer_wheel::size() const {
+        return _size;
+    }
+
+    timer_wheel::~timer_wheel() {
+        for(auto& level: _slots) { //orphan anything still armed so its destructor leaves this wheel alone
+            for(auto& slot: level) {
+                while(slot.next != &slot) {
+                    auto t = static_cast<timer*>(slot.next);
+                    _unlink(t);
+                    t->_wheel = nullptr;
+                }
+            }
+        }
+    }
+
+    void timer_wheel::_unlink(link_t* node) {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        node->prev = node->next = node;
+    }
+
+    void timer_wheel::_push_back(link_t& head, link_t* node) {
+        node->prev = head.prev;
+        node->next = &head;
+        head.prev->next = node;
+        head.prev = node;
+    }
+
+    uint64_t timer_wheel::_tick_of(const steady_t::time_point t) const {
+        if(t <= _start) {
+            return 0;
+        }
+        return static_cast<uint64_t>((t - _start) / _resolution);
+    }
+
+    void timer_wheel::_insert(timer* t) {
+        auto expiry = std::max(t->_expiry, _current); //already due - fire on the next tick processed
+        auto delta = expiry - _current;
+        int level = 0;
+        while(level < LEVELS - 1 && delta >= (1ull << (LEVEL_BITS * (level + 1)))) {
+            ++level;
+        }
+        if(level == LEVELS - 1 && delta > 0xFFFFFFFFull) { //beyond the wheel - park in the furthest slot, it cascades back round
+            expiry = _current + 0xFFFFFFFFull;
+        }
+        _push_back(_slots[static_cast<size_t>(level)][(expiry >> (LEVEL_BITS * level)) & SLOT_MASK], t);
+    }
+
+    uint64_t timer_wheel::_cascade(int level, uint64_t index) {
+        link_t moving;
+        auto& slot = _slots[static_cast<size_t>(level)][index];
+        if(slot.next != &slot) {
+            moving.next = slot.next;
+            moving.prev = slot.prev;
+            moving.next->prev = &moving;
+            moving.prev->next = &moving;
+            slot.next = slot.prev = &slot;
+        }
+        while(moving.next != &moving) {
+            auto t = static_cast<timer*>(moving.next);
+            _unlink(t);
+            _insert(t);
+        }
+        return index;
+    }
+
+    //------------connection_deadlines implementation------------
+    connection_deadlines::connection_deadlines(timer_wheel& wheel, expiry_handler_t on_expiry): _wheel(wheel) {
+        for(size_t i = 0; i < _timers.size(); ++i) {
+            _timers[i].on_expiry([on_expiry, i]() {
+                on_expiry(static_cast<deadline_t>(i));
+            });
+        }
+    }
+
+    void connection_deadlines::arm(const deadline_t deadline, const std::chrono::milliseconds timeout) {
+        _wheel.arm(_timers[static_cast<size_t>(deadline)], timeout);
+    }
+
+    void connection_deadlines::cancel(const deadline_t deadline) {
+        _wheel.cancel(_timers[static_cast<size_t>(deadline)]);
+    }
+
+    bool connection_deadlines::is_armed(const deadline_t deadline) const {
+        return _timers[static_cast<size_t>(deadline)].is_armed();
+    }
+
+}
@@ -0,0 +1,198 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+#include "socket_constants.h"
+
+namespace net {
+
+    /**
+     * @brief The timer_wheel class is a hierarchical timing wheel (Varghese & Lauck) for very many cheap deadlines.
+     * @version 0.5
+     * Four levels of 256 slots at a configurable tick resolution cover 2^32 ticks, a timer is kept in an intrusive
+     * doubly linked slot list so arm, rearm and cancel are all O(1) and need no allocation. Timers far in the future sit
+     * in the coarser levels and cascade down as the wheel turns, each at most three times.
+     * Timers never fire early and fire at most one tick late.
+     * @note not thread safe, a wheel and its timers belong to one thread - normally an event_loop's.
+     */
+    class timer_wheel {
+
+        static const int LEVEL_BITS = 8;
+        static const int LEVELS = 4;
+        static const uint64_t SLOTS = 1 << LEVEL_BITS;
+        static const uint64_t SLOT_MASK = SLOTS - 1;
+
+        struct link_t {
+            link_t* prev = this;
+            link_t* next = this;
+        };
+
+    public:
+
+        using steady_t = std::chrono::steady_clock;
+
+        /**
+         * @brief The timer class is a deadline that runs its callback on expiry, it cancels itself when destroyed.
+         */
+        class timer: private link_t {
+
+            friend class timer_wheel;
+
+        public:
+
+            explicit timer(std::function<void()> on_expiry = nullptr);
+
+            timer(const timer&) = delete;
+
+            timer& operator= (const timer&) = delete;
+
+            /**
+             * @brief on_expiry - replace the callback run when this timer expires
+             */
+            void on_expiry(std::function<void()> callback);
+
+            bool is_armed() const;
+
+            ~timer();
+
+        private:
+
+            std::function<void()> _callback;
+            timer_wheel* _wheel = nullptr; //set while armed
+            uint64_t _expiry = 0; //in ticks
+            bool* _destroyed = nullptr; //set while the callback runs, tells advance the timer went with it
+
+        };
+
+        /**
+         * @brief timer_wheel
+         * @param resolution - length of a tick, the granularity of every deadline
+         * @param start - time of tick zero
+         */
+        explicit timer_wheel(const std::chrono::milliseconds resolution = std::chrono::milliseconds(1), const steady_t::time_point start = steady_t::now());
+
+        timer_wheel(const timer_wheel&) = delete;
+
+        timer_wheel& operator= (const timer_wheel&) = delete;
+
+        /**
+         * @brief arm - (re)arm a timer to expire delay from now, an already armed timer is moved in O(1)
+         */
+        void arm(timer& t, const std::chrono::milliseconds delay, const steady_t::time_point now = steady_t::now());
+
+        /**
+         * @brief cancel - disarm a timer, cancelling an unarmed timer does nothing
+         */
+        void cancel(timer& t);
+
+        /**
+         * @brief advance - turn the wheel up to now running the callbacks of every expired timer
+         * @note callbacks may arm, cancel or destroy any timer, including the one that is running
+         * @return size_t - the number of timers that expired
+         */
+        size_t advance(const steady_t::time_point now = steady_t::now());
+
+        /**
+         * @brief until_next - how long a poller may sleep before advance has work to do, either the next occupied
+         * slot on the finest level or the next cascade, whichever is sooner
+         * @return milliseconds - or -1 when no timers are armed
+         */
+        std::chrono::milliseconds until_next(const steady_t::time_point now = steady_t::now()) const;
+
+        /**
+         * @brief size - number of armed timers
+         */
+        size_t size() const;
+
+        ~timer_wheel();
+
+    private:
+
+        static void _unlink(link_t* node);
+
+        static void _push_back(link_t& head, link_t* node);
+
+        uint64_t _tick_of(const steady_t::time_point t) const;
+
+        /**
+         * @brief _insert - place an unlinked timer in the slot for its expiry relative to the current tick
+         */
+        void _insert(timer* t);
+
+        /**
+         * @brief _cascade - re-insert every timer of one slot of a coarser level into the finer levels
+         * @return the slot index, 0 means the next level up must cascade too
+         */
+        uint64_t _cascade(int level, uint64_t index);
+
+        std::chrono::milliseconds _resolution;
+        steady_t::time_point _start;
+        uint64_t _current = 0; //next tick to be processed
+        size_t _size = 0;
+        std::array<std::array<link_t, SLOTS>, LEVELS> _slots;
+
+    };
+
+    /**
+     * @brief deadline_t - the per-connection deadlines connection_deadlines keeps
+     */
+    enum class deadline_t {IDLE, READ, WRITE, KEEP_ALIVE};
+
+    /**
+     * @brief The connection_deadlines class bundles a connection's idle, read, write and keep-alive timers on one wheel.
+     * Rearm a deadline whenever the matching activity happens, e.g. IDLE on every read or write.
+     */
+    class connection_deadlines {
+
+    public:
+
+        using expiry_handler_t = std::function<void(deadline_t)>;
+
+        /**
+         * @brief connection_deadlines
+         * @param wheel - the wheel the timers run on
+         * @param on_expiry - called with the deadline that passed, it may destroy this object, e.g. by erasing the connection
+         */
+        connection_deadlines(timer_wheel& wheel, expiry_handler_t on_expiry);
+
+        /**
+         * @brief connection_deadlines - by default an expired connection is shut down in both directions, that wakes
+         * a read blocked on another thread and makes an event loop report the socket readable so its handler sees the close
+         * @param wheel - the wheel the timers run on
+         * @param socket - any multi_socket product with stop()
+         */
+        template<typename S>
+        connection_deadlines(timer_wheel& wheel, S& socket):
+            connection_deadlines(wheel, [&socket](deadline_t) {
+                try {
+                    socket.stop(action_t::READ_AND_WRITE);
+                } catch (std::exception&) {} //already disconnected
+            }) {}
+
+        connection_deadlines(const connection_deadlines&) = delete;
+
+        connection_deadlines& operator= (const connection_deadlines&) = delete;
+
+        /**
+         * @brief arm - (re)start a deadline timeout from now
+         */
+        void arm(const deadline_t deadline, const std::chrono::milliseconds timeout);
+
+        void cancel(const deadline_t deadline);
+
+        bool is_armed(const deadline_t deadline) const;
+
+    private:
+
+        timer_wheel& _wheel;
+        std::array<timer_wheel::timer, 4> _timers;
+
+    };
+
+}
+
+#endif // TIMER_WHEEL_H
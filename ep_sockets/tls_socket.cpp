@@ -0,0 +1,211 @@
+#include "tls_socket.h"
+
+#if defined(__linux__) && defined(EP_SOCKETS_TLS)
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#include "openssl/err.h"
+#include "openssl/ssl.h"
+#include "sys/socket.h"
+#include "unistd.h"
+
+namespace net {
+
+    namespace {
+
+        //the OpenSSL error queue's oldest entry, or the system error behind a failed call, after what went wrong
+        std::string tls_error(const std::string& what) {
+            auto code = ERR_get_error();
+            ERR_clear_error();
+            if(code == 0) {
+                return what + (errno ? std::strerror(errno) : "connection closed");
+            }
+            std::array<char, 256> text;
+            ERR_error_string_n(code, text.data(), text.size());
+            return what + text.data();
+        }
+
+    }
+
+    //------------tls_context implementation------------
+    tls_context::tls_context(const tls_role_t role, const tls_options_t& options): _role(role) {
+        _ctx = SSL_CTX_new(role == tls_role_t::client ? TLS_client_method() : TLS_server_method());
+        if(!_ctx) {
+            throw std::runtime_error(tls_error(EMSG_TLS_CONTEXT));
+        }
+        try {
+            SSL_CTX_set_min_proto_version(_ctx, TLS1_2_VERSION);
+            //write retries may pass the same data from a moved buffer, and a blocking read never fails on a renegotiation
+            SSL_CTX_set_mode(_ctx, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER | SSL_MODE_AUTO_RETRY);
+            if(options.ktls) {
+                SSL_CTX_set_options(_ctx, SSL_OP_ENABLE_KTLS);
+            }
+            if(!options.certificate_file.empty()) {
+                if(SSL_CTX_use_certificate_chain_file(_ctx, options.certificate_file.c_str()) != 1 ||
+                   SSL_CTX_use_PrivateKey_file(_ctx, options.private_key_file.c_str(), SSL_FILETYPE_PEM) != 1 ||
+                   SSL_CTX_check_private_key(_ctx) != 1) {
+                    throw std::runtime_error(tls_error(EMSG_TLS_CONTEXT));
+                }
+            }
+            auto verify = role == tls_role_t::client ? options.verify_server : options.require_client_certificate;
+            if(verify) {
+                auto trusted = options.ca_file.empty() ? SSL_CTX_set_default_verify_paths(_ctx)
+                                                       : SSL_CTX_load_verify_locations(_ctx, options.ca_file.c_str(), nullptr);
+                if(trusted != 1) {
+                    throw std::runtime_error(tls_error(EMSG_TLS_CONTEXT));
+                }
+                SSL_CTX_set_verify(_ctx, role == tls_role_t::client ? SSL_VERIFY_PEER : SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT, nullptr);
+            }
+        } catch (...) {
+            SSL_CTX_free(_ctx);
+            throw;
+        }
+    }
+
+    tls_role_t tls_context::role() const {
+        return _role;
+    }
+
+    ssl_ctx_st* tls_context::native() const {
+        return _ctx;
+    }
+
+    tls_context::~tls_context() {
+        SSL_CTX_free(_ctx);
+    }
+
+    //------------tls_session implementation------------
+    tls_session::tls_session(tls_context& context, const unsigned int sockfd, const std::string& server_name) {
+        _ssl = SSL_new(context.native());
+        if(!_ssl || SSL_set_fd(_ssl, static_cast<int>(sockfd)) != 1) {
+            SSL_free(_ssl);
+            throw std::runtime_error(tls_error(EMSG_TLS_HANDSHAKE));
+        }
+        auto verify = context.role() == tls_role_t::client && (SSL_get_verify_mode(_ssl) & SSL_VERIFY_PEER);
+        if(verify && server_name.empty()) { //a valid chain for any name at all would pass
+            SSL_free(_ssl);
+            throw std::runtime_error(EMSG_TLS_HANDSHAKE + "a verifying client needs the server_name to check the certificate against");
+        }
+        if(context.role() == tls_role_t::client && !server_name.empty() &&
+                (SSL_set_tlsext_host_name(_ssl, server_name.c_str()) != 1 || //SNI
+                 (verify && SSL_set1_host(_ssl, server_name.c_str()) != 1))) { //and the certificate must be for it
+            auto message = tls_error(EMSG_TLS_HANDSHAKE);
+            SSL_free(_ssl);
+            throw std::runtime_error(message);
+        }
+        errno = 0;
+        auto i = context.role() == tls_role_t::client ? SSL_connect(_ssl) : SSL_accept(_ssl);
+        if(i != 1) {
+            auto message = tls_error(EMSG_TLS_HANDSHAKE);
+            SSL_free(_ssl);
+            throw std::runtime_error(message);
+        }
+    }
+
+    tls_session::tls_session(tls_session&& other) noexcept: _ssl(other._ssl) {
+        other._ssl = nullptr;
+    }
+
+    tls_session& tls_session::operator=(tls_session&& other) noexcept {
+        if(this != &other) {
+            SSL_free(_ssl);
+            _ssl = other._ssl;
+            other._ssl = nullptr;
+        }
+        return *this;
+    }
+
+    long tls_session::read_some(char* buffer, const size_t size, const int flags) {
+        size_t n = 0;
+        errno = 0;
+        auto i = (flags & MSG_PEEK) ? SSL_peek_ex(_ssl, buffer, size, &n) : SSL_read_ex(_ssl, buffer, size, &n);
+        if(i == 1) {
+            return static_cast<long>(n);
+        }
+        switch(SSL_get_error(_ssl, i)) {
+        case SSL_ERROR_WANT_READ:
+        case SSL_ERROR_WANT_WRITE:
+            return -1; //non blocking and a whole record has not arrived yet
+        case SSL_ERROR_ZERO_RETURN:
+            return 0; //close_notify
+        case SSL_ERROR_SYSCALL:
+            if(errno == 0) {
+                ERR_clear_error();
+                return 0; //end of stream without close_notify, a truncation the caller's framing must catch
+            }
+            [[fallthrough]];
+        default:
+            throw std::runtime_error(tls_error(EMSG_TLS_IO));
+        }
+    }
+
+    long tls_session::write(const char* buffer, const size_t size) {
+        if(size == 0) {
+            return 0;
+        }
+        size_t n = 0;
+        errno = 0;
+        auto i = SSL_write_ex(_ssl, buffer, size, &n);
+        if(i == 1) {
+            return static_cast<long>(n);
+        }
+        auto error = SSL_get_error(_ssl, i);
+        if(error == SSL_ERROR_WANT_WRITE || error == SSL_ERROR_WANT_READ) {
+            return -1;
+        }
+        throw std::runtime_error(tls_error(EMSG_TLS_IO));
+    }
+
+    long tls_session::sendfile(const int fd, const long long offset, const size_t size) {
+        if(ktls_send()) { //page cache to socket, encrypted by the kernel on the way
+            errno = 0;
+            auto i = SSL_sendfile(_ssl, fd, static_cast<off_t>(offset), size, 0);
+            if(i < 0) {
+                throw std::runtime_error(tls_error(EMSG_TLS_IO));
+            }
+            return static_cast<long>(i);
+        }
+        std::array<char, TLS_RECORD_SIZE> buffer;
+        size_t sent = 0;
+        while(sent < size) {
+            auto i = pread(fd, buffer.data(), std::min(buffer.size(), size - sent), static_cast<off_t>(offset + static_cast<long long>(sent)));
+            if(i < 0) {
+                throw std::runtime_error(tls_error(EMSG_TLS_IO));
+            }
+            if(i == 0) {
+                break; //end of file
+            }
+            if(write(buffer.data(), static_cast<size_t>(i)) < 0) {
+                break; //non blocking and full, report what went
+            }
+            sent += static_cast<size_t>(i);
+        }
+        return static_cast<long>(sent);
+    }
+
+    void tls_session::close_notify() {
+        SSL_shutdown(_ssl); //one way, the peer's close_notify is not waited for
+    }
+
+    bool tls_session::ktls_send() const {
+        return BIO_get_ktls_send(SSL_get_wbio(_ssl));
+    }
+
+    bool tls_session::ktls_recv() const {
+        return BIO_get_ktls_recv(SSL_get_rbio(_ssl));
+    }
+
+    std::string tls_session::protocol() const {
+        return std::string(SSL_get_version(_ssl)) + " " + SSL_get_cipher_name(_ssl);
+    }
+
+    tls_session::~tls_session() {
+        SSL_free(_ssl);
+    }
+
+}
+
+#endif // __linux__ && EP_SOCKETS_TLS
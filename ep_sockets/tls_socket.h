@@ -0,0 +1,213 @@
+#ifndef TLS_SOCKET_H
+#define TLS_SOCKET_H
+
+#if defined(__linux__) && defined(EP_SOCKETS_TLS)
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "socket_constants.h"
+#include "socket_errors.h"
+
+struct ssl_st;
+struct ssl_ctx_st;
+
+namespace net {
+
+    /**
+     * @brief tls_role_t - which end of the handshake a tls_context's sessions take
+     */
+    enum class tls_role_t {client, server};
+
+    /**
+     * @brief tls_options_t - certificates, peer verification and kernel offload of a tls_context
+     */
+    struct tls_options_t {
+        std::string certificate_file; //PEM certificate chain, needed by a server and by a client presenting one
+        std::string private_key_file; //PEM private key of the certificate
+        std::string ca_file; //PEM trusted CAs peers are verified against, empty uses the system's default store
+        bool verify_server = true; //clients check the server's chain and that it is for the server_name given
+        bool require_client_certificate = false; //servers ask for, and check, a client certificate (mutual TLS)
+        bool ktls = true; //once the handshake is done hand record encryption to the kernel (TCP_ULP "tls") where it can
+    };
+
+    /**
+     * @brief The tls_context class is the OpenSSL configuration shared by every tls_session of one role: certificates,
+     * trust store and protocol versions (TLS 1.2 and later). Create one per process and role, it is thread safe once built.
+     * @version 0.5
+     */
+    class tls_context {
+
+    public:
+
+        tls_context(const tls_role_t role, const tls_options_t& options = tls_options_t{});
+
+        tls_context(const tls_context&) = delete;
+
+        tls_context& operator= (const tls_context&) = delete;
+
+        tls_role_t role() const;
+
+        ssl_ctx_st* native() const;
+
+        ~tls_context();
+
+    private:
+
+        tls_role_t _role;
+        ssl_ctx_st* _ctx = nullptr;
+
+    };
+
+    /**
+     * @brief The tls_session class runs TLS over a connected stream socket's descriptor: the handshake is done by OpenSSL,
+     * then, when the kernel, OpenSSL and the negotiated cipher allow, the session keys are handed to kernel TLS so records
+     * are encrypted and decrypted by the kernel and sendfile goes from the page cache to the wire with no copy to user space.
+     * Without kernel TLS the same calls run through OpenSSL in user space.
+     * @version 0.5
+     * @note one reader and one writer thread at most, the socket must outlive the session. Blocking sockets only for the handshake.
+     */
+    class tls_session {
+
+    public:
+
+        /**
+         * @brief tls_session - handshake on sockfd as the context's role
+         * @param server_name - the server's host name, sent (SNI) and checked against its certificate by clients, unused by servers,
+         * required by a client that verifies the server
+         */
+        tls_session(tls_context& context, const unsigned int sockfd, const std::string& server_name = std::string());
+
+        tls_session(tls_session&& other) noexcept;
+
+        tls_session& operator= (tls_session&& other) noexcept;
+
+        tls_session(const tls_session&) = delete;
+
+        tls_session& operator= (const tls_session&) = delete;
+
+        /**
+         * @brief read_some - decrypt up to size bytes
+         * @param flags - MSG_PEEK leaves the data to be read again
+         * @return long - bytes read, 0 at the peer's close_notify or end of stream, -1 when a non blocking socket has nothing yet
+         */
+        long read_some(char* buffer, const size_t size, const int flags = 0);
+
+        /**
+         * @brief write - encrypt and send the whole buffer
+         * @return long - the number of bytes written, -1 when a non blocking socket's send buffer is full (retry with the same buffer)
+         */
+        long write(const char* buffer, const size_t size);
+
+        /**
+         * @brief sendfile - send size bytes of the file fd from offset, zero copy with kernel TLS, else read and encrypted in user space
+         * @return long - the number of bytes sent
+         */
+        long sendfile(const int fd, const long long offset, const size_t size);
+
+        /**
+         * @brief close_notify - tell the peer no more data follows, the socket itself stays open
+         */
+        void close_notify();
+
+        /**
+         * @brief ktls_send - whether the kernel encrypts what this session sends
+         */
+        bool ktls_send() const;
+
+        /**
+         * @brief ktls_recv - whether the kernel decrypts what this session receives
+         */
+        bool ktls_recv() const;
+
+        /**
+         * @brief protocol - the negotiated version and cipher, e.g. "TLSv1.3 TLS_AES_256_GCM_SHA384"
+         */
+        std::string protocol() const;
+
+        ~tls_session();
+
+    private:
+
+        ssl_st* _ssl = nullptr;
+
+    };
+
+    /**
+     * @brief The tls_socket class is a stream multi_socket product behind TLS: it owns the connection and its tls_session and
+     * has the read/write/read_some calls of the product, so buffered_reader and the framing helpers work on it unchanged.
+     * @version 0.5
+     * @tparam S - tcp_client_socket (client role) or tcp_active_socket (server role), or their local counterparts
+     */
+    template<typename S>
+    class tls_socket {
+
+    public:
+
+        /**
+         * @brief tls_socket - take over a connected socket and handshake on it
+         * @param server_name - clients: the host name to send and verify
+         */
+        tls_socket(S&& socket, tls_context& context, const std::string& server_name = std::string()):
+            _socket(std::move(socket)), _session(context, _socket.sockfd(), server_name) {}
+
+        /**
+         * @brief read - decrypt what has arrived, up to a record, throws at end of stream like the product's read
+         */
+        std::string read(const int flags = 0) {
+            std::string buffer(TLS_RECORD_SIZE, '\0');
+            auto i = _session.read_some(&buffer[0], buffer.size(), flags);
+            if(i <= 0) {
+                throw std::runtime_error(EMSG_TLS_CLOSED);
+            }
+            buffer.resize(static_cast<size_t>(i));
+            return buffer;
+        }
+
+        long write(const std::string& buffer, const int = 0) {
+            return _session.write(buffer.data(), buffer.size());
+        }
+
+        long read_some(char* buffer, const size_t size, const int flags = 0) {
+            return _session.read_some(buffer, size, flags);
+        }
+
+        long sendfile(const int fd, const long long offset, const size_t size) {
+            return _session.sendfile(fd, offset, size);
+        }
+
+        /**
+         * @brief stop - WRITE sends close_notify before shutting the connection down for writing
+         */
+        void stop(action_t action) {
+            if(action != action_t::READ) {
+                _session.close_notify();
+            }
+            _socket.stop(action);
+        }
+
+        tls_session& session() {
+            return _session;
+        }
+
+        S& socket() {
+            return _socket;
+        }
+
+        unsigned int sockfd() const {
+            return _socket.sockfd();
+        }
+
+    private:
+
+        S _socket;
+        tls_session _session; //after the socket, it goes first
+
+    };
+
+}
+
+#endif // __linux__ && EP_SOCKETS_TLS
+
+#endif // TLS_SOCKET_H
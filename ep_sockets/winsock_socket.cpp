@@ -25,6 +25,27 @@ namespace net {
         setsockopt(_socket, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(int));
 	}
 
+    base_socket::base_socket(base_socket&& other) noexcept:
+        _address_family(other._address_family), _socket_type(other._socket_type), _protocol(other._protocol),
+        _socket(other._socket), _addr(other._addr), _raddr(other._raddr), _spin_budget(other._spin_budget) {
+        other._socket = INVALID_SOCKET; //the moved from destructor now leaves the socket alone
+    }
+
+    base_socket& base_socket::operator=(base_socket&& other) noexcept {
+        if(this != &other) {
+            _close();
+            _address_family = other._address_family;
+            _socket_type = other._socket_type;
+            _protocol = other._protocol;
+            _socket = other._socket;
+            _addr = other._addr;
+            _raddr = other._raddr;
+            _spin_budget = other._spin_budget;
+            other._socket = INVALID_SOCKET;
+        }
+        return *this;
+    }
+
     int base_socket::_assign_address(const std::string &address, const unsigned short port) {
         //using sockaddr_in makes assigning the address easier but must then reinterpret cast to sockaddr for winsock functions
         _addr.sin_family = static_cast<short>(_address_family);
@@ -37,6 +58,28 @@ namespace net {
 
 	}
 
+    ip_mreq base_socket::_group_request(const std::string& group, const std::string& interface_addr) {
+        ip_mreq request{};
+        if(inet_pton(AF_INET, group.c_str(), reinterpret_cast<char*>(&request.imr_multiaddr)) != 1 ||
+                inet_pton(AF_INET, interface_addr.c_str(), reinterpret_cast<char*>(&request.imr_interface)) != 1) {
+            throw std::runtime_error(EMSG_INET_PTON);
+        }
+        return request;
+    }
+
+    void base_socket::_spin_readable(const int) const {
+        if(_spin_budget.count() == 0) {
+            return;
+        }
+        auto until = std::chrono::steady_clock::now() + _spin_budget;
+        do { //no MSG_DONTWAIT, ask how much is queued instead - end of stream is left for the blocking read to find
+            u_long pending = 0;
+            if(ioctlsocket(_socket, FIONREAD, &pending) == SOCKET_ERROR || pending > 0) {
+                return;
+            }
+        } while(std::chrono::steady_clock::now() < until);
+    }
+
     void base_socket::_reset_socket(sockfd_t socket) {
         char optval = 1; //option data depends on command here 1 enables reuse
         auto optlen = sizeof(char); //length of the option data here a single byte field
@@ -49,6 +92,22 @@ namespace net {
         }
     }
 
+    void base_socket::_set_blocking(sockfd_t socket, const bool blocking) {
+        u_long mode = blocking ? 0 : 1;
+        if(ioctlsocket(socket, FIONBIO, &mode) == SOCKET_ERROR) {
+            throw std::runtime_error(std::to_string(WSAGetLastError()) + " " + last_error());
+        }
+    }
+
+    int base_socket::_pending_error(sockfd_t socket) {
+        int error = 0;
+        int len = sizeof(error);
+        if(getsockopt(socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &len) == SOCKET_ERROR) {
+            return WSAGetLastError();
+        }
+        return error;
+    }
+
     std::string base_socket::_read(sockfd_t socket, const int flags) {
 		std::array<char, DEFAULT_BUFFER_SIZE>buffer;
         auto i = recv(static_cast<unsigned int>(socket), &buffer.front(), static_cast<int>(buffer.size()), flags);
@@ -109,6 +168,112 @@ namespace net {
 		}
 	}
 
+    void base_socket::connect_to(const std::string& address, const unsigned short port, const std::chrono::milliseconds timeout) {
+        auto e = _assign_address(address, port);
+        if (e < 0) {
+            throw std::runtime_error(std::to_string(e) + " assign address " + last_error());
+        }
+        if (e == 0) {
+            throw std::runtime_error(EMSG_INET_PTON);
+        }
+        connect_to_first({{address, port}}, timeout, timeout); //a race with a single runner
+    }
+
+    void base_socket::connect_to_first(const std::vector<endpoint_t>& candidates, const std::chrono::milliseconds timeout, const std::chrono::milliseconds stagger) {
+        using steady = std::chrono::steady_clock;
+        std::vector<sockaddr_in> addrs;
+        std::vector<WSAPOLLFD> fds; //a failed attempt's socket is set to INVALID_SOCKET so WSAPoll ignores it
+        auto deadline = steady::now() + timeout;
+        auto next_start = steady::now();
+        size_t next = 0;
+        int last_error_code = WSAETIMEDOUT;
+        int winner = -1;
+        auto close_all = [&fds](SOCKET keep) {
+            for(auto& p: fds) {
+                if(p.fd != INVALID_SOCKET && p.fd != keep) {
+                    closesocket(p.fd);
+                }
+            }
+        };
+        while(winner < 0) {
+            auto now = steady::now();
+            auto pending = std::any_of(fds.begin(), fds.end(), [](const WSAPOLLFD& p){ return p.fd != INVALID_SOCKET; });
+            if(next < candidates.size() && (now >= next_start || !pending)) { //start the next attempt
+                const auto& candidate = candidates[next++];
+                sockaddr_in addr{};
+                addr.sin_family = static_cast<short>(_address_family);
+                addr.sin_port = htons(candidate.port);
+                if(inet_pton(_address_family, candidate.address.c_str(), reinterpret_cast<char*>(&addr.sin_addr)) != 1) {
+                    last_error_code = WSAEINVAL;
+                    continue;
+                }
+                auto s = socket(_address_family, _socket_type, _protocol);
+                if(s == INVALID_SOCKET) {
+                    last_error_code = WSAGetLastError();
+                    continue;
+                }
+                try {
+                    _set_blocking(s, false);
+                } catch (...) { //give back every socket the race has opened
+                    closesocket(s);
+                    close_all(INVALID_SOCKET);
+                    throw;
+                }
+                if(connect(s, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR && WSAGetLastError() != WSAEWOULDBLOCK) {
+                    last_error_code = WSAGetLastError();
+                    closesocket(s);
+                    continue;
+                }
+                addrs.push_back(addr);
+                fds.push_back(WSAPOLLFD{s, POLLWRNORM, 0});
+                next_start = now + stagger;
+                continue;
+            }
+            if(!pending && next >= candidates.size()) {
+                break; //every candidate has failed
+            }
+            if(now >= deadline) {
+                last_error_code = WSAETIMEDOUT;
+                break;
+            }
+            auto wake = next < candidates.size() ? std::min(deadline, next_start) : deadline;
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(wake - now + std::chrono::microseconds(999)).count();
+            if(WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), static_cast<INT>(wait)) == SOCKET_ERROR) {
+                last_error_code = WSAGetLastError();
+                break;
+            }
+            for(size_t i = 0; i < fds.size() && winner < 0; ++i) {
+                if(fds[i].fd == INVALID_SOCKET || !fds[i].revents) {
+                    continue;
+                }
+                auto error = _pending_error(fds[i].fd);
+                if(error == 0 && (fds[i].revents & POLLWRNORM)) {
+                    winner = static_cast<int>(i);
+                } else {
+                    last_error_code = error ? error : WSAECONNREFUSED;
+                    closesocket(fds[i].fd);
+                    fds[i].fd = INVALID_SOCKET;
+                }
+            }
+        }
+        if(winner < 0) {
+            close_all(INVALID_SOCKET);
+            WSASetLastError(last_error_code);
+            throw std::runtime_error(std::to_string(last_error_code) + " " + last_error());
+        }
+        auto s = fds[static_cast<size_t>(winner)].fd;
+        close_all(s);
+        try {
+            _set_blocking(s, true);
+        } catch (...) { //_socket stays the unconnected socket it was
+            closesocket(s);
+            throw;
+        }
+        closesocket(_socket); //replace the unconnected socket with the winner
+        _socket = s;
+        _addr = addrs[static_cast<size_t>(winner)];
+    }
+
     void base_socket::bind_to(const std::string& address, const unsigned short port) {
         auto e = _assign_address(address, port);
 		if (e < 0) {
@@ -123,10 +288,14 @@ namespace net {
 	}
 
     void base_socket::be_listening() {
+        be_listening(MAX_BACKLOG);
+    }
+
+    void base_socket::be_listening(const int backlog) {
         //marks the socket referred to by _socket as a passive socket, that is,
         //as a socket that will be used to accept incoming connection requests using accept
-        if(listen(_socket, MAX_BACKLOG) < 0) {
-        //MAX_BACKLOG defines the maximum length to which the queue of pending connections for _socket may grow
+        if(listen(_socket, backlog) < 0) {
+        //backlog defines the maximum length to which the queue of pending connections for _socket may grow
             throw std::runtime_error(std::to_string(WSAGetLastError()) + " " + last_error());
         }
     }
@@ -143,8 +312,7 @@ namespace net {
         return val;
     }
 
-    unsigned int base_socket::accept_and_create_sockfd() {
-        assert(is_listening());
+    unsigned int base_socket::accept_and_create_sockfd(const int flags) {
         socklen_t len_raddr = sizeof(_raddr);
         auto s = accept(_socket, //this bound and listening socket's file descriptor
                             reinterpret_cast<struct sockaddr*>(&_raddr), //filled in with the remote address of this peer socket
@@ -152,11 +320,34 @@ namespace net {
         if(s == INVALID_SOCKET) {
             throw std::runtime_error(last_error());
         }
+        if(flags & SOCK_NONBLOCK) {
+            _set_blocking(s, false);
+        }
         return static_cast<unsigned int>(s); //the newly created socket using the connected file descriptor
     }
 
+    size_t base_socket::accept_batch(std::vector<unsigned int>& sockfds, const size_t max_sockets, const int flags) {
+        sockfds.clear(); //Winsock cannot tell whether the listener blocks, so one connection per call
+        if(max_sockets == 0) {
+            return 0;
+        }
+        auto s = accept(_socket, nullptr, nullptr);
+        if(s == INVALID_SOCKET) {
+            if(WSAGetLastError() == WSAEWOULDBLOCK) {
+                return 0;
+            }
+            throw std::runtime_error(std::to_string(WSAGetLastError()) + " " + last_error());
+        }
+        if(flags & SOCK_NONBLOCK) {
+            _set_blocking(s, false);
+        }
+        sockfds.push_back(static_cast<unsigned int>(s));
+        return 1;
+    }
+
 
     std::string base_socket::read(const int flags) const {
+        _spin_readable(flags);
         return _read(_socket, flags);
     }
 
@@ -164,7 +355,36 @@ namespace net {
         return _write(_socket, buffer, flags);
     }
 
+    long base_socket::gather_write(const std::vector<std::string_view>& buffers, const int flags) const {
+        std::vector<WSABUF> wsabufs(buffers.size());
+        for(size_t i = 0; i < buffers.size(); ++i) {
+            wsabufs[i].buf = const_cast<char*>(buffers[i].data()); //WSASend does not write through buf
+            wsabufs[i].len = static_cast<ULONG>(buffers[i].size());
+        }
+        DWORD sent = 0;
+        if(WSASend(_socket, wsabufs.data(), static_cast<DWORD>(wsabufs.size()), &sent, static_cast<DWORD>(flags), nullptr, nullptr) == SOCKET_ERROR) {
+            if(WSAGetLastError() == WSAEWOULDBLOCK) { //non blocking and the send buffer is full
+                return 0;
+            }
+            throw std::runtime_error(std::to_string(WSAGetLastError()) + " " + last_error());
+        }
+        return static_cast<long>(sent);
+    }
+
+    long base_socket::read_some(char* buffer, const size_t size, const int flags) const {
+        _spin_readable(flags);
+        auto i = recv(_socket, buffer, static_cast<int>(std::min(size, static_cast<size_t>(INT_MAX))), flags);
+        if(i == SOCKET_ERROR) {
+            if(WSAGetLastError() == WSAEWOULDBLOCK) { //non blocking and nothing has arrived
+                return -1;
+            }
+            throw std::runtime_error(std::to_string(WSAGetLastError()) + " " + last_error());
+        }
+        return static_cast<long>(i);
+    }
+
     std::string base_socket::read_from(const int flags) {
+        _spin_readable(flags);
         return _read_from(_socket, _raddr, flags);
     }
 
@@ -197,9 +417,221 @@ namespace net {
 		}
 	}
 
+    bool base_socket::is_alive() const {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(_socket, &readable);
+        timeval zero{0, 0};
+        //an idle open connection is never readable, readable means data, FIN, reset or error
+        return select(0, &readable, nullptr, nullptr, &zero) == 0;
+    }
+
+    void base_socket::keep_alive(const bool enable) {
+        BOOL optval = enable ? TRUE : FALSE;
+        if (setsockopt(_socket,
+                       SOL_SOCKET, //manipulates options at the sockets API level
+                       SO_KEEPALIVE, //periodically probe an idle connection
+                       reinterpret_cast<const char*>(&optval), sizeof(optval)) == SOCKET_ERROR) {
+            throw std::runtime_error(std::to_string(WSAGetLastError()) + " " + last_error());
+        }
+    }
+
+    size_t base_socket::read_batch(std::vector<std::string>& messages, const size_t max_messages, const size_t max_size, const int flags) {
+        auto count = std::min(max_messages, MAX_BATCH);
+        messages.resize(count);
+        size_t n = 0;
+        _spin_readable(flags);
+        while(n < count) { //no recvmmsg, wait for the first datagram then take only what is already queued
+            if(n > 0) {
+                u_long pending = 0;
+                if(ioctlsocket(_socket, FIONREAD, &pending) == SOCKET_ERROR || pending == 0) {
+                    break;
+                }
+            }
+            messages[n].resize(max_size);
+            auto i = recv(_socket, &messages[n][0], static_cast<int>(max_size), flags);
+            if(i == SOCKET_ERROR) {
+                if(WSAGetLastError() == WSAEMSGSIZE) { //truncated to max_size
+                    i = static_cast<int>(max_size);
+                } else if(WSAGetLastError() == WSAEWOULDBLOCK) {
+                    break;
+                } else {
+                    throw std::runtime_error(std::to_string(WSAGetLastError()) + " " + last_error());
+                }
+            }
+            messages[n++].resize(static_cast<size_t>(i));
+        }
+        messages.resize(n);
+        return n;
+    }
+
+    void base_socket::join_group(const std::string& group, const std::string& interface_addr) {
+        auto request = _group_request(group, interface_addr);
+        if (setsockopt(_socket, IPPROTO_IP, IP_ADD_MEMBERSHIP, reinterpret_cast<const char*>(&request), sizeof(request)) == SOCKET_ERROR) {
+            throw std::runtime_error(std::to_string(WSAGetLastError()) + " " + last_error());
+        }
+    }
+
+    void base_socket::leave_group(const std::string& group, const std::string& interface_addr) {
+        auto request = _group_request(group, interface_addr);
+        if (setsockopt(_socket, IPPROTO_IP, IP_DROP_MEMBERSHIP, reinterpret_cast<const char*>(&request), sizeof(request)) == SOCKET_ERROR) {
+            throw std::runtime_error(std::to_string(WSAGetLastError()) + " " + last_error());
+        }
+    }
+
+    void base_socket::multicast_ttl(const int ttl) {
+        DWORD optval = static_cast<DWORD>(ttl);
+        if (setsockopt(_socket, IPPROTO_IP, IP_MULTICAST_TTL, reinterpret_cast<const char*>(&optval), sizeof(optval)) == SOCKET_ERROR) {
+            throw std::runtime_error(std::to_string(WSAGetLastError()) + " " + last_error());
+        }
+    }
+
+    void base_socket::multicast_loopback(const bool enable) {
+        DWORD optval = enable ? 1 : 0;
+        if (setsockopt(_socket, IPPROTO_IP, IP_MULTICAST_LOOP, reinterpret_cast<const char*>(&optval), sizeof(optval)) == SOCKET_ERROR) {
+            throw std::runtime_error(std::to_string(WSAGetLastError()) + " " + last_error());
+        }
+    }
+
+    void base_socket::multicast_interface(const std::string& interface_addr) {
+        in_addr addr{};
+        if(inet_pton(AF_INET, interface_addr.c_str(), reinterpret_cast<char*>(&addr)) != 1) {
+            throw std::runtime_error(EMSG_INET_PTON);
+        }
+        if (setsockopt(_socket, IPPROTO_IP, IP_MULTICAST_IF, reinterpret_cast<const char*>(&addr), sizeof(addr)) == SOCKET_ERROR) {
+            throw std::runtime_error(std::to_string(WSAGetLastError()) + " " + last_error());
+        }
+    }
+
+    long base_socket::write_segmented(std::string_view buffer, const size_t segment_size, const int flags) const {
+        assert(segment_size > 0);
+        size_t sent = 0;
+        do { //no UDP_SEGMENT, send the datagrams one by one
+            auto size = std::min(segment_size, buffer.size() - sent);
+            auto i = send(_socket, buffer.data() + sent, static_cast<int>(size), flags);
+            if(i == SOCKET_ERROR) {
+                throw std::runtime_error(std::to_string(WSAGetLastError()) + " " + last_error());
+            }
+            sent += static_cast<size_t>(i);
+        } while(sent < buffer.size());
+        return static_cast<long>(sent);
+    }
+
+    void base_socket::gro(const bool) {} //no UDP_GRO, every datagram is received on its own
+
+    size_t base_socket::read_segments(std::string& buffer, std::vector<std::string_view>& segments, const int flags) {
+        segments.clear();
+        if(buffer.size() < MAX_DATAGRAM_SIZE) {
+            buffer.resize(MAX_DATAGRAM_SIZE);
+        }
+        _spin_readable(flags);
+        auto i = recv(_socket, &buffer[0], static_cast<int>(buffer.size()), flags);
+        if(i == SOCKET_ERROR) {
+            if(WSAGetLastError() == WSAEWOULDBLOCK) {
+                return 0;
+            }
+            throw std::runtime_error(std::to_string(WSAGetLastError()) + " " + last_error());
+        }
+        segments.emplace_back(buffer.data(), static_cast<size_t>(i));
+        return 1;
+    }
+
+    void base_socket::bind_local(const std::string&) {
+        throw std::runtime_error(EMSG_LOCAL_UNSUPPORTED); //the local socket products are Linux only
+    }
+
+    void base_socket::connect_local(const std::string&) {
+        throw std::runtime_error(EMSG_LOCAL_UNSUPPORTED);
+    }
+
+    long base_socket::write_fds(const std::string& buffer, const std::vector<int>& fds, const int) const {
+        if(buffer.empty()) {
+            throw std::runtime_error(EMSG_FDS_EMPTY);
+        }
+        if(fds.size() > MAX_PASSED_FDS) {
+            throw std::runtime_error(EMSG_FDS_TOO_MANY);
+        }
+        throw std::runtime_error(EMSG_LOCAL_UNSUPPORTED);
+    }
+
+    std::string base_socket::read_fds(std::vector<int>&, const int) const {
+        throw std::runtime_error(EMSG_LOCAL_UNSUPPORTED);
+    }
+
+    bool base_socket::busy_poll(const std::chrono::microseconds spin_budget) {
+        _spin_budget = std::max(spin_budget, std::chrono::microseconds(0));
+        return false; //no kernel busy polling, the user space spin only
+    }
+
+    bool base_socket::timestamps(const timestamp_t mode) {
+        return mode == timestamp_t::NONE; //not collected on Windows, the overloads return zero stamps
+    }
+
+    std::string base_socket::read(rx_timestamp_t& stamp, const int flags) const {
+        stamp = rx_timestamp_t{};
+        return read(flags);
+    }
+
+    std::string base_socket::read_from(rx_timestamp_t& stamp, const int flags) {
+        stamp = rx_timestamp_t{};
+        return read_from(flags);
+    }
+
+    void base_socket::hand_over(const std::string&) {
+        throw std::runtime_error(EMSG_LOCAL_UNSUPPORTED); //WSADuplicateSocket needs the receiver's process id up front, not supported
+    }
+
+    unsigned int base_socket::take_over(const std::string&) {
+        throw std::runtime_error(EMSG_LOCAL_UNSUPPORTED);
+    }
+
+    void base_socket::fast_open(const int queue_length) {
+        DWORD optval = queue_length > 0 ? 1 : 0; //Windows 10 takes on or off, the queue is its own
+        if(setsockopt(_socket, IPPROTO_TCP, TCP_FASTOPEN, reinterpret_cast<const char*>(&optval), sizeof(optval)) == SOCKET_ERROR) {
+            throw std::runtime_error(std::to_string(WSAGetLastError()) + " " + last_error());
+        }
+    }
+
+    void base_socket::defer_accept(const std::chrono::seconds) {
+        //no Winsock equivalent, accept wakes on the handshake as before
+    }
+
+    long base_socket::connect_fast_open(const std::string& address, const unsigned short port, const std::string& buffer, const int flags) {
+        connect_to(address, port); //Winsock sends SYN data only through ConnectEx, so connect then write
+        return buffer.empty() ? 0 : _write(_socket, buffer, flags);
+    }
+
+    long base_socket::read_some_from(char* buffer, const size_t size, const int flags) {
+        _spin_readable(flags);
+        int len_raddr = sizeof(_raddr);
+        auto i = recvfrom(_socket, buffer, static_cast<int>(std::min(size, static_cast<size_t>(INT_MAX))), flags,
+                          reinterpret_cast<struct sockaddr*>(&_raddr), &len_raddr);
+        if(i == SOCKET_ERROR) {
+            if(WSAGetLastError() == WSAEWOULDBLOCK) { //non blocking and nothing has arrived
+                return -1;
+            }
+            if(WSAGetLastError() == WSAEMSGSIZE) { //truncated to size, as on Linux
+                return static_cast<long>(size);
+            }
+            throw std::runtime_error(std::to_string(WSAGetLastError()) + " " + last_error());
+        }
+        return static_cast<long>(i);
+    }
+
+    unsigned int base_socket::sockfd() const {
+        return static_cast<unsigned int>(_socket);
+    }
+
+    void base_socket::_close() {
+        if(_socket != INVALID_SOCKET) {
+            shutdown(_socket, SD_BOTH);
+            closesocket(_socket);
+            _socket = INVALID_SOCKET;
+        }
+    }
+
 	base_socket::~base_socket() {
-		shutdown(_socket, SD_BOTH);
-		closesocket(_socket);
+        _close();
 	}
 
 	const std::string base_socket::last_error() {
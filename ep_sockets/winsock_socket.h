@@ -8,10 +8,15 @@
 
 #include <atomic>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <stdexcept>
 #include <map>
 #include <array>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <climits>
 #include "assert.h"
 
 #include "string.h"
@@ -52,9 +57,20 @@ namespace net {
          */
         base_socket(const short address_family, const int socket_type, const int protocol);
 
-        base_socket (const base_socket&) = default;
+        /**
+         * @brief base_socket - copying would leave two owners closing the same socket file descriptor so sockets are move only.
+         */
+        base_socket (const base_socket&) = delete;
+
+        base_socket& operator= (const base_socket&) = delete;
+
+        /**
+         * @brief base_socket - move constructs by taking over the socket file descriptor, the moved from socket no longer owns it.
+         * @param other - socket to take over
+         */
+        base_socket (base_socket&& other) noexcept;
 
-        base_socket& operator= (const base_socket&) = default;
+        base_socket& operator= (base_socket&& other) noexcept;
 
         /**
          * @brief connect_to - creates a socket file descriptor for this socket from a text format Internet address and port.
@@ -64,6 +80,26 @@ namespace net {
          */
         void connect_to(const std::string& address, const unsigned short port) override;
 
+        /**
+         * @brief connect_to - connect without blocking for longer than timeout, rather than the minutes the kernel SYN retries can take.
+         * @note on failure, including ETIMEDOUT when the deadline passes, throws an exception containing the system call error message.
+         * @param address - text format Internet address
+         * @param port - port number
+         * @param timeout - deadline for the whole connection attempt
+         */
+        void connect_to(const std::string& address, const unsigned short port, const std::chrono::milliseconds timeout) override;
+
+        /**
+         * @brief connect_to_first - race connection attempts to several candidate endpoints (e.g. replicas) and keep the first to succeed.
+         * Attempts are started in order, a new one every stagger interval or as soon as all earlier ones have failed (RFC 8305 style),
+         * the losers are closed once one connects.
+         * @note on failure of every candidate, or when timeout passes, throws an exception containing the last system call error message.
+         * @param candidates - endpoints in order of preference
+         * @param timeout - deadline for the whole race
+         * @param stagger - delay before starting the next attempt while earlier ones are still pending
+         */
+        void connect_to_first(const std::vector<endpoint_t>& candidates, const std::chrono::milliseconds timeout, const std::chrono::milliseconds stagger) override;
+
         /**
          * @brief bind_to - naming a port by creates a socket file descriptor for this socket from a text format Internet address and port.
          * It is normally necessary to assign a local address using bind before a SOCK_STREAM socket may receive connections.
@@ -77,6 +113,12 @@ namespace net {
          */
         void be_listening() override final;
 
+        /**
+         * @brief be_listening - as be_listening, with the length of the queue of connections not yet accepted
+         * @param backlog - the kernel caps it at net.core.somaxconn, SYN flood protection (syncookies) is separate
+         */
+        void be_listening(const int backlog) override final;
+
         /**
          * @baction_trief server_is_listening
          * @return true if passive socket that can accept connection(s)
@@ -91,7 +133,18 @@ namespace net {
          * @note the newly created socket is *not* in the listening state whilst this original socket is unaffected.
          * @return int newly created socket file descriptor
          */
-        unsigned int accept_and_create_sockfd() override;
+        unsigned int accept_and_create_sockfd(const int flags = 0) override;
+
+        /**
+         * @brief accept_batch - accept every pending connection, up to max_sockets, in one go - call it once per readiness of a
+         * non blocking listener (e.g. an event_loop's) to drain the queue a storm leaves, rather than once per connection.
+         * @note the peers' addresses are not kept, on a blocking listener only one connection is accepted per call
+         * @param sockfds - set to the new sockets' file descriptors, the caller owns them
+         * @param max_sockets - most connections to accept
+         * @param flags - formed by ORing one or more of: SOCK_NONBLOCK, SOCK_CLOEXEC - set on every new socket
+         * @return size_t - the number of connections accepted, 0 once the queue is empty
+         */
+        size_t accept_batch(std::vector<unsigned int>& sockfds, const size_t max_sockets, const int flags) override;
 
         /**
          * @brief read - read a message from this socket if connected
@@ -108,6 +161,25 @@ namespace net {
          */
         long write(const std::string& buffer, const int flags = 0) const override;
 
+        /**
+         * @brief gather_write - write several buffers with one system call (sendmsg/WSASend) as if they were one contiguous message
+         * @note returns 0 rather than throwing when a non blocking send (e.g. MSG_DONTWAIT) finds the send buffer full
+         * @param buffers - views of the data to send in order, at most IOV_MAX are sent per call
+         * @param flags - formed by ORing one or more of: MSG_CONFIRM, MSG_DONTROUTE, MSG_DONTWAIT, MSG_EOR, MSG_MORE, MSG_NOSIGNAL, MSG_OOB - defaults to none.
+         * @return long - the number of bytes written, possibly fewer than the total
+         */
+        long gather_write(const std::vector<std::string_view>& buffers, const int flags = 0) const override;
+
+        /**
+         * @brief read_some - receive into a caller owned buffer, so stream readers can fill their own storage without a copy
+         * @note returns -1 rather than throwing when a non blocking read (e.g. MSG_DONTWAIT) finds nothing to read
+         * @param buffer - where to place the data
+         * @param size - at most this many bytes are received
+         * @param flags - formed by ORing one or more of: MSG_CMSG_CLOEXEC, MSG_DONTWAIT, MSG_PEEK, MSG_WAITALL - defaults to none
+         * @return long - the number of bytes received, 0 when the peer has closed the connection
+         */
+        long read_some(char* buffer, const size_t size, const int flags = 0) const override;
+
         /**
          * @brief read_from - receive data on a socket whether or not it is connection-oriented.
          * @param flags - formed by ORing one or more of: MSG_CMSG_CLOEXEC, MSG_DONTWAIT, MSG_ERRQUEUE, MSG_OOB, MSG_PEEK, MSG_TRUNC, MSG_WAITALL, MSG_EOR, MSG_TRUNC, MSG_CTRUNC, MSG_ERRQUEUE - defaults to none
@@ -134,6 +206,206 @@ namespace net {
          */
         void stop(action_t action) override;
 
+        /**
+         * @brief sockfd - the underlying socket file descriptor for use with readiness APIs such as poll, epoll or select.
+         * @note ownership is retained by this socket, do not close it.
+         * @return unsigned int - socket file descriptor
+         */
+        unsigned int sockfd() const override;
+
+        /**
+         * @brief is_alive - non blocking check that a connected socket is still open in both directions with nothing left unread.
+         * @note a peer that has half closed (sent FIN) or reset the connection, or stale unread data, all make this false.
+         * @return true if the connection can be safely reused for a new request
+         */
+        bool is_alive() const override;
+
+        /**
+         * @brief keep_alive - enable or disable the sending of keep-alive probes on a connection-oriented socket (SO_KEEPALIVE).
+         * @param enable - true to probe an otherwise idle connection so a vanished peer is eventually detected
+         */
+        void keep_alive(const bool enable) override;
+
+        /**
+         * @brief read_batch - receive several datagrams with one system call (recvmmsg), waiting only for the first.
+         * @note returns 0 rather than throwing when a non blocking read (e.g. MSG_DONTWAIT) finds nothing to read
+         * @param messages - resized to the datagrams received, their strings are reused from call to call
+         * @param max_messages - receive at most this many, capped at MAX_BATCH
+         * @param max_size - longer datagrams are truncated to this size
+         * @param flags - formed by ORing one or more of: MSG_CMSG_CLOEXEC, MSG_DONTWAIT, MSG_TRUNC - defaults to none
+         * @return size_t - the number of datagrams received
+         */
+        size_t read_batch(std::vector<std::string>& messages, const size_t max_messages, const size_t max_size = DEFAULT_BUFFER_SIZE, const int flags = 0) override;
+
+        /**
+         * @brief join_group - start receiving datagrams sent to a multicast group (IP_ADD_MEMBERSHIP).
+         * @param group - text format multicast address e.g. 239.1.2.3
+         * @param interface_addr - address of the local interface to join on, ANY_ADDR lets the kernel choose by routing table
+         */
+        void join_group(const std::string& group, const std::string& interface_addr = ANY_ADDR) override;
+
+        /**
+         * @brief leave_group - stop receiving datagrams sent to a multicast group (IP_DROP_MEMBERSHIP).
+         * @param group - text format multicast address
+         * @param interface_addr - the interface it was joined on
+         */
+        void leave_group(const std::string& group, const std::string& interface_addr = ANY_ADDR) override;
+
+        /**
+         * @brief multicast_ttl - how many router hops multicast datagrams sent from this socket may cross (IP_MULTICAST_TTL).
+         * @param ttl - 0 this host only, 1 the local subnet (the default), larger values cross routers
+         */
+        void multicast_ttl(const int ttl) override;
+
+        /**
+         * @brief multicast_loopback - whether multicast datagrams sent from this socket are also delivered to this host's own members (IP_MULTICAST_LOOP).
+         * @param enable - true (the kernel default) so local subscribers see them too
+         */
+        void multicast_loopback(const bool enable) override;
+
+        /**
+         * @brief multicast_interface - the local interface multicast datagrams are sent from (IP_MULTICAST_IF).
+         * @param interface_addr - text format address of the local interface
+         */
+        void multicast_interface(const std::string& interface_addr) override;
+
+        /**
+         * @brief write_segmented - send a buffer as a train of segment_size datagrams handing the kernel up to 64 at a time (UDP_SEGMENT, GSO)
+         * so the stack is traversed once per train rather than once per datagram.
+         * @note without GSO support (e.g. Windows) the datagrams are sent one by one, the receiver sees the same datagrams either way
+         * @param buffer - the data, the last datagram holds the remainder when its size is not a multiple of segment_size
+         * @param segment_size - payload bytes per datagram, keep it within the path MTU
+         * @param flags - formed by ORing one or more of: MSG_CONFIRM, MSG_DONTROUTE, MSG_DONTWAIT, MSG_NOSIGNAL - defaults to none.
+         * @return long - the number of bytes written
+         */
+        long write_segmented(std::string_view buffer, const size_t segment_size, const int flags = 0) const override;
+
+        /**
+         * @brief gro - let the kernel coalesce consecutive datagrams of a flow into one receive (UDP_GRO), split again by read_segments.
+         * @param enable - true to receive coalesced trains
+         */
+        void gro(const bool enable) override;
+
+        /**
+         * @brief read_segments - receive a datagram or a coalesced train of them and split it into the original datagrams without copying.
+         * @note returns 0 rather than throwing when a non blocking read (e.g. MSG_DONTWAIT) finds nothing to read
+         * @param buffer - receive storage reused from call to call, grown to the largest possible train
+         * @param segments - set to views into buffer, one per datagram
+         * @param flags - formed by ORing one or more of: MSG_CMSG_CLOEXEC, MSG_DONTWAIT - defaults to none
+         * @return size_t - the number of datagrams received
+         */
+        size_t read_segments(std::string& buffer, std::vector<std::string_view>& segments, const int flags = 0) override;
+
+        /**
+         * @brief bind_local - bind to a local (AF_UNIX) socket path, "@name" binds name in the Linux abstract namespace (no file, gone with the socket)
+         * and an empty path autobinds a unique abstract name so a datagram peer has an address to reply to.
+         * @param path - a file system path or "@name"
+         */
+        void bind_local(const std::string& path) override;
+
+        /**
+         * @brief connect_local - connect to a local (AF_UNIX) socket path, "@name" for the abstract namespace
+         * @param path - a file system path or "@name"
+         */
+        void connect_local(const std::string& path) override;
+
+        /**
+         * @brief write_fds - send a message carrying open file descriptors (SCM_RIGHTS), the peer receives duplicates of them
+         * @note local (AF_UNIX) sockets only, at least one byte of buffer is needed to carry the descriptors
+         * @param buffer - the message
+         * @param fds - up to MAX_PASSED_FDS descriptors, they stay open here
+         * @param flags - formed by ORing one or more of: MSG_DONTWAIT, MSG_EOR, MSG_NOSIGNAL - defaults to none.
+         * @return long - the number of bytes written
+         */
+        long write_fds(const std::string& buffer, const std::vector<int>& fds, const int flags = 0) const override;
+
+        /**
+         * @brief read_fds - receive a message and any file descriptors passed with it, already close on exec
+         * @param fds - set to the received descriptors, the caller owns and closes them
+         * @param flags - formed by ORing one or more of: MSG_DONTWAIT, MSG_PEEK, MSG_WAITALL - defaults to none
+         * @return string - the message, up to DEFAULT_BUFFER_SIZE bytes
+         */
+        std::string read_fds(std::vector<int>& fds, const int flags = 0) const override;
+
+        /**
+         * @brief busy_poll - latency mode: reads spin on a non blocking peek for up to spin_budget before blocking, so a message that
+         * arrives within the budget is picked up without the scheduler wake up, and the kernel is asked to busy poll the device
+         * queue too (SO_BUSY_POLL, SO_PREFER_BUSY_POLL) where allowed. Run the reading thread pinned to its own core, it burns it.
+         * @note raising SO_BUSY_POLL above net.core.busy_read needs CAP_NET_ADMIN, the user space spin works regardless
+         * @param spin_budget - how long a read spins before blocking, 0 turns the mode off
+         * @return bool - true if the kernel accepted busy polling as well
+         */
+        bool busy_poll(const std::chrono::microseconds spin_budget) override;
+
+        /**
+         * @brief timestamps - have the kernel stamp received data (SO_TIMESTAMPING, else SO_TIMESTAMPNS) for the read and read_from
+         * overloads that return an rx_timestamp_t, the stamp comes in the same recvmsg as the data so it costs no extra system call.
+         * @note HARDWARE also needs the NIC's receive filter enabled (SIOCSHWTSTAMP, e.g. by the PTP daemon), software stamps are kept as well
+         * @param mode - NONE turns stamping off
+         * @return bool - true if the kernel accepted the mode
+         */
+        bool timestamps(const timestamp_t mode) override;
+
+        /**
+         * @brief read - as read, also returning when the kernel received the data (of the latest segment, for a stream)
+         * @param stamp - set to the receive timestamps, zero unless timestamps is on
+         */
+        std::string read(rx_timestamp_t& stamp, const int flags = 0) const override;
+
+        /**
+         * @brief read_from - as read_from, also returning when the kernel received the datagram
+         * @param stamp - set to the receive timestamps, zero unless timestamps is on
+         */
+        std::string read_from(rx_timestamp_t& stamp, const int flags = 0) override;
+
+        /**
+         * @brief hand_over - send this socket to the process waiting in take_over at a local path, then close it here without shutting
+         * it down so it lives on in the receiver - a listener keeps its port and the connections queued on it, nothing is reset
+         * @param path - the receiver's local (AF_UNIX) path, "@name" for the abstract namespace
+         */
+        void hand_over(const std::string& path) override;
+
+        /**
+         * @brief take_over - wait at a local path for another process's hand_over and return the socket descriptor it sent
+         * @param path - a file system path or "@name", a file is removed again once the socket has arrived
+         * @return unsigned int - the socket descriptor, owned by the caller
+         */
+        static unsigned int take_over(const std::string& path);
+
+        /**
+         * @brief fast_open - let clients that hold a cookie from an earlier connection send data with their SYN (TCP_FASTOPEN), the
+         * request then arrives with the connection and the reply can leave a round trip sooner
+         * @note the server side also needs net.ipv4.tcp_fastopen bit 2 set (e.g. 3), only for requests safe to see twice, a SYN can be replayed
+         * @param queue_length - most connections with SYN data not yet fully established at a time, 0 turns it off
+         */
+        void fast_open(const int queue_length) override;
+
+        /**
+         * @brief defer_accept - do not wake accept for a connection until its first data has arrived (TCP_DEFER_ACCEPT), so a
+         * client that connects and says nothing costs the server no wake up, no accept and no descriptor
+         * @param timeout - how long the kernel waits for that data before accepting anyway, 0 turns it off
+         */
+        void defer_accept(const std::chrono::seconds timeout) override;
+
+        /**
+         * @brief connect_fast_open - connect to address and port sending buffer with the SYN (TCP Fast Open) when a cookie for the server
+         * is cached, otherwise the kernel asks for one and sends buffer once the handshake is done - a connection that sends first
+         * and never reuses the connection saves the round trip of the handshake from the second connection on.
+         * @note falls back to connect and write when the client side of net.ipv4.tcp_fastopen (bit 1, on by default) is off
+         * @param buffer - the first message
+         * @param flags - formed by ORing one or more of: MSG_DONTWAIT, MSG_NOSIGNAL - defaults to none.
+         * @return long - the number of bytes sent
+         */
+        long connect_fast_open(const std::string& address, const unsigned short port, const std::string& buffer, const int flags = 0) override;
+
+        /**
+         * @brief read_some_from - receive one datagram into a caller owned buffer and remember its sender for write_back
+         * @note returns -1 rather than throwing when a non blocking read (e.g. MSG_DONTWAIT) finds nothing to read
+         * @param size - at most this many bytes are received, the rest of a longer datagram is discarded
+         * @return long - the number of bytes received
+         */
+        long read_some_from(char* buffer, const size_t size, const int flags = 0) override;
+
         /**
          * @brief last_error - convert the error number stored in system errno into its human readable text form
          * @return string - error description
@@ -152,6 +424,39 @@ namespace net {
          */
         int _assign_address(const std::string& address, const unsigned short port);
 
+        /**
+         * @brief _close - shut down and close the socket file descriptor if this socket still owns one
+         */
+        void _close();
+
+        /**
+         * @brief _set_blocking - system call helper switching a socket file descriptor between blocking and non blocking mode
+         * @param socket - socket file descriptor
+         * @param blocking - true for blocking
+         */
+        static void _set_blocking(sockfd_t socket, const bool blocking);
+
+        /**
+         * @brief _pending_error - system call helper fetching and clearing the pending error (SO_ERROR) of a socket, e.g. the outcome of a non blocking connect
+         * @param socket - socket file descriptor
+         * @return int - 0 or the error number
+         */
+        static int _pending_error(sockfd_t socket);
+
+        /**
+         * @brief _group_request - system call helper filling in a multicast membership request
+         * @param group - text format multicast address
+         * @param interface_addr - text format local interface address
+         * @return ip_mreq - the request for IP_ADD_MEMBERSHIP or IP_DROP_MEMBERSHIP
+         */
+        static ip_mreq _group_request(const std::string& group, const std::string& interface_addr);
+
+        /**
+         * @brief _spin_readable - in busy_poll mode, spin until something can be read or the spin budget is spent, a no op otherwise
+         * @param flags - the read's flags, a non blocking read does not spin
+         */
+        void _spin_readable(const int flags) const;
+
         /**
          * @brief _reset_socket - system call helper to enable fast restart by enabling kernel to reuse addresses and ports that may be active.
          * @param socket - socket file descriptor
@@ -201,6 +506,7 @@ namespace net {
         sockfd_t _socket;
         sockaddr_in _addr;
         sockaddr_in _raddr;
+        std::chrono::microseconds _spin_budget{0}; //busy_poll mode when positive
 
     };
 
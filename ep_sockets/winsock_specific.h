@@ -13,6 +13,13 @@ namespace net {
 
     //Windows specific...
 
+    #ifndef SOCK_NONBLOCK
+        #define SOCK_NONBLOCK 04000 //accept flags as on Linux, applied with ioctlsocket(FIONBIO)
+    #endif
+    #ifndef SOCK_CLOEXEC
+        #define SOCK_CLOEXEC 02000000 //Winsock handles are not inherited by child processes unless asked, nothing to do
+    #endif
+
     enum versions {v1_0 = 0x1, v1_1 = 0x101, v2_0 = 0x2, v2_1 = 0x102, v2_2 = 0x202 };
 
     /**
@@ -0,0 +1,415 @@
+#include "xdp_socket.h"
+
+#ifdef __linux__
+
+#include <cstring>
+#include <stdexcept>
+
+#include "linux/bpf.h"
+#include "linux/if_link.h"
+#include "net/if.h"
+#include "sys/mman.h"
+#include "sys/syscall.h"
+
+#include "socket_factory.h"
+
+namespace net {
+
+    namespace {
+
+        static const size_t ETH_HEADER = 14;
+        static const size_t IP_HEADER = 20; //received datagrams may carry options, sent ones never do
+        static const size_t UDP_HEADER = 8;
+        static const unsigned short ETHERTYPE_IPV4 = 0x0800;
+        static const unsigned char TTL = 64;
+
+        int bpf(const int cmd, bpf_attr& attr) {
+            return static_cast<int>(syscall(SYS_bpf, cmd, &attr, sizeof(attr)));
+        }
+
+        bpf_insn insn(const uint8_t code, const uint8_t dst, const uint8_t src, const int16_t off, const int32_t imm) {
+            bpf_insn i{};
+            i.code = code;
+            i.dst_reg = dst;
+            i.src_reg = src;
+            i.off = off;
+            i.imm = imm;
+            return i;
+        }
+
+        //one's complement sum of 16 bit words in network order, folded by checksum()
+        unsigned long sum16(const unsigned char* data, size_t size, unsigned long sum = 0) {
+            for(; size > 1; data += 2, size -= 2) {
+                sum += static_cast<unsigned long>(data[0] << 8 | data[1]);
+            }
+            if(size) {
+                sum += static_cast<unsigned long>(data[0] << 8);
+            }
+            return sum;
+        }
+
+        unsigned short checksum(unsigned long sum) {
+            while(sum >> 16) {
+                sum = (sum & 0xffff) + (sum >> 16);
+            }
+            return static_cast<unsigned short>(~sum);
+        }
+
+        void put16(unsigned char* p, const unsigned short host) {
+            p[0] = static_cast<unsigned char>(host >> 8);
+            p[1] = static_cast<unsigned char>(host);
+        }
+
+    }
+
+    //------------xdp_udp_server_socket implementation------------
+    xdp_udp_server_socket::xdp_udp_server_socket(const std::string interface_name, const std::string addr, const unsigned short port,
+                                                 const xdp_options_t& options):
+        _options(options) {
+        try {
+            auto ifindex = if_nametoindex(interface_name.c_str());
+            in_addr local;
+            if(ifindex == 0) {
+                throw std::runtime_error(base_socket::last_error());
+            }
+            if(inet_pton(AF_INET, addr.c_str(), &local) != 1) {
+                throw std::runtime_error(EMSG_INET_PTON);
+            }
+            auto frames = _options.frames;
+            if(frames < 2 || (frames & (frames - 1)) || _options.frame_size < 2048 || (_options.frame_size & (_options.frame_size - 1))) {
+                throw std::runtime_error(EMSG_XDP_OPTIONS);
+            }
+            _fd = socket(AF_XDP, SOCK_RAW | SOCK_CLOEXEC, 0);
+            if(_fd < 0) {
+                throw std::runtime_error(base_socket::last_error());
+            }
+            //the UMEM - frames the kernel receives into and transmits from
+            _umem_size = static_cast<size_t>(frames) * _options.frame_size;
+            auto umem = mmap(nullptr, _umem_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+            if(umem == MAP_FAILED) {
+                throw std::runtime_error(base_socket::last_error());
+            }
+            _umem = static_cast<unsigned char*>(umem);
+            xdp_umem_reg reg{};
+            reg.addr = reinterpret_cast<unsigned long long>(_umem);
+            reg.len = _umem_size;
+            reg.chunk_size = _options.frame_size;
+            if(setsockopt(_fd, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) < 0) {
+                throw std::runtime_error(base_socket::last_error());
+            }
+            //four rings of half the frames each, every frame is always on exactly one of them or in our hands
+            int entries = static_cast<int>(frames / 2);
+            for(auto ring: {XDP_UMEM_FILL_RING, XDP_UMEM_COMPLETION_RING, XDP_RX_RING, XDP_TX_RING}) {
+                if(setsockopt(_fd, SOL_XDP, ring, &entries, sizeof(entries)) < 0) {
+                    throw std::runtime_error(base_socket::last_error());
+                }
+            }
+            xdp_mmap_offsets offsets{};
+            socklen_t len = sizeof(offsets);
+            if(getsockopt(_fd, SOL_XDP, XDP_MMAP_OFFSETS, &offsets, &len) < 0) {
+                throw std::runtime_error(base_socket::last_error());
+            }
+            _map_ring(_fill, frames / 2, sizeof(unsigned long long), offsets.fr, XDP_UMEM_PGOFF_FILL_RING);
+            _map_ring(_completion, frames / 2, sizeof(unsigned long long), offsets.cr, XDP_UMEM_PGOFF_COMPLETION_RING);
+            _map_ring(_rx, frames / 2, sizeof(xdp_desc), offsets.rx, XDP_PGOFF_RX_RING);
+            _map_ring(_tx, frames / 2, sizeof(xdp_desc), offsets.tx, XDP_PGOFF_TX_RING);
+            auto fill = static_cast<unsigned long long*>(_fill.descriptors);
+            for(unsigned int i = 0; i < frames / 2; ++i) {
+                fill[i] = static_cast<unsigned long long>(i) * _options.frame_size;
+            }
+            __atomic_store_n(_fill.producer, frames / 2, __ATOMIC_RELEASE);
+            for(unsigned int i = frames / 2; i < frames; ++i) {
+                _tx_frames.push_back(static_cast<unsigned long long>(i) * _options.frame_size);
+            }
+            sockaddr_xdp sxdp{};
+            sxdp.sxdp_family = AF_XDP;
+            sxdp.sxdp_ifindex = ifindex;
+            sxdp.sxdp_queue_id = _options.queue;
+            sxdp.sxdp_flags = (_options.mode == xdp_mode_t::ZERO_COPY ? XDP_ZEROCOPY : XDP_COPY) | XDP_USE_NEED_WAKEUP;
+            if(bind(_fd, reinterpret_cast<sockaddr*>(&sxdp), sizeof(sxdp)) < 0) {
+                throw std::runtime_error(base_socket::last_error());
+            }
+            _attach_program(local.s_addr, port, ifindex);
+        } catch (...) {
+            _close();
+            throw;
+        }
+    }
+
+    void xdp_udp_server_socket::_map_ring(xdp_ring_t& ring, const size_t entries, const size_t descriptor_size, const xdp_ring_offset& offsets, const off_t page_offset) {
+        ring.mapped_size = offsets.desc + entries * descriptor_size;
+        auto p = mmap(nullptr, ring.mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, page_offset);
+        if(p == MAP_FAILED) {
+            ring.mapped = nullptr;
+            throw std::runtime_error(base_socket::last_error());
+        }
+        auto base = static_cast<char*>(p);
+        ring.mapped = p;
+        ring.producer = reinterpret_cast<unsigned int*>(base + offsets.producer);
+        ring.consumer = reinterpret_cast<unsigned int*>(base + offsets.consumer);
+        ring.flags = reinterpret_cast<unsigned int*>(base + offsets.flags);
+        ring.descriptors = base + offsets.desc;
+        ring.mask = static_cast<unsigned int>(entries - 1);
+    }
+
+    void xdp_udp_server_socket::_attach_program(const unsigned int addr, const unsigned short port, const unsigned int ifindex) {
+        //the XSKMAP the program redirects into, keyed by receive queue
+        bpf_attr attr{};
+        attr.map_type = BPF_MAP_TYPE_XSKMAP;
+        attr.key_size = sizeof(unsigned int);
+        attr.value_size = sizeof(int);
+        attr.max_entries = _options.queue + 1;
+        _map_fd = bpf(BPF_MAP_CREATE, attr);
+        if(_map_fd < 0) {
+            throw std::runtime_error(base_socket::last_error());
+        }
+        unsigned int key = _options.queue;
+        attr = bpf_attr{};
+        attr.map_fd = static_cast<unsigned int>(_map_fd);
+        attr.key = reinterpret_cast<unsigned long long>(&key);
+        attr.value = reinterpret_cast<unsigned long long>(&_fd);
+        if(bpf(BPF_MAP_UPDATE_ELEM, attr) < 0) {
+            throw std::runtime_error(base_socket::last_error());
+        }
+        //r6 = ctx, r2 = data, r3 = data_end - frames that are not unfragmented UDP/IPv4 to addr:port, or are too short, jump to pass.
+        //Loads are in host order of bytes in network order, so the constants compared are the network order values as stored.
+        std::vector<bpf_insn> program = {
+            insn(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_6, BPF_REG_1, 0, 0),
+            insn(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_2, BPF_REG_6, offsetof(xdp_md, data), 0),
+            insn(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_3, BPF_REG_6, offsetof(xdp_md, data_end), 0),
+            insn(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_4, BPF_REG_2, 0, 0),
+            insn(BPF_ALU64 | BPF_ADD | BPF_K, BPF_REG_4, 0, 0, ETH_HEADER + IP_HEADER + UDP_HEADER),
+            insn(BPF_JMP | BPF_JGT | BPF_X, BPF_REG_4, BPF_REG_3, 0, 0), //pass
+            insn(BPF_LDX | BPF_MEM | BPF_H, BPF_REG_5, BPF_REG_2, 12, 0),
+            insn(BPF_JMP32 | BPF_JNE | BPF_K, BPF_REG_5, 0, 0, htons(ETHERTYPE_IPV4)), //pass
+            insn(BPF_LDX | BPF_MEM | BPF_B, BPF_REG_5, BPF_REG_2, ETH_HEADER, 0),
+            insn(BPF_JMP32 | BPF_JNE | BPF_K, BPF_REG_5, 0, 0, 0x45), //pass - IPv4 without options
+            insn(BPF_LDX | BPF_MEM | BPF_H, BPF_REG_5, BPF_REG_2, ETH_HEADER + 6, 0),
+            insn(BPF_ALU | BPF_AND | BPF_K, BPF_REG_5, 0, 0, htons(0x3fff)),
+            insn(BPF_JMP32 | BPF_JNE | BPF_K, BPF_REG_5, 0, 0, 0), //pass - a fragment, the kernel reassembles
+            insn(BPF_LDX | BPF_MEM | BPF_B, BPF_REG_5, BPF_REG_2, ETH_HEADER + 9, 0),
+            insn(BPF_JMP32 | BPF_JNE | BPF_K, BPF_REG_5, 0, 0, IPPROTO_UDP), //pass
+            insn(BPF_LDX | BPF_MEM | BPF_H, BPF_REG_5, BPF_REG_2, ETH_HEADER + IP_HEADER + 2, 0),
+            insn(BPF_JMP32 | BPF_JNE | BPF_K, BPF_REG_5, 0, 0, htons(port)), //pass
+        };
+        if(addr != INADDR_ANY) {
+            program.push_back(insn(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_5, BPF_REG_2, ETH_HEADER + 16, 0));
+            program.push_back(insn(BPF_JMP32 | BPF_JNE | BPF_K, BPF_REG_5, 0, 0, static_cast<int32_t>(addr))); //pass
+        }
+        auto redirect = program.size();
+        program.push_back(insn(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_2, BPF_REG_6, offsetof(xdp_md, rx_queue_index), 0));
+        program.push_back(insn(BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1, BPF_PSEUDO_MAP_FD, 0, _map_fd));
+        program.push_back(insn(0, 0, 0, 0, 0));
+        program.push_back(insn(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_3, 0, 0, XDP_PASS)); //what redirect_map returns for other queues
+        program.push_back(insn(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map));
+        program.push_back(insn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0));
+        auto pass = program.size();
+        program.push_back(insn(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_0, 0, 0, XDP_PASS));
+        program.push_back(insn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0));
+        for(size_t i = 0; i < redirect; ++i) {
+            if(BPF_CLASS(program[i].code) == BPF_JMP || BPF_CLASS(program[i].code) == BPF_JMP32) {
+                program[i].off = static_cast<int16_t>(pass - i - 1);
+            }
+        }
+        static const char license[] = "Dual MIT/GPL";
+        attr = bpf_attr{};
+        attr.prog_type = BPF_PROG_TYPE_XDP;
+        attr.insns = reinterpret_cast<unsigned long long>(program.data());
+        attr.insn_cnt = static_cast<unsigned int>(program.size());
+        attr.license = reinterpret_cast<unsigned long long>(license);
+        _prog_fd = bpf(BPF_PROG_LOAD, attr);
+        if(_prog_fd < 0) {
+            throw std::runtime_error(base_socket::last_error());
+        }
+        attr = bpf_attr{};
+        attr.link_create.prog_fd = static_cast<unsigned int>(_prog_fd);
+        attr.link_create.target_ifindex = ifindex;
+        attr.link_create.attach_type = BPF_XDP;
+        attr.link_create.flags = _options.mode == xdp_mode_t::SKB ? XDP_FLAGS_SKB_MODE : XDP_FLAGS_DRV_MODE;
+        _link_fd = bpf(BPF_LINK_CREATE, attr);
+        if(_link_fd < 0) {
+            throw std::runtime_error(base_socket::last_error());
+        }
+    }
+
+    std::string xdp_udp_server_socket::read_from(const int flags) {
+        std::string message;
+        do {
+            if(!_wait_rx(flags)) {
+                errno = EAGAIN;
+                throw std::runtime_error(base_socket::last_error());
+            }
+            message.clear();
+        } while(!_receive(message, _options.frame_size));
+        return message;
+    }
+
+    size_t xdp_udp_server_socket::read_batch(std::vector<std::string>& messages, const size_t max_messages, const size_t max_size, const int flags) {
+        auto count = std::min(max_messages, MAX_BATCH);
+        messages.resize(count);
+        size_t n = 0;
+        while(n < count && _wait_rx(n == 0 ? flags : flags | MSG_DONTWAIT)) {
+            messages[n].clear();
+            if(_receive(messages[n], max_size)) {
+                ++n;
+            }
+        }
+        messages.resize(n);
+        return n;
+    }
+
+    long xdp_udp_server_socket::write_back(const std::string& buffer, const int flags) {
+        if(buffer.size() > _options.frame_size - ETH_HEADER - IP_HEADER - UDP_HEADER) {
+            throw std::runtime_error(EMSG_XDP_FRAME);
+        }
+        _reclaim();
+        while(_tx_frames.empty()) { //every transmit frame is on the tx ring, in copy mode the kick sends and completes them
+            _kick();
+            _reclaim();
+            if(_tx_frames.empty()) {
+                if(flags & MSG_DONTWAIT) {
+                    return -1;
+                }
+                pollfd p{_fd, POLLOUT, 0};
+                poll(&p, 1, 1);
+            }
+        }
+        auto frame = _tx_frames.back();
+        _tx_frames.pop_back();
+        auto p = _umem + frame;
+        auto udp_length = static_cast<unsigned short>(UDP_HEADER + buffer.size());
+        auto ip_length = static_cast<unsigned short>(IP_HEADER + udp_length);
+        //Ethernet - back the way the datagram came
+        memcpy(p, _peer.remote_mac.data(), 6);
+        memcpy(p + 6, _peer.local_mac.data(), 6);
+        put16(p + 12, ETHERTYPE_IPV4);
+        //IPv4
+        auto ip = p + ETH_HEADER;
+        ip[0] = 0x45;
+        ip[1] = 0;
+        put16(ip + 2, ip_length);
+        put16(ip + 4, _ip_id++);
+        put16(ip + 6, 0x4000); //don't fragment
+        ip[8] = TTL;
+        ip[9] = IPPROTO_UDP;
+        put16(ip + 10, 0);
+        memcpy(ip + 12, &_peer.local_ip, 4);
+        memcpy(ip + 16, &_peer.remote_ip, 4);
+        put16(ip + 10, checksum(sum16(ip, IP_HEADER)));
+        //UDP, checksummed over the pseudo header
+        auto udp = ip + IP_HEADER;
+        memcpy(udp, &_peer.local_port, 2);
+        memcpy(udp + 2, &_peer.remote_port, 2);
+        put16(udp + 4, udp_length);
+        put16(udp + 6, 0);
+        memcpy(udp + UDP_HEADER, buffer.data(), buffer.size());
+        auto sum = sum16(ip + 12, 8, IPPROTO_UDP + udp_length);
+        auto udp_checksum = checksum(sum16(udp, udp_length, sum));
+        put16(udp + 6, udp_checksum ? udp_checksum : 0xffff); //0 means no checksum
+        //the tx ring never overflows, it has a slot for every transmit frame
+        auto producer = *_tx.producer;
+        auto& desc = static_cast<xdp_desc*>(_tx.descriptors)[producer & _tx.mask];
+        desc.addr = frame;
+        desc.len = static_cast<unsigned int>(ETH_HEADER + ip_length);
+        desc.options = 0;
+        __atomic_store_n(_tx.producer, producer + 1, __ATOMIC_RELEASE);
+        _kick();
+        return static_cast<long>(buffer.size());
+    }
+
+    unsigned int xdp_udp_server_socket::sockfd() const {
+        return static_cast<unsigned int>(_fd);
+    }
+
+    bool xdp_udp_server_socket::_wait_rx(const int flags) {
+        for(;;) {
+            if(__atomic_load_n(_rx.producer, __ATOMIC_ACQUIRE) != *_rx.consumer) {
+                return true;
+            }
+            if(flags & MSG_DONTWAIT) {
+                return false;
+            }
+            pollfd p{_fd, POLLIN, 0};
+            if(poll(&p, 1, -1) < 0 && errno != EINTR) {
+                throw std::runtime_error(base_socket::last_error());
+            }
+        }
+    }
+
+    bool xdp_udp_server_socket::_receive(std::string& message, const size_t max_size) {
+        auto consumer = *_rx.consumer;
+        auto desc = static_cast<xdp_desc*>(_rx.descriptors)[consumer & _rx.mask];
+        __atomic_store_n(_rx.consumer, consumer + 1, __ATOMIC_RELEASE);
+        auto p = _umem + desc.addr;
+        auto ours = false;
+        if(desc.len >= ETH_HEADER + IP_HEADER + UDP_HEADER) {
+            auto ip = p + ETH_HEADER;
+            auto ip_header = static_cast<size_t>(ip[0] & 0x0f) * 4;
+            auto udp = ip + ip_header;
+            auto udp_length = static_cast<size_t>(udp[4] << 8 | udp[5]);
+            if(ETH_HEADER + ip_header + std::max(udp_length, UDP_HEADER) <= desc.len && udp_length >= UDP_HEADER) {
+                memcpy(_peer.local_mac.data(), p, 6);
+                memcpy(_peer.remote_mac.data(), p + 6, 6);
+                memcpy(&_peer.remote_ip, ip + 12, 4);
+                memcpy(&_peer.local_ip, ip + 16, 4);
+                memcpy(&_peer.remote_port, udp, 2);
+                memcpy(&_peer.local_port, udp + 2, 2);
+                message.append(reinterpret_cast<char*>(udp + UDP_HEADER), std::min(udp_length - UDP_HEADER, max_size));
+                ours = true;
+            }
+        }
+        //hand the frame straight back for receiving, the fill ring has a slot for every receive frame
+        auto producer = *_fill.producer;
+        static_cast<unsigned long long*>(_fill.descriptors)[producer & _fill.mask] = desc.addr - desc.addr % _options.frame_size;
+        __atomic_store_n(_fill.producer, producer + 1, __ATOMIC_RELEASE);
+        if(__atomic_load_n(_fill.flags, __ATOMIC_RELAXED) & XDP_RING_NEED_WAKEUP) {
+            recvfrom(_fd, nullptr, 0, MSG_DONTWAIT, nullptr, nullptr);
+        }
+        return ours;
+    }
+
+    void xdp_udp_server_socket::_kick() {
+        if(__atomic_load_n(_tx.flags, __ATOMIC_RELAXED) & XDP_RING_NEED_WAKEUP) {
+            sendto(_fd, nullptr, 0, MSG_DONTWAIT, nullptr, 0);
+        }
+    }
+
+    void xdp_udp_server_socket::_reclaim() {
+        auto producer = __atomic_load_n(_completion.producer, __ATOMIC_ACQUIRE);
+        auto consumer = *_completion.consumer;
+        for(; consumer != producer; ++consumer) {
+            _tx_frames.push_back(static_cast<unsigned long long*>(_completion.descriptors)[consumer & _completion.mask]);
+        }
+        __atomic_store_n(_completion.consumer, consumer, __ATOMIC_RELEASE);
+    }
+
+    void xdp_udp_server_socket::_close() {
+        for(auto fd: {_link_fd, _prog_fd, _map_fd}) { //closing the link detaches the program
+            if(fd >= 0) {
+                close(fd);
+            }
+        }
+        _link_fd = _prog_fd = _map_fd = -1;
+        for(auto ring: {&_fill, &_completion, &_rx, &_tx}) {
+            if(ring->mapped) {
+                munmap(ring->mapped, ring->mapped_size);
+                ring->mapped = nullptr;
+            }
+        }
+        if(_fd >= 0) {
+            close(_fd);
+            _fd = -1;
+        }
+        if(_umem) {
+            munmap(_umem, _umem_size);
+            _umem = nullptr;
+        }
+    }
+
+    xdp_udp_server_socket::~xdp_udp_server_socket() {
+        _close();
+    }
+
+}
+
+#endif // __linux__
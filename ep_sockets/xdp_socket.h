@@ -0,0 +1,150 @@
+#ifndef XDP_SOCKET_H
+#define XDP_SOCKET_H
+
+#ifdef __linux__
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "linux/if_xdp.h"
+
+#include "socket_constants.h"
+#include "socket_errors.h"
+
+namespace net {
+
+    /**
+     * @brief xdp_mode_t - where the XDP program runs: SKB (generic, any interface including lo and veth), DRIVER (native, copying
+     * into the UMEM) or ZERO_COPY (native, the NIC receives straight into the UMEM) - the last two need driver support
+     */
+    enum class xdp_mode_t {SKB, DRIVER, ZERO_COPY};
+
+    /**
+     * @brief xdp_options_t - queue, UMEM and ring sizes of an xdp_udp_server_socket
+     */
+    struct xdp_options_t {
+        unsigned int queue = 0; //the interface receive queue bound, steer the flow to it (e.g. ethtool -N) on multi queue NICs
+        xdp_mode_t mode = xdp_mode_t::SKB;
+        unsigned int frames = 4096; //UMEM frames, power of two - half are kept on the fill ring for receive, half for transmit
+        unsigned int frame_size = 2048; //bytes per frame, power of two and at least 2048 - datagrams must fit one frame
+    };
+
+    /**
+     * @brief The xdp_udp_server_socket class is an AF_XDP receive and transmit path with the read_from/write_back API of
+     * udp_server_socket: a small XDP program hands the UDP/IPv4 datagrams for addr:port (unfragmented, without IP options)
+     * to this socket's rings and passes every other frame to the kernel stack as usual, so the interface stays usable.
+     * @version 0.5
+     * Frames live in a UMEM area shared with the kernel, read_from parses the Ethernet, IPv4 and UDP headers in user space and
+     * write_back builds them, answering the sender of the last datagram read from the addresses it came from. There are no
+     * system calls on the receive path while the rx ring has frames, transmit needs one (sendto) to kick the tx ring.
+     * The XDP program is attached with a BPF link (Linux 5.9) and detached when the socket is destroyed, it fails if another
+     * XDP program is attached to the interface. Needs CAP_NET_ADMIN and CAP_BPF (or root).
+     * @note the kernel's own UDP socket, if any, no longer sees the datagrams for addr:port on the bound queue. On lo frames are
+     * received but those transmitted are dropped by the stack (a 127/8 source with no route attached), test on a veth pair.
+     */
+    class xdp_udp_server_socket {
+
+        struct xdp_ring_t {
+            unsigned int* producer = nullptr;
+            unsigned int* consumer = nullptr;
+            unsigned int* flags = nullptr;
+            void* descriptors = nullptr;
+            unsigned int mask = 0;
+            void* mapped = nullptr;
+            size_t mapped_size = 0;
+        };
+
+    public:
+
+        /**
+         * @brief xdp_udp_server_socket
+         * @param interface_name - e.g. "eth0", "veth1" or "lo"
+         * @param addr - local IPv4 address to receive for, ANY_ADDR for all
+         * @param port - local UDP port
+         */
+        xdp_udp_server_socket(const std::string interface_name, const std::string addr, const unsigned short port,
+                              const xdp_options_t& options = xdp_options_t{});
+
+        xdp_udp_server_socket(const xdp_udp_server_socket&) = delete;
+
+        xdp_udp_server_socket& operator= (const xdp_udp_server_socket&) = delete;
+
+        /**
+         * @brief read_from - the next datagram's payload, remembering its sender for write_back
+         * @param flags - MSG_DONTWAIT throws EAGAIN rather than waiting when the rx ring is empty
+         */
+        std::string read_from(const int flags = 0);
+
+        /**
+         * @brief write_back - send a datagram to the sender of the last one read, from the address and port it was sent to
+         * @param flags - MSG_DONTWAIT returns -1 rather than waiting when every transmit frame is in flight
+         * @return long - the number of payload bytes sent, else -1
+         */
+        long write_back(const std::string& buffer, const int flags = 0);
+
+        /**
+         * @brief read_batch - the payloads of every datagram already on the rx ring, up to max_messages, waiting for the first
+         * unless MSG_DONTWAIT. write_back then answers the last of them.
+         * @return size_t - the number of datagrams read
+         */
+        size_t read_batch(std::vector<std::string>& messages, const size_t max_messages, const size_t max_size = DEFAULT_BUFFER_SIZE, const int flags = 0);
+
+        /**
+         * @brief sockfd - the AF_XDP socket, readable (POLLIN) when the rx ring has frames
+         * @note ownership is retained by this socket, do not close it.
+         */
+        unsigned int sockfd() const;
+
+        ~xdp_udp_server_socket();
+
+    private:
+
+        //the sender of the last datagram read, in network byte order as it was on the wire
+        struct peer_t {
+            std::array<unsigned char, 6> local_mac;
+            std::array<unsigned char, 6> remote_mac;
+            unsigned int local_ip;
+            unsigned int remote_ip;
+            unsigned short local_port;
+            unsigned short remote_port;
+        };
+
+        void _close();
+
+        void _map_ring(xdp_ring_t& ring, const size_t entries, const size_t descriptor_size, const xdp_ring_offset& offsets, const off_t page_offset);
+
+        void _attach_program(const unsigned int addr, const unsigned short port, const unsigned int ifindex);
+
+        //wait until the rx ring has a frame, false when non blocking and it has not
+        bool _wait_rx(const int flags);
+
+        //take one frame off the rx ring, its payload appended to message (up to max_size), false if it was not ours
+        bool _receive(std::string& message, const size_t max_size);
+
+        void _kick();
+
+        void _reclaim();
+
+        int _fd = -1;
+        int _map_fd = -1;
+        int _prog_fd = -1;
+        int _link_fd = -1;
+        xdp_options_t _options;
+        unsigned char* _umem = nullptr;
+        size_t _umem_size = 0;
+        xdp_ring_t _fill;
+        xdp_ring_t _completion;
+        xdp_ring_t _rx;
+        xdp_ring_t _tx;
+        std::vector<unsigned long long> _tx_frames; //free transmit frames
+        peer_t _peer{};
+        unsigned short _ip_id = 0;
+
+    };
+
+}
+
+#endif // __linux__
+
+#endif // XDP_SOCKET_H